@@ -41,4 +41,3 @@
 
 
 #define LONG_DIG_VALUE "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-extern int Long_neg;
@@ -178,12 +178,24 @@ union attr_val {	      /* the attribute value	*/
 struct attribute {
 	unsigned int at_flags:ATRVFLAG;	/* attribute flags	*/
 	unsigned int at_type:ATRVTYPE;	/* type of attribute    */
-	svrattrl    *at_user_encoded;	/* encoded svrattrl form for users*/
-	svrattrl    *at_priv_encoded;	/* encoded svrattrl form for mgr/op*/
+	struct attr_ext *at_ext;	/* rarely used extras, or NULL	*/
 	union  attr_val at_val;		/* the attribute value	*/
 };
 typedef struct attribute attribute;
 
+/*
+ * Extras which only a few attributes ever carry: the svrattrl encodings
+ * cached by status requests and the resource lookup index kept for long
+ * ATR_TYPE_RESC lists.  Allocated by get_attr_ext() on first use and
+ * released by put_attr_ext() once every member is NULL again, so that an
+ * attribute which never needs them costs a single pointer.
+ */
+struct attr_ext {
+	svrattrl	  *ae_user_encoded;	/* encoded svrattrl form for users*/
+	svrattrl	  *ae_priv_encoded;	/* encoded svrattrl form for mgr/op*/
+	struct resc_index *ae_rindex;		/* lookup by resource_def, or NULL */
+};
+
 /*
  * The following structure is used to define an attribute for any parent
  * object.  The structure declares the attribute's name, value type, and
@@ -457,7 +469,7 @@ extern void free_resc(attribute *attr);
 extern void free_depend(attribute *attr);
 extern void free_unkn(attribute *attr);
 extern int   parse_equal_string(char  *start, char **name, char **value);
-extern char *parse_comma_string(char *start);
+extern char *parse_comma_string(char *start, char **saveptr);
 extern char *return_external_value(char *name, char *val);
 extern char *return_internal_value(char *name, char *val);
 
@@ -599,6 +611,9 @@ extern int encode_single_attr_db(struct attribute_def *padef, struct attribute *
 extern int encode_attr_db(struct attribute_def *padef, struct attribute *pattr, int numattr,  pbs_db_attr_list_t *db_attr_list, int all);
 extern int decode_attr_db(void *parent, pbs_db_attr_list_t *db_attr_list,
 	void *padef_idx, struct attribute_def *padef, struct attribute *pattr, int limit, int unknown);
+extern int decode_attr_db_noact(void *parent, pbs_db_attr_list_t *db_attr_list,
+	void *padef_idx, struct attribute_def *padef, struct attribute *pattr, int limit, int unknown);
+extern int recov_attr_db_actions(void *parent, struct attribute_def *padef, struct attribute *pattr, int limit);
 
 extern int is_attr(int, char *, int);
 
@@ -616,12 +631,18 @@ void set_attr_c(attribute *pattr, char value, enum batch_op op);
 void set_attr_b(attribute *pattr, long val, enum batch_op op);
 void mark_attr_not_set(attribute *attr);
 void mark_attr_set(attribute *attr);
+int set_attr_usr_encoded(attribute *pattr, svrattrl *encoded);
+int set_attr_priv_encoded(attribute *pattr, svrattrl *encoded);
+struct attr_ext *get_attr_ext(attribute *pattr);
+void put_attr_ext(attribute *pattr);
 
 /* Attr getters */
 char get_attr_c(const attribute *pattr);
 long get_attr_l(const attribute *pattr);
 char *get_attr_str(const attribute *pattr);
 int is_attr_set(const attribute *pattr);
+svrattrl *get_attr_usr_encoded(const attribute *pattr);
+svrattrl *get_attr_priv_encoded(const attribute *pattr);
 
 /* "type" to pass to acl_check() */
 #define ACL_Host  1
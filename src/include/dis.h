@@ -208,6 +208,15 @@ extern void DIS_tcp_funcs();
 #define DIS_WRITE_BUF 0
 #define DIS_READ_BUF 1
 
+/*
+ * A client asks for the binary encoding by sending PBS_DIS_BINARY_EXTEND
+ * as the extension of its Connect request; a server which can speak it
+ * answers with PBS_DIS_BINARY as the auxcode of the reply, after which
+ * both ends switch the connection over with dis_set_binary().
+ */
+#define PBS_DIS_BINARY_EXTEND "dis_binary"
+#define PBS_DIS_BINARY 1
+
 typedef struct pbs_dis_buf {
 	size_t tdis_bufsize;
 	size_t tdis_len;
@@ -225,6 +234,7 @@ typedef struct pbs_tcp_chan {
 	pbs_dis_buf_t readbuf;
 	pbs_dis_buf_t writebuf;
 	int is_old_client; /* This is just for backward compatibility */
+	int is_binary; /* numbers are sent as binary, see dis_putvarint() */
 	pbs_tcp_auth_data_t auths[2];
 } pbs_tcp_chan_t;
 
@@ -234,6 +244,10 @@ int disr_skip(int, size_t);
 int dis_getc(int);
 int dis_gets(int, char *, size_t);
 int dis_puts(int, const char *, size_t);
+int dis_is_binary(int);
+void dis_set_binary(int, int);
+size_t dis_write_len(int);
+char *dis_write_data(int, size_t);
 int dis_flush(int);
 void dis_setup_chan(int, pbs_tcp_chan_t * (*)(int));
 void dis_destroy_chan(int);
@@ -244,6 +258,7 @@ void transport_chan_set_authctx(int, void *, int);
 void * transport_chan_get_authctx(int, int);
 void transport_chan_set_authdef(int, auth_def_t *, int);
 auth_def_t * transport_chan_get_authdef(int, int);
+int transport_chan_is_encrypted(int);
 int transport_send_pkt(int, int, void *, size_t);
 int transport_recv_pkt(int, int *, void **, size_t *);
 
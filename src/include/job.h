@@ -44,6 +44,7 @@ extern "C" {
 #endif
 
 #include "list_link.h"
+#include "pbs_heap.h"
 #include "attribute.h"
 #include "range.h"
 /*
@@ -82,7 +83,11 @@ struct var_table {
  * dependency.  It also heads the list of depend_job related via this type.
  * For a type of "sycnto", the number of jobs expected, registered and
  * ready are also recorded.
+ *
+ * Once the list of depend_job grows past DEPEND_IDX_MIN entries, it is
+ * also indexed by child job id, see find_dependjob().
  */
+#define DEPEND_IDX_MIN 16
 
 struct depend {
 	pbs_list_link dp_link;	/* link to next dependency, if any       */
@@ -92,6 +97,7 @@ struct depend {
 	short	  dp_released;	/* This job released to run (syncwith)   */
 	short	  dp_numrun;    /* num jobs supposed to run		 */
 	pbs_list_head dp_jobs;	/* list of related jobs  (all)           */
+	void	 *dp_idx;	/* index of dp_jobs by dc_child, if long */
 };
 
 /*
@@ -428,11 +434,17 @@ struct job {
 	pbs_list_link ji_alljobs;	     /* links to all jobs in server */
 	pbs_list_link ji_jobque;	     /* SVR: links to jobs in same queue, MOM: links to polled jobs */
 	pbs_list_link ji_unlicjobs;	     /* links to unlicensed jobs */
+	pbs_list_link ji_statejobs;	     /* SVR: links to jobs in same state */
+	pbs_list_link ji_ownerjobs;	     /* SVR: links to jobs of same owner */
+	pbs_list_link ji_dirtyjobs;	     /* SVR: links to jobs not yet saved */
+	pbs_heap_entry ji_histheap;	     /* SVR: entry in history expiry heap */
 	int ji_momhandle;		     /* open connection handle to MOM */
 	int ji_mom_prot;		     /* PROT_TCP or PROT_TPP */
 	struct batch_request *ji_rerun_preq; /* outstanding rerun request */
 #ifdef PBS_MOM
 	void *ji_pending_ruu;			    /* pending last update */
+	pbs_list_head ji_ruu_sent;		    /* resources_used values last sent to server */
+	int ji_ruu_gen;				    /* server connection generation of ji_ruu_sent */
 	struct batch_request *ji_preq;		    /* outstanding request */
 	struct grpcache *ji_grpcache;		    /* cache of user's groups */
 	enum PBS_Chkpt_By ji_chkpttype;		    /* checkpoint type  */
@@ -528,6 +540,9 @@ struct job {
 	struct preempt_ordering *preempt_order;
 	int preempt_order_index;
 	struct work_task *ji_prov_startjob_task;
+	struct status_cache *ji_stcache[PBS_STCACHE_VIEWS]; /* encoded status per view and encoding */
+	struct frozen_job *ji_frozen;	    /* status of a history job, see job_freeze() */
+	struct exec_vnode_cache *ji_execvn; /* parsed exec_vnode, see job_exec_vnode() */
 
 #endif /* END SERVER ONLY */
 
@@ -604,15 +619,48 @@ struct job {
 	/*
 	 * The following array holds the decode	 format of the attributes.
 	 * Its presence is for rapid acces to the attributes.
+	 * The Server allocates it apart, so that a frozen history job can
+	 * release it, see job_freeze().
 	 */
 
+#ifdef PBS_MOM
 	attribute ji_wattr[JOB_ATR_LAST]; /* decoded attributes  */
+#else
+	attribute *ji_wattr;		  /* decoded attributes  */
+#endif
 
 	short newobj; /* newly created job? */
 };
 
 typedef struct job job;
 
+#ifndef PBS_MOM
+/*
+ * A frozen history job, see job_freeze().  It keeps decoded only the few
+ * attributes it is listed, selected and ordered by (frozen_kept_attrs[]),
+ * and what a status reply shows of the others as their client encoding,
+ * one value after the other in attribute index order:
+ *
+ *	struct frozen_value, name\0, resource\0, value\0
+ *
+ * Anything else needs the attributes decoded again, see job_thaw().
+ */
+struct frozen_value {
+	int fv_index;  /* job attribute index */
+	int fv_rflags; /* flags of the resource definition, 0 if none */
+	int fv_flags;  /* al_flags of the encoded value */
+	int fv_op;     /* al_op of the encoded value */
+};
+
+#define FROZEN_KEPT_ATTRS 11 /* entries in frozen_kept_attrs[] */
+
+struct frozen_job {
+	attribute fz_kept[FROZEN_KEPT_ATTRS]; /* decoded, see frozen_kept_attrs[] */
+	size_t fz_statuslen;		      /* length of fz_status */
+	char fz_status[1];		      /* encoded values, see above */
+};
+#endif /* PBS_MOM */
+
 
 #ifdef	PBS_MOM
 /*
@@ -993,6 +1041,7 @@ extern struct depend_job *find_dependjob(struct depend *pdep, char *name);
 extern int send_depend_req(job *pjob, struct depend_job *pparent, int type, int op, int schedhint, void (*postfunc)(struct work_task *));
 extern void post_runone(struct work_task *pwt);
 extern job  *find_job(char *);
+extern job  *find_job_nothaw(char *);
 extern char *get_variable(job *, char *);
 extern void  check_block(job *, char *);
 extern char *lookup_variable(void *, int, char *);
@@ -1014,6 +1063,19 @@ extern void  svr_dequejob(job *);
 extern int   svr_enquejob(job *, char *);
 extern void  svr_evaljobstate(job *, char *, int *, int);
 extern int   svr_setjobstate(job *, char, int);
+extern int   init_job_indexes(void);
+extern void  update_job_state_index(job *, char);
+extern int   is_history_state(char);
+#ifndef PBS_MOM
+extern int   job_freeze(job *);
+extern int   job_thaw(job *);
+extern void  discard_frozen_job(job *);
+extern attribute *get_frozen_jattr(struct frozen_job *, int);
+extern char *get_frozen_jattr_value(struct frozen_job *, int, char *);
+extern int   is_frozen_kept_jattr(int);
+extern void  set_histjob_freeze_task(job *);
+#endif
+extern int   count_jobs_by_owner(struct array_strings *);
 extern int   state_char2int(char);
 extern char	 state_int2char(int);
 extern int   uniq_nameANDfile(char*, char*, char*);
@@ -1029,6 +1091,7 @@ int check_job_substate(const job *pjob, int substate);
 char get_job_state(const job *pjob);
 int get_job_state_num(const job *pjob);
 long get_job_substate(const job *pjob);
+attribute *get_jattr(const job *pjob, int attr_idx);
 char *get_jattr_str(const job *pjob, int attr_idx);
 long get_jattr_long(const job *pjob, int attr_idx);
 svrattrl *get_jattr_usr_encoded(const job *pjob, int attr_idx);
@@ -1067,7 +1130,10 @@ extern int job_save_fs(job *);
 #else
 
 extern job *job_recov_db(char *, job *pjob);
+extern int job_recov_attrs_db(job *);
 extern int job_save_db(job *);
+extern int job_save_db_now(job *);
+extern int recov_jobs_db(void);
 
 #define job_save  job_save_db
 #define job_recov job_recov_db
@@ -1089,6 +1155,9 @@ extern int   svr_chk_ownerResv(struct batch_request *, resc_resv *);
 
 #ifdef	_QUEUE_H
 extern int   svr_chkque(job *, pbs_queue *, char *, int mtype);
+extern int   count_jobs_by_state(char *, pbs_queue *);
+extern int   find_jobs_by_state(char *, pbs_queue *, job ***);
+extern int   find_jobs_by_owner(struct array_strings *, pbs_queue *, job ***);
 extern int   default_router(job *, pbs_queue *, long);
 extern int   site_alt_router(job *, pbs_queue *, long);
 extern int   site_acl_check(job *, pbs_queue *);
@@ -168,11 +168,23 @@ struct brp_select {
 };
 
 /* reply to Status Job/Queue/Server Request */
+/*
+ * DIS encoding of the attribute list of a status entry, kept by the server
+ * per object and spliced into replies by encode_DIS_reply()
+ */
+struct status_blob {
+	int sb_refct;  /* references from the object and from replies */
+	size_t sb_len; /* length of sb_data */
+	int sb_binary; /* sb_data is in the binary encoding of DIS */
+	char *sb_data; /* encoded attribute list, NULL until first encoded */
+};
+
 struct brp_status {
 	pbs_list_link brp_stlink;
 	int brp_objtype;
 	char brp_objname[(PBS_MAXSVRJOBID > PBS_MAXDEST ? PBS_MAXSVRJOBID : PBS_MAXDEST) + 1];
-	pbs_list_head brp_attr; /* head of svrattrlist */
+	pbs_list_head brp_attr;	     /* head of svrattrlist */
+	struct status_blob *brp_blob; /* encoding of the attributes or NULL */
 };
 
 /* reply to Resource Query Request */
@@ -62,6 +62,11 @@ typedef unsigned long pbs_net_t;        /* for holding host addresses */
 
 #define PBS_NET_MAXCONNECTIDLE  900
 
+/* once this much output is queued for a connection, no more requests are
+ * read from it until the client catches up (see conn_update_poll_events())
+ */
+#define PBS_NET_OUTQ_HIWATER	(32 * 1024 * 1024)
+
 /* flag bits for cn_authen field */
 #define PBS_NET_CONN_AUTHENTICATED 0x01
 #define PBS_NET_CONN_FROM_PRIVIL   0x02
@@ -203,6 +208,9 @@ extern  pbs_net_t  get_addr_of_nodebyname(char *name, unsigned int *port);
 extern int make_host_addresses_list(char *phost, u_long **pul);
 
 conn_t *get_conn(int sock); /* gets the connection, for a given socket id */
+int conn_send_queued(int sock, void *data, int len);
+int conn_flush_queued(int sock, int timeout);
+size_t conn_queued_len(int sock);
 void connection_idlecheck(void);
 void connection_init(void);
 char *build_addr_string(pbs_net_t);
@@ -232,5 +240,12 @@ struct connection {
 	char            cn_physhost[PBS_MAXHOSTNAME + 1];
 	pbs_auth_config_t   *cn_auth_config;
 	conn_origin_t	cn_origin; /* used to know the origin of the connection i.e. Scheduler, MOM etc. */
+	/* output waiting for the socket to become writable */
+	char		*cn_outq;	/* queued output */
+	size_t		cn_outq_size;	/* allocated size of cn_outq */
+	size_t		cn_outq_len;	/* end of queued output in cn_outq */
+	size_t		cn_outq_off;	/* start of queued output in cn_outq */
+	int		cn_closing;	/* closed, kept open until cn_outq is written */
+	int		cn_poll_events;	/* events polled for on cn_sock */
 };
 #endif	/* _NET_CONNECT_H */
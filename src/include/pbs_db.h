@@ -190,8 +190,17 @@ typedef struct pbs_db_job_info pbs_db_job_info_t;
  *  Structure used to map database job script to C
  *
  */
+/*
+ * A job script is stored once per distinct content, under sc_hash: the
+ * SHA-256 of the script in hex, or "job:<jobid>" for scripts stored
+ * before scripts were shared between jobs.
+ */
+#define PBS_DB_SCRHASH_LEN	(PBS_MAXSVRJOBID + 4)
+
 struct pbs_db_jobscr_info {
 	char     ji_jobid[PBS_MAXSVRJOBID + 1]; /* job identifier */
+	char     sc_hash[PBS_DB_SCRHASH_LEN + 1]; /* key of the script content */
+	int      sc_hashonly;		/* load: only look up sc_hash */
 	TEXT     script;			/* job script */
 };
 typedef struct pbs_db_jobscr_info pbs_db_jobscr_info_t;
@@ -292,6 +301,10 @@ typedef void (*query_cb_t)(pbs_db_obj_info_t *, int *);
 #define PBS_DB_CNT_TIMEOUT_NORMAL	30
 #define PBS_DB_CNT_TIMEOUT_INFINITE	0
 
+/* how pbs_db_end_trx() ends a transaction */
+#define PBS_DB_COMMIT	0
+#define PBS_DB_ROLLBACK	1
+
 
 /* Database start stop control commands */
 #define PBS_DB_CONTROL_STATUS	"status"
@@ -347,6 +360,34 @@ int pbs_db_disconnect(void *conn);
  */
 int pbs_db_save_obj(void *conn, pbs_db_obj_info_t *obj, int savetype);
 
+/**
+ * @brief
+ *	Start a transaction, the following saves and deletes are
+ *	committed together by pbs_db_end_trx()
+ *
+ * @param[in]	conn - Connected database handle
+ *
+ * @return      int
+ * @retval      -1  - Failure
+ * @retval       0  - success
+ *
+ */
+int pbs_db_begin_trx(void *conn);
+
+/**
+ * @brief
+ *	End the transaction started by pbs_db_begin_trx()
+ *
+ * @param[in]	conn - Connected database handle
+ * @param[in]	how - PBS_DB_COMMIT or PBS_DB_ROLLBACK
+ *
+ * @return      int
+ * @retval      -1  - Failure
+ * @retval       0  - success
+ *
+ */
+int pbs_db_end_trx(void *conn, int how);
+
 /**
  * @brief
  *	Delete an existing object from the database
@@ -420,6 +461,45 @@ int pbs_db_search(void *conn, pbs_db_obj_info_t *obj, pbs_db_query_options_t *op
  */
 int pbs_db_load_obj(void *conn, pbs_db_obj_info_t *obj);
 
+/**
+ * @brief
+ *	Find all jobs, ordered by queue rank, keeping the resultset so that its
+ *	rows can be loaded by several threads with pbs_db_load_job_row()
+ *
+ * @param[in]	conn  - Connected database handle
+ * @param[out]	count - Number of jobs found, -1 on failure
+ *
+ * @return      Resultset handle, release with pbs_db_free_jobs()
+ * @retval      NULL - Failure (*count is -1) or no jobs (*count is 0)
+ *
+ */
+void *pbs_db_find_jobs(void *conn, int *count);
+
+/**
+ * @brief
+ *	Load one row of the resultset of pbs_db_find_jobs() into dbjob.
+ *	Threads may load distinct rows at the same time.
+ *
+ * @param[in]	res   - Resultset handle
+ * @param[in]	row   - Row to load
+ * @param[out]	dbjob - The job data is loaded into this object
+ *
+ * @return      int
+ * @retval      -1  - Failure
+ * @retval       0  - success
+ *
+ */
+int pbs_db_load_job_row(void *res, int row, pbs_db_job_info_t *dbjob);
+
+/**
+ * @brief
+ *	Release the resultset of pbs_db_find_jobs()
+ *
+ * @param[in]	res   - Resultset handle
+ *
+ */
+void pbs_db_free_jobs(void *res);
+
 /**
  * @brief
  *	Function to check whether data-service is running
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+#ifndef _PBS_HEAP_H
+#define _PBS_HEAP_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A binary min-heap of objects ordered by a long key, typically a time.
+ * Like pbs_list_link, the entry is embedded in the object it orders, which
+ * lets an object be removed or re-keyed without searching for it.
+ * Entries with the same key come out in the order they were inserted.
+ */
+typedef struct pbs_heap_entry {
+	long he_key;		/* ordering key, smallest first */
+	unsigned long he_seq;	/* insertion order, breaks ties on he_key */
+	int he_pos;		/* position in the heap, -1 if not in one */
+	void *he_data;		/* object the entry is embedded in */
+} pbs_heap_entry;
+
+#define CLEAR_HEAP_ENTRY(e) ((e).he_pos = -1, (e).he_data = NULL)
+#define IN_HEAP(e) ((e).he_pos >= 0)
+
+/**
+ * @brief
+ *	Create an empty heap
+ *
+ * @return void *
+ * @retval !NULL - success
+ * @retval NULL  - failure
+ *
+ */
+extern void *pbs_heap_create(void);
+
+/**
+ * @brief
+ *	destroy heap, the objects in it are not touched
+ *
+ * @param[in] - heap - pointer to heap
+ *
+ * @return void
+ *
+ */
+extern void pbs_heap_destroy(void *heap);
+
+/**
+ * @brief
+ *	add an object to the heap, or re-key it if it is already there
+ *
+ * @param[in] - heap  - pointer to heap
+ * @param[in] - entry - heap entry embedded in the object
+ * @param[in] - key   - ordering key of the object
+ * @param[in] - data  - the object
+ *
+ * @return int
+ * @retval 0  - success
+ * @retval -1 - failure (no memory)
+ *
+ */
+extern int pbs_heap_insert(void *heap, pbs_heap_entry *entry, long key, void *data);
+
+/**
+ * @brief
+ *	remove an object from the heap, no-op if it is not in it
+ *
+ * @param[in] - heap  - pointer to heap
+ * @param[in] - entry - heap entry embedded in the object
+ *
+ * @return void
+ *
+ */
+extern void pbs_heap_delete(void *heap, pbs_heap_entry *entry);
+
+/**
+ * @brief
+ *	get the object with the smallest key, without removing it
+ *
+ * @param[in]  - heap - pointer to heap
+ * @param[out] - key  - if not NULL, set to the key of the object
+ *
+ * @return void *
+ * @retval !NULL - the object
+ * @retval NULL  - heap is empty
+ *
+ */
+extern void *pbs_heap_top(void *heap, long *key);
+
+/**
+ * @brief
+ *	number of objects in the heap
+ *
+ * @param[in] - heap - pointer to heap
+ *
+ * @return int
+ *
+ */
+extern int pbs_heap_count(void *heap);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _PBS_HEAP_H */
@@ -256,6 +256,7 @@ struct pbsnode {
 	void *nd_lic_info;			/* information set and used for licensing */
 	int nd_added_to_unlicensed_list;/* To record if the node is added to the list of unlicensed node */
 	pbs_list_link un_lic_link;		/*Link to unlicense list */
+	pbs_list_link nd_dirtynodes;		/* link to nodes not yet saved */
 };
 
 enum	warn_codes { WARN_none, WARN_ngrp_init, WARN_ngrp_ck, WARN_ngrp };
@@ -368,6 +369,7 @@ extern struct tree *ipaddrs;
 extern struct tree *streams;
 extern mominfo_t **mominfo_array;
 extern pntPBS_IP_LIST pbs_iplist;
+extern long pbs_iplist_gen;
 extern int mominfo_array_size;
 extern int mom_send_vnode_map;
 extern int svr_num_moms;
@@ -424,6 +426,7 @@ extern 	int	fix_indirectness(resource *, struct pbsnode *, int);
 extern	int	chk_vnode_pool(attribute *, void *, int);
 extern	void	free_pnode(struct pbsnode *);
 extern	int	save_nodes_db(int, void *);
+extern	int	save_vnode_db(struct pbsnode *);
 extern void	propagate_socket_licensing(mominfo_t *);
 
 extern char *msg_daemonname;
@@ -442,7 +445,40 @@ extern char *msg_daemonname;
 
 
 #ifndef PBS_MOM
+/*
+ * A job's exec_vnode parsed once, see job_exec_vnode(): for each '+'
+ * separated chunk the vnode and the resources assigned from it.  The
+ * strings point into evn_buf, a munged copy of evn_str.
+ */
+typedef struct exec_vnode_resc {
+	char *er_name;		 /* resource name */
+	char *er_val;		 /* resource value */
+	resource_def *er_def;	 /* its definition, NULL if unknown */
+} exec_vnode_resc;
+
+typedef struct exec_vnode_chunk {
+	char *ec_vname;		 /* vnode name */
+	struct pbsnode *ec_pnode; /* the vnode, NULL if unknown */
+	int ec_hasprn;		 /* parenthesis, as set by parse_plus_spec_r() */
+	int ec_nresc;		 /* number of entries in ec_resc */
+	exec_vnode_resc *ec_resc; /* resources assigned from the vnode */
+} exec_vnode_chunk;
+
+typedef struct exec_vnode_cache {
+	char *evn_str;		 /* exec_vnode string parsed */
+	long evn_gen;		 /* node and resource generation parsed in */
+	int evn_nchunk;		 /* number of entries in evn_chunk */
+	exec_vnode_chunk *evn_chunk;
+	char *evn_buf;		 /* parsed copy of evn_str */
+} exec_vnode_cache;
+
+extern exec_vnode_cache *parse_exec_vnode(char *);
+extern exec_vnode_cache *job_exec_vnode(job *, char *);
+extern void free_exec_vnode(exec_vnode_cache *);
+extern void invalidate_exec_vnode_caches(void);
+
 extern int node_save_db(struct pbsnode *pnode);
+extern int node_save_db_now(struct pbsnode *pnode);
 struct pbsnode *node_recov_db(char *nd_name, struct pbsnode *pnode);
 extern int add_mom_to_pool(mominfo_t *);
 extern void remove_mom_from_pool(mominfo_t *);
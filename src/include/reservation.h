@@ -147,6 +147,7 @@ struct resc_resv {
 	pbs_list_link		ri_allresvs;		/* links this resc_resv into the
 							 * server's global list
 							 */
+	pbs_list_link		ri_dirtyresvs;		/* link to resvs not yet saved */
 
 	struct pbs_queue	*ri_qp;			/* pbs_queue that got created
 							 * to support this "reservation
@@ -204,6 +205,8 @@ struct resc_resv {
 	int			req_sched_count;
 	int			rep_sched_count;
 
+	struct status_cache	*ri_stcache[PBS_STCACHE_VIEWS];	/* encoded status per view and encoding */
+
 	/*
 	 * fixed size internal data - maintained via "quick save"
 	 * some of the items are copies of attributes, if so this
@@ -309,6 +312,7 @@ extern  long determine_resv_retry(resc_resv *presv);
 
 extern resc_resv *resv_recov_db(char *resvid, resc_resv *presv);
 extern int resv_save_db(resc_resv *presv);
+extern int resv_save_db_now(resc_resv *presv);
 extern void pbsd_init_resv(resc_resv *presv, int type);
 
 #ifdef	__cplusplus
@@ -133,6 +133,7 @@ extern resource *add_resource_entry(attribute *, resource_def *);
 extern int cr_rescdef_idx(resource_def *resc_def, int limit);
 extern resource_def *find_resc_def(resource_def *, char *);
 extern resource *find_resc_entry(const attribute *, resource_def *);
+extern void free_resc_index(attribute *);
 extern int update_resource_def_file(char *name, resdef_op_t op, int type, int perms);
 extern int add_resource_def(char *name, int type, int perms);
 extern int restart_python_interpreter(const char *);
@@ -152,6 +152,7 @@ extern	long	resv_retry_time;
 #define MAX_WALLTIME "max_walltime"
 #define SOFT_WALLTIME "soft_walltime"
 #define MCAST_WAIT_TM	2
+#define MCAST_ADDR_MAX_WAIT	30	/* max delay of a cluster addrs update held back by node creates */
 
 /*
  * Server failover role
@@ -168,6 +169,9 @@ enum failover_state {
  */
 #define SVR_CLEAN_JOBHIST_TM		120	/* after 2 minutes, reschedule the work task */
 #define SVR_CLEAN_JOBHIST_SECS	5	/* never spend more than 5 seconds in one sweep to clean hist */
+#define SVR_CLEAN_JOBHIST_BATCH	1000	/* purge at most this many history jobs in one sweep */
+#define SVR_NODE_SAVE_FLUSH_TM	5	/* write queued node saves at most this often */
+#define SVR_DELJOB_CHUNK	1000	/* delete at most this many jobs of a list in one pass */
 #define SVR_JOBHIST_DEFAULT		1209600	/* default time period to keep job history: 2 weeks */
 #define SVR_MAX_JOB_SEQ_NUM_DEFAULT	9999999	/* default max job id is 9999999 */
 
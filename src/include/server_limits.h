@@ -72,6 +72,12 @@ extern "C" {
 #define PBS_NET_RETRY_LIMIT 14400 /* Max retry time */
 #define PBS_SCHEDULE_CYCLE    600 /* re-schedule even if no change, 10 min   */
 #define PBS_RESTAT_JOB	       30 /* ask mom for status only once in 30 sec  */
+#define PBS_SNAPSHOT_MIN_OBJS 20000 /* status this many jobs/nodes in a child */
+#define PBS_STCACHE_VIEWS 4 /* user and privileged view, each in both DIS encodings */
+#define PBS_SNAPSHOT_MAX_CHILDREN 4 /* max children serving status requests */
+#define PBS_RECOV_MT_MIN_JOBS 1000 /* decode jobs on threads from this many */
+#define PBS_RECOV_MAX_THREADS   8 /* max threads decoding jobs at startup */
+#define PBS_SVR_MAX_THREADS (2 + PBS_RECOV_MAX_THREADS) /* main, TPP and decode threads */
 #define PBS_STAGEFAIL_WAIT   1800 /* retry time after stage in failuere */
 #define PBS_MAX_ARRAY_JOB_DFL 10000 /* default max size of an array job */
 
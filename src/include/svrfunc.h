@@ -73,6 +73,7 @@ extern void process_Dreply(int);
 extern void process_DreplyTPP(int);
 extern void process_request(int);
 extern void process_dis_request(int);
+extern int resume_deletejob_lists(void);
 extern int save_flush(void);
 extern void save_setup(int);
 extern int save_struct(char *, unsigned int);
@@ -122,6 +123,7 @@ extern int apply_select_inchunk_rules(resource *, attribute *, void *, int, int)
 extern int svr_create_tmp_jobscript(job *, char *);
 extern void unset_jobscript_max_size(void);
 extern char *svr_load_jobscript(job *);
+extern int svr_save_jobscript(job *);
 extern int direct_write_requested(job *);
 extern void spool_filename(job *, char *, char *);
 extern enum failover_state are_we_primary(void);
@@ -135,6 +137,12 @@ extern int make_schedselect(attribute *, resource *, pbs_queue *, attribute *);
 extern long long get_next_svr_sequence_id(void);
 extern int compare_obj_hash(void *, int , void *);
 extern void panic_stop_db();
+extern void defer_db_saves(void);
+extern int db_saves_deferred(void);
+extern void flush_db_saves(void);
+extern int defer_job_delete(char *);
+extern int job_delete_pending(char *);
+extern void urgent_node_saves(void);
 extern void free_db_attr_list(pbs_db_attr_list_t *);
 extern void req_stat_svr_ready(struct work_task *);
 
@@ -357,6 +365,15 @@ struct deferred_request {
 
 #endif /* _LIST_LINK_H */
 
+struct status_cache;
+struct status_blob;
+#ifdef _BATCH_REQUEST_H
+extern int status_attrib_cached(struct status_cache **, struct batch_request *, svrattrl *, void *,
+	attribute_def *, attribute *, int, struct brp_status *, int *);
+#endif /* _BATCH_REQUEST_H */
+extern void release_status_blob(struct status_blob *);
+extern void free_status_cache(struct status_cache **);
+
 /*
  * The following is used are req_stat.c and req_select.c
  * Also defined in status_job.c
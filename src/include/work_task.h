@@ -43,6 +43,7 @@
 extern "C" {
 #endif
 
+#include "pbs_heap.h"
 
 /*
  * Server Work Tasks
@@ -51,6 +52,10 @@ extern "C" {
  *
  * This information need not be preserved.
  *
+ * Timed tasks are also kept in a heap ordered by their start time, and
+ * tasks with a wt_parm1 are linked by it in an index, so that neither
+ * adding a timed task nor finding the tasks of an object walks the lists.
+ *
  * Other Required Header Files
  *	"list_link.h"
  */
@@ -79,9 +84,12 @@ struct work_task  {
 	pbs_list_link	 wt_linkevent;	/* link to event type work list */
 	pbs_list_link	 wt_linkobj;	/* link to others of same object */
 	pbs_list_link	 wt_linkobj2;   /* link to another set of similarity */
+	pbs_list_link	 wt_linkparm;	/* link to tasks with same wt_parm1 */
+	pbs_heap_entry	 wt_heap;	/* entry in timed task heap */
 	long		 wt_event;	/* event id: time, pid, socket, ... */
 	char		*wt_event2;	/* if replies on the same handle, then additional distinction */
 	enum work_type	 wt_type;	/* type of event */
+	enum work_type	 wt_list_type;	/* type deciding the event list the task is on */
 	void		(*wt_func)(struct work_task *);	/* function to perform task */
 	void		*wt_parm1;	/* obj pointer for use by func */
 	void		*wt_parm2;	/* optional pointer for use by func */
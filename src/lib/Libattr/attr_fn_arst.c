@@ -113,6 +113,7 @@ decode_arst_direct(struct attribute *patr, char *val)
 	char			*pbuf = NULL;
 	char			*pc;
 	char			*pstr;
+	char			*savep;
 	struct array_strings	*stp = NULL;
 	int			 rc;
 	char			 strbuf[BUF_SIZE];	/* Should handle most values */
@@ -172,14 +173,14 @@ decode_arst_direct(struct attribute *patr, char *val)
 	/* now copy in substrings and set pointers */
 	pc = pbuf;
 	j = 0;
-	pstr = parse_comma_string(sbufp);
+	pstr = parse_comma_string(sbufp, &savep);
 	while ((pstr != NULL) && (j < ns)) {
 		stp->as_string[j] = pc;
 		while (*pstr) {
 			*pc++ = *pstr++;
 		}
 		*pc++ = '\0';
-		pstr = parse_comma_string(NULL);
+		pstr = parse_comma_string(NULL, &savep);
 		j++;
 	}
 
@@ -229,8 +230,7 @@ decode_arst(struct attribute *patr, char *name, char *rescn, char *val)
 
 		temp.at_flags   = 0;
 		temp.at_type    = ATR_TYPE_ARST;
-		temp.at_user_encoded = NULL;
-		temp.at_priv_encoded = NULL;
+		temp.at_ext = NULL;
 		temp.at_val.at_arst = 0;
 		if ((rc = decode_arst_direct(&temp, val)) != 0)
 			return (rc);
@@ -633,7 +633,10 @@ arst_string(char *str, attribute *pattr)
  *	On any following calls with start set to a null pointer NULL,
  *	the next value element is returned...
  *
+ *	As with strtok_r(), where to go on from is kept in *saveptr.
+ *
  * @param[in] start - string to be parsed
+ * @param[in,out] saveptr - where the parse is up to
  *
  * @return 	string
  * @retval	start address for string	Success
@@ -642,15 +645,16 @@ arst_string(char *str, attribute *pattr)
  */
 
 static char *
-parse_comma_string_bs(char *start)
+parse_comma_string_bs(char *start, char **saveptr)
 {
-	static char *pc = NULL;	/* if start is null, restart from here */
+	char	    *pc;
 	char	    *dest;
 	char	    *back;
 	char	    *rv;
 
 	if (start != NULL)
-		pc = start;
+		*saveptr = start;
+	pc = *saveptr;
 
 	/* skip over leading white space */
 	while (pc && *pc && isspace((int)*pc))
@@ -691,6 +695,7 @@ parse_comma_string_bs(char *start)
 
 	if (*pc)
 		*pc++ = '\0';	/* if not end, terminate this and adv past */
+	*saveptr = pc;
 
 	*dest = '\0';
 	back = dest;
@@ -780,6 +785,7 @@ decode_arst_direct_bs(struct attribute *patr, char *val)
 	char			*pbuf = NULL;
 	char			*pc;
 	char			*pstr;
+	char			*savep;
 	char			*sbufp = NULL;
 	struct array_strings	*stp = NULL;
 	char			 strbuf[BUF_SIZE];	/* Should handle most values */
@@ -836,14 +842,14 @@ decode_arst_direct_bs(struct attribute *patr, char *val)
 	/* now copy in substrings and set pointers */
 	pc = pbuf;
 	j = 0;
-	pstr = parse_comma_string_bs(sbufp);
+	pstr = parse_comma_string_bs(sbufp, &savep);
 	while ((pstr != NULL) && (j < ns)) {
 		stp->as_string[j] = pc;
 		while (*pstr) {
 			*pc++ = *pstr++;
 		}
 		*pc++ = '\0';
-		pstr = parse_comma_string_bs(NULL);
+		pstr = parse_comma_string_bs(NULL, &savep);
 		j++;
 	}
 
@@ -896,8 +902,7 @@ decode_arst_bs(struct attribute *patr, char *name, char *rescn, char *val)
 
 		temp.at_flags   = 0;
 		temp.at_type    = ATR_TYPE_ARST;
-		temp.at_user_encoded = NULL;
-		temp.at_priv_encoded = NULL;
+		temp.at_ext = NULL;
 		temp.at_val.at_arst = 0;
 		if ((rc = decode_arst_direct_bs(&temp, val)) != 0)
 			return (rc);
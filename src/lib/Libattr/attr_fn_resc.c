@@ -46,6 +46,7 @@
 #include <stdio.h>
 #endif
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <pbs_ifl.h>
 #include "log.h"
@@ -448,6 +449,7 @@ free_resc(attribute *pattr)
 		(void)free(pr);
 		pr = next;
 	}
+	free_resc_index(pattr);
 	free_null(pattr);
 	CLEAR_HEAD(pattr->at_val.at_list);
 }
@@ -510,6 +512,154 @@ find_resc_def(resource_def *resc_def, char *name)
 	return def;
 }
 
+/*
+ * Lookup index of a resource list, an open addressed table of the entries
+ * keyed by the address of their resource_def.  It only holds pointers to
+ * the entries in the list, so it is rebuilt rather than updated when
+ * entries are removed; see free_resc_index().
+ */
+#define RESC_INDEX_MIN	8	/* shorter lists are just walked */
+
+struct resc_index {
+	int	  ri_size;	/* number of slots, a power of 2 */
+	int	  ri_shift;	/* 32 - log2(ri_size) */
+	int	  ri_used;	/* number of slots in use */
+	resource **ri_slot;
+};
+
+/**
+ * @brief
+ * 	resc_index_slot - home slot of a resource definition in an index
+ *
+ * @param[in] pri - pointer to index
+ * @param[in] rscdf - pointer to resource_def structure
+ *
+ * @return	slot number
+ */
+static int
+resc_index_slot(struct resc_index *pri, resource_def *rscdf)
+{
+	return (int)(((uint32_t)((uintptr_t)rscdf >> 3) * 2654435761U) >> pri->ri_shift);
+}
+
+/**
+ * @brief
+ * 	resc_index_find - look up the entry for a resource definition
+ *
+ * @param[in] pri - pointer to index
+ * @param[in] rscdf - pointer to resource_def structure
+ *
+ * @return	structure handler
+ * @retval	pointer to struct resource 	Success
+ * @retval	NULL				not in the list
+ */
+static resource *
+resc_index_find(struct resc_index *pri, resource_def *rscdf)
+{
+	int i;
+	resource *pr;
+
+	for (i = resc_index_slot(pri, rscdf); (pr = pri->ri_slot[i]) != NULL;
+		i = (i + 1) & (pri->ri_size - 1)) {
+		if (pr->rs_defin == rscdf)
+			return pr;
+	}
+	return NULL;
+}
+
+/**
+ * @brief
+ * 	resc_index_add - add an entry to an index which has room for it
+ *
+ * @param[in] pri - pointer to index
+ * @param[in] pr - pointer to resource entry
+ *
+ * @return	void
+ */
+static void
+resc_index_add(struct resc_index *pri, resource *pr)
+{
+	int i;
+
+	for (i = resc_index_slot(pri, pr->rs_defin); pri->ri_slot[i] != NULL;
+		i = (i + 1) & (pri->ri_size - 1))
+		;
+	pri->ri_slot[i] = pr;
+	pri->ri_used++;
+}
+
+/**
+ * @brief
+ * 	free_resc_index - discard the lookup index of a resource list.
+ *	Must be called whenever an entry is unlinked from the list by
+ *	other means than free_resc(), the index is rebuilt by the next
+ *	add_resource_entry() on the list.
+ *
+ * @param[in] pattr - pointer to attribute of type ATR_TYPE_RESC
+ *
+ * @return	Void
+ */
+void
+free_resc_index(attribute *pattr)
+{
+	struct resc_index *pri;
+
+	if (pattr->at_ext == NULL)
+		return;
+	pri = pattr->at_ext->ae_rindex;
+	if (pri != NULL) {
+		free(pri->ri_slot);
+		free(pri);
+		pattr->at_ext->ae_rindex = NULL;
+	}
+	put_attr_ext(pattr);
+}
+
+/**
+ * @brief
+ * 	build_resc_index - (re)build the lookup index of a resource list
+ *	with room for at least twice its current number of entries.
+ *	On a malloc failure the list is left without an index and is
+ *	walked instead.
+ *
+ * @param[in] pattr - pointer to attribute of type ATR_TYPE_RESC
+ * @param[in] nent - number of entries in the list
+ *
+ * @return	Void
+ */
+static void
+build_resc_index(attribute *pattr, int nent)
+{
+	struct resc_index *pri;
+	resource *pr;
+	int size = 16;
+	int shift = 28;
+
+	free_resc_index(pattr);
+	if (get_attr_ext(pattr) == NULL)
+		return;
+	while (size < nent * 2) {
+		size <<= 1;
+		shift--;
+	}
+	if ((pri = malloc(sizeof(struct resc_index))) == NULL) {
+		put_attr_ext(pattr);
+		return;
+	}
+	if ((pri->ri_slot = calloc(size, sizeof(resource *))) == NULL) {
+		free(pri);
+		put_attr_ext(pattr);
+		return;
+	}
+	pri->ri_size = size;
+	pri->ri_shift = shift;
+	pri->ri_used = 0;
+	for (pr = (resource *)GET_NEXT(pattr->at_val.at_list); pr != NULL;
+		pr = (resource *)GET_NEXT(pr->rs_link))
+		resc_index_add(pri, pr);
+	pattr->at_ext->ae_rindex = pri;
+}
+
 /**
  * @brief
  * 	find_resc_entry - find a resource (value) entry in a list headed in
@@ -530,6 +680,8 @@ find_resc_entry(const attribute *pattr, resource_def *rscdf)
 	resource *pr;
 
 	pr = (resource *)GET_NEXT(pattr->at_val.at_list);
+	if ((pr != NULL) && (pattr->at_ext != NULL) && (pattr->at_ext->ae_rindex != NULL))
+		return (resc_index_find(pattr->at_ext->ae_rindex, rscdf));
 	while (pr != NULL) {
 		if (pr->rs_defin == rscdf)
 			break;
@@ -560,8 +712,18 @@ add_resource_entry(attribute *pattr, resource_def *prdef)
 	int 		 i;
 	resource	*new;
 	resource	*pr;
+	struct resc_index *pri;
 
 	pr = (resource *)GET_NEXT(pattr->at_val.at_list);
+	pri = (pattr->at_ext != NULL) ? pattr->at_ext->ae_rindex : NULL;
+	if (pri != NULL) {
+		if (pr == NULL) {
+			/* list was emptied or moved away, index is stale */
+			free_resc_index(pattr);
+			pri = NULL;
+		} else if ((new = resc_index_find(pri, prdef)) != NULL)
+			return (new);
+	}
 	while (pr != NULL) {
 		i = strcasecmp(pr->rs_defin->rs_name, prdef->rs_name);
 		if (i == 0)	/* found a matching entry */
@@ -579,8 +741,7 @@ add_resource_entry(attribute *pattr, resource_def *prdef)
 	new->rs_defin = prdef;
 	new->rs_value.at_type = prdef->rs_type;
 	new->rs_value.at_flags = 0;
-	new->rs_value.at_user_encoded = 0;
-	new->rs_value.at_priv_encoded = 0;
+	new->rs_value.at_ext = NULL;
 	prdef->rs_free(&new->rs_value);
 
 	if (pr != NULL) {
@@ -588,6 +749,21 @@ add_resource_entry(attribute *pattr, resource_def *prdef)
 	} else {
 		append_link(&pattr->at_val.at_list, &new->rs_link, new);
 	}
+
+	/* keep the lookup index, start one once the list is long enough */
+	if (pri != NULL) {
+		if ((pri->ri_used + 1) * 2 > pri->ri_size)
+			build_resc_index(pattr, pri->ri_used + 1);
+		else
+			resc_index_add(pri, new);
+	} else {
+		i = 0;
+		for (pr = (resource *)GET_NEXT(pattr->at_val.at_list); pr != NULL;
+			pr = (resource *)GET_NEXT(pr->rs_link))
+			i++;
+		if (i >= RESC_INDEX_MIN)
+			build_resc_index(pattr, i);
+	}
 	pattr->at_flags |= ATR_SET_MOD_MCACHE;
 	return (new);
 }
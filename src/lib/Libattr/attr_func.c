@@ -170,7 +170,10 @@ free_svrcache(struct attribute *attr)
 	struct svrattrl *working;
 	struct svrattrl *sister;
 
-	working = attr->at_user_encoded;
+	if (attr->at_ext == NULL)
+		return;
+
+	working = attr->at_ext->ae_user_encoded;
 	if ((working != NULL) && (--working->al_refct <= 0)) {
 		while (working) {
 			sister = working->al_sister;
@@ -179,9 +182,9 @@ free_svrcache(struct attribute *attr)
 			working = sister;
 		}
 	}
-	attr->at_user_encoded = NULL;
+	attr->at_ext->ae_user_encoded = NULL;
 
-	working = attr->at_priv_encoded;
+	working = attr->at_ext->ae_priv_encoded;
 	if ((working != NULL) && (--working->al_refct <= 0)) {
 		while (working) {
 			sister = working->al_sister;
@@ -190,7 +193,9 @@ free_svrcache(struct attribute *attr)
 			working = sister;
 		}
 	}
-	attr->at_priv_encoded = NULL;
+	attr->at_ext->ae_priv_encoded = NULL;
+
+	put_attr_ext(attr);
 }
 
 /**
@@ -211,7 +216,7 @@ free_null(struct attribute *attr)
 	if (attr->at_type == ATR_TYPE_SIZE)
 		attr->at_val.at_size.atsv_shift = 10;
 	attr->at_flags &= ~(ATR_VFLAG_SET|ATR_VFLAG_INDIRECT|ATR_VFLAG_TARGET);
-	if (attr->at_user_encoded != NULL || attr->at_priv_encoded != NULL)
+	if (attr->at_ext != NULL)
 		free_svrcache(attr);
 }
 
@@ -430,18 +435,28 @@ free_svrattrl(svrattrl *pal)
  *	the next value element is returned...
  *
  *	A null pointer is returned when there are no (more) value elements.
+ *
+ *	As with strtok_r(), where to go on from is kept in *saveptr, so
+ *	several strings may be parsed at once, from several threads.
+ *
+ * @param[in]		start	- string to parse, NULL to go on
+ * @param[in,out]	saveptr	- where the parse is up to
+ *
+ * @return	char *
+ * @retval	next value element
+ * @retval	NULL	: no more elements
  */
 
 char *
-parse_comma_string(char *start)
+parse_comma_string(char *start, char **saveptr)
 {
-	static char *pc;	/* if start is null, restart from here */
-
+	char	    *pc;
 	char	    *back;
 	char	    *rv;
 
 	if (start != NULL)
-		pc = start;
+		*saveptr = start;
+	pc = *saveptr;
 
 	if (*pc == '\0')
 		return NULL;	/* already at end, no strings */
@@ -467,6 +482,7 @@ parse_comma_string(char *start)
 	if (*pc)
 		*pc++ = '\0';	/* if not end, terminate this and adv past */
 
+	*saveptr = pc;
 	return (rv);
 }
 
@@ -576,7 +592,7 @@ free_none(struct attribute *attr)
 {
 	/* do nothing */
 	/* to be used for accrue_type attribute of job */
-	if (attr->at_user_encoded != NULL || attr->at_priv_encoded != NULL) {
+	if (attr->at_ext != NULL) {
 		free_svrcache(attr);
 	}
 }
@@ -1734,6 +1750,126 @@ is_attr_set(const attribute *pattr)
 	return 0;
 }
 
+/**
+ * @brief	Get the extras of an attribute, allocating them if needed
+ *
+ * @param[in]	pattr	-	pointer to the attribute
+ *
+ * @return	struct attr_ext *
+ * @retval	pointer to the extras of pattr
+ * @retval	NULL on allocation failure
+ *
+ * @par MT-Safe: No
+ */
+struct attr_ext *
+get_attr_ext(attribute *pattr)
+{
+	if (pattr->at_ext == NULL)
+		pattr->at_ext = calloc(1, sizeof(struct attr_ext));
+	return pattr->at_ext;
+}
+
+/**
+ * @brief	Release the extras of an attribute once none of them is in use
+ *
+ * @param[in]	pattr	-	pointer to the attribute
+ *
+ * @return	void
+ *
+ * @par MT-Safe: No
+ */
+void
+put_attr_ext(attribute *pattr)
+{
+	struct attr_ext *pext = pattr->at_ext;
+
+	if (pext == NULL)
+		return;
+	if (pext->ae_user_encoded == NULL && pext->ae_priv_encoded == NULL &&
+	    pext->ae_rindex == NULL) {
+		free(pext);
+		pattr->at_ext = NULL;
+	}
+}
+
+/**
+ * @brief	Get the cached svrattrl encoding of an attribute for users
+ *
+ * @param[in]	pattr	-	pointer to the attribute
+ *
+ * @return	svrattrl *
+ * @retval	the cached encoding
+ * @retval	NULL if none is cached
+ */
+svrattrl *
+get_attr_usr_encoded(const attribute *pattr)
+{
+	if (pattr->at_ext == NULL)
+		return NULL;
+	return pattr->at_ext->ae_user_encoded;
+}
+
+/**
+ * @brief	Get the cached svrattrl encoding of an attribute for mgr/op
+ *
+ * @param[in]	pattr	-	pointer to the attribute
+ *
+ * @return	svrattrl *
+ * @retval	the cached encoding
+ * @retval	NULL if none is cached
+ */
+svrattrl *
+get_attr_priv_encoded(const attribute *pattr)
+{
+	if (pattr->at_ext == NULL)
+		return NULL;
+	return pattr->at_ext->ae_priv_encoded;
+}
+
+/**
+ * @brief	Cache the svrattrl encoding of an attribute for users
+ *
+ * @param[in]	pattr	-	pointer to the attribute
+ * @param[in]	encoded	-	encoding to cache, the previous one is not freed
+ *
+ * @return	int
+ * @retval	0 on success
+ * @retval	1 on allocation failure, nothing is cached
+ */
+int
+set_attr_usr_encoded(attribute *pattr, svrattrl *encoded)
+{
+	if (encoded == NULL && pattr->at_ext == NULL)
+		return 0;
+	if (get_attr_ext(pattr) == NULL)
+		return 1;
+	pattr->at_ext->ae_user_encoded = encoded;
+	put_attr_ext(pattr);
+	return 0;
+}
+
+/**
+ * @brief	Cache the svrattrl encoding of an attribute for mgr/op
+ *
+ * @param[in]	pattr	-	pointer to the attribute
+ * @param[in]	encoded	-	encoding to cache, the previous one is not freed
+ *
+ * @return	int
+ * @retval	0 on success
+ * @retval	1 on allocation failure, nothing is cached
+ */
+int
+set_attr_priv_encoded(attribute *pattr, svrattrl *encoded)
+{
+	if (encoded == NULL && pattr->at_ext == NULL)
+		return 0;
+	if (get_attr_ext(pattr) == NULL)
+		return 1;
+	pattr->at_ext->ae_priv_encoded = encoded;
+	put_attr_ext(pattr);
+	return 0;
+}
+
 /**
  * @brief
  *		decode_sandbox - decode sandbox into string attribute
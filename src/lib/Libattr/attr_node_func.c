@@ -746,6 +746,7 @@ decode_state(attribute *pattr, char *name, char *rescn, char *val)
 	int	rc = 0;		/*return code; 0==success*/
 	unsigned long	flag, currflag;
 	char	*str;
+	char	*savep;
 
 	char	strbuf[512];	/*should handle most vals*/
 	char	*sbufp;
@@ -770,7 +771,7 @@ decode_state(attribute *pattr, char *name, char *rescn, char *val)
 
 	strcpy(sbufp, val);
 
-	if ((str = parse_comma_string(sbufp)) == NULL) {
+	if ((str = parse_comma_string(sbufp, &savep)) == NULL) {
 		if (slen >= 512)
 			free(sbufp);
 		return rc;
@@ -785,10 +786,10 @@ decode_state(attribute *pattr, char *name, char *rescn, char *val)
 	currflag = flag;
 
 	/*calling parse_comma_string with a null ptr continues where*/
-	/*last call left off.  The initial comma separated string   */
+	/*savep says.  The initial comma separated string           */
 	/*copy pointed to by sbufp is modified with each func call  */
 
-	while ((str = parse_comma_string(NULL)) != 0) {
+	while ((str = parse_comma_string(NULL, &savep)) != 0) {
 		if ((rc = set_nodeflag(str, &flag)) != 0)
 			break;
 
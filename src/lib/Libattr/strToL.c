@@ -40,7 +40,9 @@
 
 #include <pbs_config.h>   /* the master config generated by configure */
 
+#include <ctype.h>
 #include <errno.h>
+#include <stddef.h>
 #include "Long.h"
 #include "Long_.h"
 
@@ -88,9 +90,16 @@ Long
 strToL(const char *nptr, char **endptr, int base)
 {
 	Long		value;
+	const char	*cp;
+	int		neg = 0;
 
+	if ((cp = nptr) != NULL) {
+		while (isspace(*cp))
+			cp++;
+		neg = (*cp == '-');
+	}
 	value = (Long)strTouL(nptr, endptr, base);
-	if (Long_neg) {
+	if (neg) {
 		if (value >= 0) {
 			value = lONG_MIN;
 			errno = ERANGE;
@@ -62,10 +62,31 @@
 #define FALSE 0
 #endif
 
-static unsigned x_val;
-static const char letters[] = "abcdefghijklmnopqrstuvwxyz";
 static const char Long_dig[] = LONG_DIG_VALUE;
-static char table[UCHAR_MAX + 1];
+
+/**
+ * @brief
+ *	digit value of a character in any base up to 36, either case
+ *
+ * @par
+ *	Worked out per character rather than from a lazily built table, so
+ *	that strTouL() keeps no state and may be called from several threads.
+ *
+ * @param[in]	c - character to convert
+ *
+ * @return	unsigned
+ * @retval	0-35	value of the digit
+ * @retval	CHAR_MAX	not a digit
+ */
+static unsigned
+digit_val(unsigned char c)
+{
+	if (isdigit(c))
+		return (c - '0');
+	if (isalpha(c) && isascii(c))
+		return (tolower(c) - 'a' + 10);
+	return (CHAR_MAX);
+}
 
 /**
  * @brief
@@ -98,6 +119,8 @@ u_Long
 strTouL(const char *nptr, char **endptr, int base)
 {
 	unsigned	digit;
+	unsigned	x_val = digit_val('x');
+	int		neg;
 	u_Long		limit = 0, value;
 	enum {
 		unknown1,
@@ -110,16 +133,6 @@ strTouL(const char *nptr, char **endptr, int base)
 		overflow
 	}		state;
 
-	if (table[(unsigned char)'1'] != 1) {
-		int	i;		/* Initialize conversion table */
-
-		(void)memset(table, CHAR_MAX, sizeof(table));
-		for (i = (int)strlen(Long_dig) - 1; i >= 0; i--)
-			table[(unsigned char)Long_dig[i]] = i;
-		for (i = (int)strlen(letters) - 1; i >= 0; i--)
-			table[(unsigned char)letters[i]] = i + 10;
-		x_val = table[(unsigned char)'x'];
-	}
 	if (nptr == NULL) {
 		if (endptr != NULL)
 			*endptr = (char *)nptr;
@@ -142,15 +155,15 @@ strTouL(const char *nptr, char **endptr, int base)
 			state = known;
 	}
 	while (isspace(*nptr++));
-	Long_neg = FALSE;
+	neg = FALSE;
 	switch (*--nptr) {
 		case '-':
-			Long_neg = TRUE;
+			neg = TRUE;
 		case '+':
 			nptr++;
 	}
 	value = 0;
-	while ((digit = table[(unsigned char)*nptr++]) != CHAR_MAX) {
+	while ((digit = digit_val((unsigned char)*nptr++)) != CHAR_MAX) {
 		switch (state) {
 			case unknown1:
 				if (digit >= 10)
@@ -228,7 +241,7 @@ done:
 			nptr--;
 		*endptr = (char *)--nptr;
 	}
-	if (Long_neg)
+	if (neg)
 		errno = ERANGE;
 	return value;
 }
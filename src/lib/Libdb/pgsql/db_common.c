@@ -891,6 +891,61 @@ pbs_db_save_obj(void *conn, pbs_db_obj_info_t *obj, int savetype)
 	return (db_fn_arr[obj->pbs_db_obj_type].pbs_db_save_obj(conn, obj, savetype));
 }
 
+/**
+ * @brief
+ *	Start a transaction, the following saves and deletes are
+ *	committed together by pbs_db_end_trx()
+ *
+ * @param[in]	conn - Connected database handle
+ *
+ * @return      Error code
+ * @retval	-1  - Failure
+ * @retval	 0  - Success
+ *
+ */
+int
+pbs_db_begin_trx(void *conn)
+{
+	return (db_execute_str(conn, "BEGIN") == -1 ? -1 : 0);
+}
+
+/**
+ * @brief
+ *	End the transaction started by pbs_db_begin_trx()
+ *
+ * @par
+ *	COMMIT of a transaction in which a statement failed succeeds as a
+ *	command but rolls back, and says so in its command tag, so the tag
+ *	is what tells whether the commit took.
+ *
+ * @param[in]	conn - Connected database handle
+ * @param[in]	how - PBS_DB_COMMIT or PBS_DB_ROLLBACK
+ *
+ * @return      Error code
+ * @retval	-1  - Failure, or the commit was rolled back
+ * @retval	 0  - Success
+ *
+ */
+int
+pbs_db_end_trx(void *conn, int how)
+{
+	PGresult *res;
+	char *sql = (how == PBS_DB_COMMIT) ? "COMMIT" : "ROLLBACK";
+	int rc = 0;
+
+	res = PQexec((PGconn *)conn, sql);
+	if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+		db_set_error(conn, &errmsg_cache, "Execution of string statement\n", sql,
+			PQresultErrorField(res, PG_DIAG_SQLSTATE));
+		rc = -1;
+	} else if (strcmp(PQcmdStatus(res), sql) != 0) {
+		db_set_error(conn, &errmsg_cache, "Transaction end\n", sql, PQcmdStatus(res));
+		rc = -1;
+	}
+	PQclear(res);
+	return rc;
+}
+
 /**
  * @brief
  *	Delete attributes of an object from the database
@@ -170,17 +170,36 @@ db_prepare_job_sqls(void *conn)
 		return -1;
 
 	/*
-	 * Use the sql encode function to encode the $2 parameter. Encode using
-	 * 'escape' mode. Encode considers $2 as a bytea and returns a escaped
+	 * A job refers to an already stored script by bumping its reference
+	 * count, this inserts no row if the script is not stored yet.
+	 */
+	snprintf(conn_sql, MAX_SQL_LENGTH, "with d as "
+		"(update pbs.job_scr_data set sc_refct = sc_refct + 1 "
+		"where sc_hash = $2 returning sc_hash) "
+		"insert into pbs.job_scr (ji_jobid, sc_hash) "
+		"select $1::text, sc_hash from d");
+	if (db_prepare_stmt(conn, STMT_INSERT_JOBSCR_REF, conn_sql, 2) != 0)
+		return -1;
+
+	/*
+	 * Use the sql encode function to encode the $3 parameter. Encode using
+	 * 'escape' mode. Encode considers $3 as a bytea and returns a escaped
 	 * string using 'escape' syntax. Refer to the following postgres link
 	 * for details:
 	 * http://www.postgresql.org/docs/8.3/static/functions-string.html
 	 */
-	snprintf(conn_sql, MAX_SQL_LENGTH, "insert into "
-		"pbs.job_scr (ji_jobid, script) "
-		"values "
-		"($1, encode($2, 'escape'))");
-	if (db_prepare_stmt(conn, STMT_INSERT_JOBSCR, conn_sql, 2) != 0)
+	snprintf(conn_sql, MAX_SQL_LENGTH, "with d as "
+		"(insert into pbs.job_scr_data (sc_hash, sc_refct, script) "
+		"values ($2, 1, encode($3, 'escape')) returning sc_hash) "
+		"insert into pbs.job_scr (ji_jobid, sc_hash) "
+		"select $1::text, sc_hash from d");
+	if (db_prepare_stmt(conn, STMT_INSERT_JOBSCR, conn_sql, 3) != 0)
+		return -1;
+
+	snprintf(conn_sql, MAX_SQL_LENGTH, "select sc_hash "
+		"from pbs.job_scr "
+		"where ji_jobid = $1");
+	if (db_prepare_stmt(conn, STMT_SELECT_JOBSCR_HASH, conn_sql, 1) != 0)
 		return -1;
 
 	/*
@@ -192,8 +211,8 @@ db_prepare_job_sqls(void *conn)
 	 * http://www.postgresql.org/docs/8.3/static/functions-string.html
 	 */
 	snprintf(conn_sql, MAX_SQL_LENGTH, "select decode(script, 'escape')::bytea as script "
-		"from pbs.job_scr "
-		"where ji_jobid = $1");
+		"from pbs.job_scr_data "
+		"where sc_hash = $1");
 	if (db_prepare_stmt(conn, STMT_SELECT_JOBSCR, conn_sql, 1) != 0)
 		return -1;
 
@@ -247,49 +266,54 @@ db_prepare_job_sqls(void *conn)
 	if (db_prepare_stmt(conn, STMT_DELETE_JOB, conn_sql, 1) != 0)
 		return -1;
 
-	snprintf(conn_sql, MAX_SQL_LENGTH, "delete from pbs.job_scr where ji_jobid = $1");
+	snprintf(conn_sql, MAX_SQL_LENGTH, "with s as "
+		"(delete from pbs.job_scr where ji_jobid = $1 returning sc_hash) "
+		"update pbs.job_scr_data d set sc_refct = d.sc_refct - 1 "
+		"from s where d.sc_hash = s.sc_hash "
+		"returning d.sc_hash, d.sc_refct");
 	if (db_prepare_stmt(conn, STMT_DELETE_JOBSCR, conn_sql, 1) != 0)
 		return -1;
 
+	snprintf(conn_sql, MAX_SQL_LENGTH, "delete from pbs.job_scr_data "
+		"where sc_hash = $1 and sc_refct <= 0");
+	if (db_prepare_stmt(conn, STMT_DELETE_JOBSCR_DATA, conn_sql, 1) != 0)
+		return -1;
+
 	return 0;
 }
 
+/* column numbers of the job table fields, see init_job_fnums() */
+static int ji_jobid_fnum;
+static int ji_state_fnum;
+static int ji_substate_fnum;
+static int ji_svrflags_fnum;
+static int ji_stime_fnum;
+static int ji_queue_fnum;
+static int ji_destin_fnum;
+static int ji_un_type_fnum;
+static int ji_exitstat_fnum;
+static int ji_quetime_fnum;
+static int ji_rteretry_fnum;
+static int ji_fromsock_fnum;
+static int ji_fromaddr_fnum;
+static int ji_jid_fnum;
+static int ji_credtype_fnum;
+static int ji_qrank_fnum;
+static int attributes_fnum;
+static int fnums_inited = 0;
+
 /**
  * @brief
- *	Load job data from the row into the job object
+ *	Cache the column numbers of the job table fields in a resultset
  *
  * @param[in]	res - Resultset from an earlier query
- * @param[out]  pj  - Job object to load data into
- * @param[in]	row - The current row to load within the resultset
  *
- * @return error code
- * @retval 0 Success
- * @retval -1 Error
+ * @par MT-safe: No, but once called the column numbers are only read
  *
  */
-static int
-load_job(const  PGresult *res, pbs_db_job_info_t *pj, int row)
+static void
+init_job_fnums(const PGresult *res)
 {
-	char *raw_array;
-	static int ji_jobid_fnum;
-	static int ji_state_fnum;
-	static int ji_substate_fnum;
-	static int ji_svrflags_fnum;
-	static int ji_stime_fnum;
-	static int ji_queue_fnum;
-	static int ji_destin_fnum;
-	static int ji_un_type_fnum;
-	static int ji_exitstat_fnum;
-	static int ji_quetime_fnum;
-	static int ji_rteretry_fnum;
-	static int ji_fromsock_fnum;
-	static int ji_fromaddr_fnum;
-	static int ji_jid_fnum;
-	static int ji_credtype_fnum;
-	static int ji_qrank_fnum;
-	static int attributes_fnum;
-	static int fnums_inited = 0;
-
 	if (fnums_inited == 0) {
 		/* cache the column numbers of various job table fields */
 		ji_jobid_fnum = PQfnumber(res, "ji_jobid");
@@ -311,6 +335,27 @@ load_job(const  PGresult *res, pbs_db_job_info_t *pj, int row)
 		attributes_fnum = PQfnumber(res, "attributes");
 		fnums_inited = 1;
 	}
+}
+
+/**
+ * @brief
+ *	Load job data from the row into the job object
+ *
+ * @param[in]	res - Resultset from an earlier query
+ * @param[out]  pj  - Job object to load data into
+ * @param[in]	row - The current row to load within the resultset
+ *
+ * @return error code
+ * @retval 0 Success
+ * @retval -1 Error
+ *
+ */
+static int
+load_job(const  PGresult *res, pbs_db_job_info_t *pj, int row)
+{
+	char *raw_array;
+
+	init_job_fnums(res);
 
 	GET_PARAM_STR(res, row, pj->ji_jobid, ji_jobid_fnum);
 	GET_PARAM_INTEGER(res, row, pj->ji_state, ji_state_fnum);
@@ -509,6 +554,111 @@ pbs_db_next_job(void *conn, void *st, pbs_db_obj_info_t *obj)
 	return load_job(state->res, obj->pbs_db_un.pbs_db_job, state->row);
 }
 
+/**
+ * @brief
+ *	Run the query for all jobs, ordered by queue rank, and hand the
+ *	resultset back to the caller. Unlike pbs_db_search(), the rows can then
+ *	be loaded in any order and by several threads at once, see
+ *	pbs_db_load_job_row().
+ *
+ * @param[in]	conn  - Connection handle
+ * @param[out]	count - Number of jobs found, -1 on failure
+ *
+ * @return	Resultset, to be released with pbs_db_free_jobs()
+ * @retval	NULL - Failure (*count is -1) or no jobs found (*count is 0)
+ *
+ */
+void *
+pbs_db_find_jobs(void *conn, int *count)
+{
+	PGresult *res;
+	int rc;
+
+	*count = 0;
+	if ((rc = db_query(conn, STMT_FINDJOBS_ORDBY_QRANK, 0, &res)) != 0) {
+		if (rc == -1)
+			*count = -1;
+		return NULL;
+	}
+
+	/* cache the column numbers before any thread reads a row */
+	init_job_fnums(res);
+	*count = PQntuples(res);
+
+	return res;
+}
+
+/**
+ * @brief
+ *	Load one row of a resultset returned by pbs_db_find_jobs()
+ *
+ * @param[in]	res   - Resultset from pbs_db_find_jobs()
+ * @param[in]	row   - Row to load, each row must be loaded only once
+ * @param[out]	dbjob - Job information is loaded into this object
+ *
+ * @return      Error code
+ * @retval	-1 - Failure
+ * @retval	 0 - Success
+ *
+ * @par MT-safe: Yes, as long as different threads load different rows
+ *
+ */
+int
+pbs_db_load_job_row(void *res, int row, pbs_db_job_info_t *dbjob)
+{
+	return load_job((PGresult *) res, dbjob, row);
+}
+
+/**
+ * @brief
+ *	Release a resultset returned by pbs_db_find_jobs()
+ *
+ * @param[in]	res - Resultset to free
+ *
+ */
+void
+pbs_db_free_jobs(void *res)
+{
+	PQclear((PGresult *) res);
+}
+
+/**
+ * @brief
+ *	Drop the reference of a job to its script, and the script itself
+ *	once no job refers to it any more
+ *
+ * @param[in]	conn - Connection handle, with the job id loaded as $1
+ *
+ * @return      Error code
+ * @retval	-1 - Failure
+ * @retval	 0 - Success
+ *
+ */
+static int
+db_delete_jobscr(void *conn)
+{
+	PGresult *res;
+	char hash[PBS_DB_SCRHASH_LEN + 1];
+	int refct;
+	int rc;
+
+	if ((rc = db_query(conn, STMT_DELETE_JOBSCR, 1, &res)) != 0)
+		return (rc == 1 ? 0 : -1);	/* 1: job had no script */
+
+	GET_PARAM_INTEGER(res, 0, refct, PQfnumber(res, "sc_refct"));
+	snprintf(hash, sizeof(hash), "%s", PQgetvalue(res, 0, PQfnumber(res, "sc_hash")));
+	PQclear(res);
+
+	if (refct > 0)
+		return 0;
+
+	SET_PARAM_STRSZ(conn_data, hash, strlen(hash), 0);
+	if (db_cmd(conn, STMT_DELETE_JOBSCR_DATA, 1) == -1)
+		return -1;
+
+	return 0;
+}
+
 /**
  * @brief
  *	Delete the job from the database
@@ -532,7 +682,7 @@ pbs_db_delete_job(void *conn, pbs_db_obj_info_t *obj)
 	if ((rc = db_cmd(conn, STMT_DELETE_JOB, 1)) == -1)
 		goto err;
 
-	if (db_cmd(conn, STMT_DELETE_JOBSCR, 1) == -1)
+	if (db_delete_jobscr(conn) == -1)
 		goto err;
 
 	return rc;
@@ -542,7 +692,8 @@ err:
 
 /**
  * @brief
- *	Insert job script
+ *	Insert job script. The job refers to the stored copy of a script with
+ *	the same sc_hash if there is one, else the script is stored.
  *
  * @param[in]	conn - Connection handle
  * @param[in]	obj  - Job script object
@@ -558,8 +709,14 @@ int
 pbs_db_save_jobscr(void *conn, pbs_db_obj_info_t *obj, int savetype)
 {
 	pbs_db_jobscr_info_t *pscr = obj->pbs_db_un.pbs_db_jobscr;
+	int rc;
 
 	SET_PARAM_STR(conn_data, pscr->ji_jobid, 0);
+	SET_PARAM_STR(conn_data, pscr->sc_hash, 1);
+
+	/* most scripts are already stored for an earlier job */
+	if ((rc = db_cmd(conn, STMT_INSERT_JOBSCR_REF, 2)) != 1)
+		return rc;
 
 	/*
 	 * The script data could contain non-UTF8 characters. We therefore
@@ -568,14 +725,15 @@ pbs_db_save_jobscr(void *conn, pbs_db_obj_info_t *obj, int savetype)
 	 * and so we use the function "LOAD_BIN" to load the parameter to
 	 * the prepared statement
 	 */
-	SET_PARAM_BIN(conn_data, pscr->script, (pscr->script)?strlen(pscr->script):0, 1);
+	SET_PARAM_BIN(conn_data, pscr->script, (pscr->script)?strlen(pscr->script):0, 2);
 
-	return (db_cmd(conn, STMT_INSERT_JOBSCR, 2));
+	return (db_cmd(conn, STMT_INSERT_JOBSCR, 3));
 }
 
 /**
  * @brief
- *	load job script
+ *	load job script. If sc_hash is empty it is first looked up from
+ *	ji_jobid, the script is not loaded if sc_hashonly is set.
  *
  * @param[in]	  conn - Connection handle
  * @param[in/out] obj  - Job script is loaded into this object
@@ -583,6 +741,7 @@ pbs_db_save_jobscr(void *conn, pbs_db_obj_info_t *obj, int savetype)
  * @return      Error code
  * @retval	-1 - Failure
  * @retval	 0 - Success
+ * @retval	 1 - No script found
  *
  */
 int
@@ -592,8 +751,19 @@ pbs_db_load_jobscr(void *conn, pbs_db_obj_info_t *obj)
 	pbs_db_jobscr_info_t *pscr = obj->pbs_db_un.pbs_db_jobscr;
 	char *script = NULL;
 	static int script_fnum = -1;
+	int rc;
 
-	SET_PARAM_STR(conn_data, pscr->ji_jobid, 0);
+	if (pscr->sc_hash[0] == '\0') {
+		SET_PARAM_STR(conn_data, pscr->ji_jobid, 0);
+		if ((rc = db_query(conn, STMT_SELECT_JOBSCR_HASH, 1, &res)) != 0)
+			return rc;
+		snprintf(pscr->sc_hash, sizeof(pscr->sc_hash), "%s", PQgetvalue(res, 0, 0));
+		PQclear(res);
+	}
+	if (pscr->sc_hashonly)
+		return 0;
+
+	SET_PARAM_STR(conn_data, pscr->sc_hash, 0);
 
 	/*
 	 * The data (script) we stored was a "encoded" binary. We "decode" it
@@ -603,8 +773,8 @@ pbs_db_load_jobscr(void *conn, pbs_db_obj_info_t *obj)
 	 * auto-reset switch which resets to 0 (TEXT) mode after each execution
 	 * of pbs_db_query.
 	 */
-	if (db_query(conn, STMT_SELECT_JOBSCR, 1, &res) != 0)
-		return -1;
+	if ((rc = db_query(conn, STMT_SELECT_JOBSCR, 1, &res)) != 0)
+		return rc;
 
 	if (script_fnum == -1)
 		script_fnum = PQfnumber(res, "script");
@@ -95,8 +95,11 @@ extern "C" {
 
 /* JOBSCR stands for job script */
 #define STMT_INSERT_JOBSCR "insert_jobscr"
+#define STMT_INSERT_JOBSCR_REF "insert_jobscr_ref"
 #define STMT_SELECT_JOBSCR "select_jobscr"
+#define STMT_SELECT_JOBSCR_HASH "select_jobscr_hash"
 #define STMT_DELETE_JOBSCR "delete_jobscr"
+#define STMT_DELETE_JOBSCR_DATA "delete_jobscr_data"
 
 /* reservation statement names */
 #define STMT_INSERT_RESV "insert_resv"
@@ -128,6 +128,7 @@ pbs_db_truncate_all(void *conn)
 		"pbs.queue, "
 		"pbs.resv, "
 		"pbs.job_scr, "
+		"pbs.job_scr_data, "
 		"pbs.job, "
 		"pbs.server");
 
@@ -56,7 +56,7 @@ CREATE TABLE pbs.info (
     pbs_schema_version TEXT    NOT NULL
 );
 
-INSERT INTO pbs.info values('1.5.0'); /* schema version */
+INSERT INTO pbs.info values('1.6.0'); /* schema version */
 
 ---------------------- SERVER ------------------------------
 
@@ -188,12 +188,23 @@ ON pbs.job
 
 
 /*
- * Table pbs.job_scr holds the job script
+ * Table pbs.job_scr maps a job to the hash of its script
  */
 CREATE TABLE pbs.job_scr (
     ji_jobid    TEXT       NOT NULL,
-    script      TEXT
+    sc_hash     TEXT       NOT NULL
 );
 CREATE INDEX job_scr_idx ON pbs.job_scr (ji_jobid);
 
+/*
+ * Table pbs.job_scr_data holds each distinct job script once, with the
+ * number of jobs referring to it
+ */
+CREATE TABLE pbs.job_scr_data (
+    sc_hash     TEXT       NOT NULL,
+    sc_refct    INTEGER    NOT NULL,
+    script      TEXT,
+    CONSTRAINT job_scr_data_pk PRIMARY KEY (sc_hash)
+);
+
 ---------------------- END OF SCHEMA -----------------------
@@ -66,6 +66,10 @@ disrsl_(int stream, int *negate, unsigned long *value,
 	unsigned long count, int recursv);
 int disrsll_(int stream,  int  *negate,  u_Long *value, unsigned long count, int recursv);
 int diswui_(int stream, unsigned value);
+int dis_putvarint(int stream, int negate, u_Long value);
+int dis_getvarint(int stream, int *negate, u_Long *value);
+int dis_putdouble(int stream, dis_long_double_t value, unsigned ndigs);
+int dis_getdouble(int stream, dis_long_double_t *value);
 
 extern unsigned dis_dmx10;
 extern double *dis_dp10;
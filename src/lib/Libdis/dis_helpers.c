@@ -40,9 +40,11 @@
 #include <arpa/inet.h>
 #include <assert.h>
 #include <errno.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include "auth.h"
 #include "dis.h"
+#include "dis_.h"
 #include "pbs_error.h"
 #include "pbs_internal.h"
 
@@ -53,7 +55,6 @@
 static pbs_dis_buf_t *dis_get_readbuf(int);
 static pbs_dis_buf_t *dis_get_writebuf(int);
 static int dis_resize_buf(pbs_dis_buf_t *, size_t);
-static int transport_chan_is_encrypted(int);
 
 /**
  * @brief
@@ -234,7 +235,7 @@ transport_chan_get_authdef(int fd, int for_encrypt)
  * @par MT-safe: Yes
  *
  */
-static int
+int
 transport_chan_is_encrypted(int fd)
 {
 	pbs_tcp_chan_t *chan = transport_get_chan(fd);
@@ -774,6 +775,278 @@ dis_puts(int fd, const char *str, size_t ct)
 	return ct;
 }
 
+/**
+ * @brief
+ * 	dis_write_len - number of bytes in the write buffer of fd,
+ * 	including the packet header
+ *
+ * @param[in] fd - file descriptor
+ *
+ * @return size_t
+ * @retval number of bytes, 0 if nothing was put yet
+ *
+ * @par MT-safe: Yes
+ *
+ */
+size_t
+dis_write_len(int fd)
+{
+	pbs_dis_buf_t *tp = dis_get_writebuf(fd);
+
+	if (tp == NULL)
+		return 0;
+	return tp->tdis_len;
+}
+
+/**
+ * @brief
+ * 	dis_write_data - get the data put in the write buffer of fd
+ * 	after it held offset bytes, see dis_write_len()
+ *
+ * @param[in] fd - file descriptor
+ * @param[in] offset - write buffer length to start from
+ *
+ * @return char *
+ * @retval !NULL - start of the data, valid until the next put or flush
+ * @retval NULL - error
+ *
+ * @par MT-safe: Yes
+ *
+ */
+char *
+dis_write_data(int fd, size_t offset)
+{
+	pbs_dis_buf_t *tp = dis_get_writebuf(fd);
+
+	if (tp == NULL || tp->tdis_data == NULL || offset > tp->tdis_len)
+		return NULL;
+	return tp->tdis_data + offset;
+}
+
+/**
+ * @brief
+ * 	dis_is_binary - are numbers on fd sent in the binary encoding?
+ *
+ * @param[in] fd - file descriptor
+ *
+ * @return int
+ * @retval 1 - binary, see dis_putvarint()
+ * @retval 0 - Data-is-Strings
+ *
+ * @par MT-safe: Yes
+ *
+ */
+int
+dis_is_binary(int fd)
+{
+	pbs_tcp_chan_t *chan = transport_get_chan(fd);
+
+	if (chan == NULL)
+		return 0;
+	return chan->is_binary;
+}
+
+/**
+ * @brief
+ * 	dis_set_binary - switch the encoding of numbers on fd
+ *
+ * @param[in] fd - file descriptor
+ * @param[in] on - 1 for the binary encoding, 0 for Data-is-Strings
+ *
+ * @return void
+ *
+ * @par MT-safe: Yes
+ *
+ */
+void
+dis_set_binary(int fd, int on)
+{
+	pbs_tcp_chan_t *chan = transport_get_chan(fd);
+
+	if (chan != NULL)
+		chan->is_binary = on;
+}
+
+/**
+ * @brief
+ * 	dis_putvarint - write a number in the binary encoding
+ *
+ *	The magnitude goes out least significant bits first, 6 bits in the
+ *	first byte and 7 bits in each of the following ones.  The high bit
+ *	of each byte tells that another byte follows and bit 6 of the first
+ *	byte holds the sign, so signed and unsigned numbers share the format
+ *	just like they do in Data-is-Strings.  Counts of strings use the same
+ *	encoding, the characters themselves are sent as they are.
+ *
+ * @param[in] fd - file descriptor
+ * @param[in] negate - the number is negative
+ * @param[in] value - magnitude of the number
+ *
+ * @return int
+ * @retval DIS_SUCCESS - success
+ * @retval DIS_PROTO - error
+ *
+ * @par MT-safe: Yes
+ *
+ */
+int
+dis_putvarint(int fd, int negate, u_Long value)
+{
+	unsigned char buf[12];
+	int i = 0;
+
+	buf[i] = (value & 0x3f) | (negate ? 0x40 : 0);
+	value >>= 6;
+	while (value) {
+		buf[i++] |= 0x80;
+		buf[i] = value & 0x7f;
+		value >>= 7;
+	}
+	i++;
+	if (dis_puts(fd, (char *) buf, i) != i)
+		return DIS_PROTO;
+	return DIS_SUCCESS;
+}
+
+/**
+ * @brief
+ * 	dis_getvarint - read a number written by dis_putvarint()
+ *
+ * @param[in] fd - file descriptor
+ * @param[out] negate - the number is negative
+ * @param[out] value - magnitude of the number
+ *
+ * @return int
+ * @retval DIS_SUCCESS - success
+ * @retval DIS_OVERFLOW - the number does not fit in a u_Long
+ * @retval DIS_EOD/DIS_EOF - end of data
+ *
+ * @par MT-safe: Yes
+ *
+ */
+int
+dis_getvarint(int fd, int *negate, u_Long *value)
+{
+	pbs_dis_buf_t *tp = dis_get_readbuf(fd);
+	u_Long val;
+	unsigned int shift;
+	int c;
+	int unused;
+
+	if (tp == NULL)
+		return DIS_EOD;
+
+	shift = 0;
+	val = 0;
+	do {
+		if (tp->tdis_len <= 0) {
+			/* not enough data, try to get more */
+			if ((c = __recv_pkt(fd, &unused, tp)) <= 0) {
+				dis_clear_buf(tp);
+				return (c == -2 ? DIS_EOF : DIS_EOD);
+			}
+		}
+		c = (unsigned char) *tp->tdis_pos;
+		tp->tdis_pos++;
+		tp->tdis_len--;
+		if (shift == 0) {
+			*negate = (c & 0x40) != 0;
+			val = c & 0x3f;
+			shift = 6;
+		} else {
+			if (shift >= sizeof(u_Long) * CHAR_BIT ||
+				((u_Long) (c & 0x7f) << shift) >> shift != (u_Long) (c & 0x7f))
+				return DIS_OVERFLOW;
+			val |= (u_Long) (c & 0x7f) << shift;
+			shift += 7;
+		}
+	} while (c & 0x80);
+
+	*value = val;
+	return DIS_SUCCESS;
+}
+
+/**
+ * @brief
+ * 	dis_putdouble - write a floating point number in the binary encoding
+ *
+ *	The number is sent as a counted string of its decimal form rounded
+ *	to ndigs significant digits, which strtold() reads back.
+ *
+ * @param[in] fd - file descriptor
+ * @param[in] value - the number
+ * @param[in] ndigs - significant digits to keep
+ *
+ * @return int
+ * @retval DIS_SUCCESS - success
+ * @retval DIS_HUGEVAL - value is infinite
+ * @retval DIS_PROTO - error
+ *
+ * @par MT-safe: Yes
+ *
+ */
+int
+dis_putdouble(int fd, dis_long_double_t value, unsigned ndigs)
+{
+	char buf[LDBL_DIG + 16];
+	int len;
+	int rc;
+
+	if (value > LDBL_MAX || value < -LDBL_MAX)
+		return DIS_HUGEVAL;
+	len = snprintf(buf, sizeof(buf), "%.*Le", (int) ndigs - 1, (long double) value);
+	if (len < 0 || len >= (int) sizeof(buf))
+		return DIS_PROTO;
+	if ((rc = dis_putvarint(fd, 0, (u_Long) len)) != DIS_SUCCESS)
+		return rc;
+	if (dis_puts(fd, buf, len) != len)
+		return DIS_PROTO;
+	return DIS_SUCCESS;
+}
+
+/**
+ * @brief
+ * 	dis_getdouble - read a number written by dis_putdouble()
+ *
+ * @param[in] fd - file descriptor
+ * @param[out] value - the number
+ *
+ * @return int
+ * @retval DIS_SUCCESS - success
+ * @retval DIS_OVERFLOW - the number does not fit in a long double
+ * @retval !DIS_SUCCESS - other DIS error
+ *
+ * @par MT-safe: Yes
+ *
+ */
+int
+dis_getdouble(int fd, dis_long_double_t *value)
+{
+	char buf[LDBL_DIG + 16];
+	char *end;
+	u_Long len;
+	int negate;
+	int rc;
+
+	*value = 0.0L;
+	if ((rc = dis_getvarint(fd, &negate, &len)) != DIS_SUCCESS)
+		return rc;
+	if (negate)
+		return DIS_BADSIGN;
+	if (len == 0 || len >= sizeof(buf))
+		return DIS_OVERFLOW;
+	if (dis_gets(fd, buf, (size_t) len) != (int) len)
+		return DIS_EOD;
+	buf[len] = '\0';
+	errno = 0;
+	*value = strtold(buf, &end);
+	if (*end != '\0')
+		return DIS_NONDIGIT;
+	if (errno == ERANGE)
+		return DIS_OVERFLOW;
+	return DIS_SUCCESS;
+}
+
 /**
  * @brief
  *	flush dis write buffer
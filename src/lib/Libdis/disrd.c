@@ -99,6 +99,15 @@ disrd(int stream, int *retval)
 	assert(retval != NULL);
 
 	ldval = 0.0L;
+	if (dis_is_binary(stream)) {
+		locret = dis_getdouble(stream, &ldval);
+		if (locret == DIS_SUCCESS && (ldval > DBL_MAX || ldval < -DBL_MAX)) {
+			ldval = ldval < 0.0L ? -HUGE_VAL : HUGE_VAL;
+			locret = DIS_OVERFLOW;
+		}
+		*retval = locret;
+		return ((double)ldval);
+	}
 	locret = disrl_(stream, &ldval, &ndigs, &nskips, DBL_DIG, 1, 0);
 	if (locret == DIS_SUCCESS) {
 		locret = disrsi_(stream, &negate, &uexpon, 1, 0);
@@ -210,6 +210,18 @@ disrf(int stream, int *retval)
 	assert(stream >= 0);
 
 	dval = 0.0;
+	if (dis_is_binary(stream)) {
+		dis_long_double_t	ldval;
+
+		locret = dis_getdouble(stream, &ldval);
+		dval = ldval;
+		if (locret == DIS_SUCCESS && (dval > FLT_MAX || dval < -FLT_MAX)) {
+			dval = dval < 0.0 ? -HUGE_VAL : HUGE_VAL;
+			locret = DIS_OVERFLOW;
+		}
+		*retval = locret;
+		return (dval);
+	}
 	if ((locret = disrd_(stream, 1, &ndigs, &nskips, &dval, 0)) == DIS_SUCCESS) {
 		locret = disrsi_(stream, &negate, &uexpon, 1, 0);
 		if (locret == DIS_SUCCESS) {
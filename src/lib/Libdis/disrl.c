@@ -98,6 +98,10 @@ disrl(int stream, int *retval)
 	assert(retval != NULL);
 
 	ldval = 0.0L;
+	if (dis_is_binary(stream)) {
+		*retval = dis_getdouble(stream, &ldval);
+		return (ldval);
+	}
 	locret = disrl_(stream, &ldval, &ndigs, &nskips, LDBL_DIG, 1, 0);
 	if (locret == DIS_SUCCESS) {
 		locret = disrsi_(stream, &negate, &uexpon, 1, 0);
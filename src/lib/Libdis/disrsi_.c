@@ -73,6 +73,19 @@ disrsi_(int stream, int *negate, unsigned *value, unsigned count, int recursv)
 	assert(count);
 	assert(stream >= 0);
 
+	if (recursv == 0 && dis_is_binary(stream)) {
+		u_Long	binval;
+
+		if ((c = dis_getvarint(stream, negate, &binval)) != DIS_SUCCESS)
+			return (c);
+		if (binval > UINT_MAX) {
+			*value = UINT_MAX;
+			return (DIS_OVERFLOW);
+		}
+		*value = (unsigned) binval;
+		return (DIS_SUCCESS);
+	}
+
 	if (++recursv > DIS_RECURSIVE_LIMIT)
 		return (DIS_PROTO);
 	/* dis_umaxd would be initialized by prior call to dis_init_tables */
@@ -75,6 +75,19 @@ disrsl_(int stream, int *negate, unsigned long *value, unsigned long count, int
 	assert(count);
 	assert(stream >= 0);
 
+	if (recursv == 0 && dis_is_binary(stream)) {
+		u_Long	binval;
+
+		if ((c = dis_getvarint(stream, negate, &binval)) != DIS_SUCCESS)
+			return (c);
+		if (binval > ULONG_MAX) {
+			*value = ULONG_MAX;
+			return (DIS_OVERFLOW);
+		}
+		*value = (unsigned long) binval;
+		return (DIS_SUCCESS);
+	}
+
 	if (++recursv > DIS_RECURSIVE_LIMIT)
 		return (DIS_PROTO);
 
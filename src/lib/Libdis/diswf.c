@@ -91,6 +91,12 @@ diswf(int stream, double value)
 
 	assert(stream >= 0);
 
+	if (dis_is_binary(stream)) {
+		if (value > FLT_MAX || value < -FLT_MAX)
+			return (DIS_HUGEVAL);
+		return (dis_putdouble(stream, (dis_long_double_t) value, FLT_DIG));
+	}
+
 	/* Make zero a special case.  If we don't it will blow exponent		*/
 	/* calculation.								*/
 	if (value == 0.0) {
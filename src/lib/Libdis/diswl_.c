@@ -94,6 +94,9 @@ diswl_(int stream, dis_long_double_t value, unsigned ndigs)
 	assert(ndigs > 0 && ndigs <= LDBL_DIG);
 	assert(stream >= 0);
 
+	if (dis_is_binary(stream))
+		return (dis_putdouble(stream, value, ndigs));
+
 	/* Make zero a special case.  If we don't it will blow exponent		*/
 	/* calculation.								*/
 	if (value == 0.0L) {
@@ -69,6 +69,8 @@ diswui_(int stream, unsigned value)
 
 	assert(stream >= 0);
 
+	if (dis_is_binary(stream))
+		return (dis_putvarint(stream, FALSE, (u_Long) value));
 	cp = discui_(&dis_buffer[DIS_BUFSIZ], value, &ndigs);
 	*--cp = '+';
 	while (ndigs > 1)
@@ -96,7 +96,8 @@ diswull(int stream, u_Long value)
 
 	assert(stream >= 0);
 
-
+	if (dis_is_binary(stream))
+		return (dis_putvarint(stream, FALSE, value));
 	cp = discull_(&dis_buffer[DIS_BUFSIZ], value, &ndigs);
 	*--cp = '+';
 	while (ndigs > 1)
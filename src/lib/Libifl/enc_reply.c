@@ -50,6 +50,8 @@
 
 #include <pbs_config.h>   /* the master config generated by configure */
 
+#include <stdlib.h>
+#include <string.h>
 #include "libpbs.h"
 #include "list_link.h"
 #include "attribute.h"
@@ -58,6 +60,58 @@
 
 int encode_DIS_svrattrl(int sock, svrattrl *psattl);
 
+/**
+ * @brief
+ *	encode the attribute list of a status entry
+ *
+ *	If the entry has a status blob which is already filled, its bytes are
+ *	copied as they are instead of encoding brp_attr.  The server keeps
+ *	blobs apart per encoding, so a filled blob is always in the encoding
+ *	of sock.  If the blob is empty, brp_attr is encoded and the encoded
+ *	bytes are saved in the blob for the following replies.
+ *
+ * @param[in] sock - socket descriptor
+ * @param[in] pstat - status entry
+ *
+ * @return      int
+ * @retval      0	Success
+ * @retval      !0	DIS error
+ *
+ */
+static int
+encode_DIS_status_attrs(int sock, struct brp_status *pstat)
+{
+	struct status_blob *blob = pstat->brp_blob;
+	size_t start;
+	size_t len;
+	char *data;
+	int rc;
+
+	if (blob != NULL && blob->sb_data != NULL) {
+		/* brp_attr is empty when the blob came from the cache */
+		if (blob->sb_binary != dis_is_binary(sock))
+			return DIS_PROTO;
+		if (dis_puts(sock, blob->sb_data, blob->sb_len) != (int) blob->sb_len)
+			return DIS_PROTO;
+		return 0;
+	}
+
+	start = dis_write_len(sock);
+	if ((rc = encode_DIS_svrattrl(sock, (svrattrl *) GET_NEXT(pstat->brp_attr))) != 0)
+		return rc;
+
+	if (blob != NULL) {
+		len = dis_write_len(sock) - start;
+		data = dis_write_data(sock, start);
+		if (data != NULL && len > 0 && (blob->sb_data = malloc(len)) != NULL) {
+			memcpy(blob->sb_data, data, len);
+			blob->sb_len = len;
+			blob->sb_binary = dis_is_binary(sock);
+		}
+	}
+	return 0;
+}
+
 
 /**
  * @brief-
@@ -83,7 +137,6 @@ encode_DIS_reply_inner(int sock, struct batch_reply *reply)
 	struct brp_select *psel;
 	struct brp_status *pstat;
 	struct batch_deljob_status *pdelstat;
-	svrattrl *psvrl;
 	preempt_job_info *ppj;
 
 	int rc;
@@ -139,8 +192,7 @@ encode_DIS_reply_inner(int sock, struct batch_reply *reply)
 				if ((rc = diswui(sock, pstat->brp_objtype)) || (rc = diswst(sock, pstat->brp_objname)))
 					return rc;
 
-				psvrl = (svrattrl *) GET_NEXT(pstat->brp_attr);
-				if ((rc = encode_DIS_svrattrl(sock, psvrl)) != 0)
+				if ((rc = encode_DIS_status_attrs(sock, pstat)) != 0)
 					return rc;
 				pstat = (struct brp_status *) GET_NEXT(pstat->brp_stlink);
 			}
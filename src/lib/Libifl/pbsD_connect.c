@@ -173,6 +173,40 @@ get_hostsockaddr(char *host, struct sockaddr_in *sap)
 }
 
 
+/**
+ * @brief	Returns the extension to send with the Connect request.
+ *
+ * @par	Without an extension of its own the client asks the server for the
+ *	binary encoding of DIS, unless PBS_DIS_ASCII is set.  Older servers
+ *	ignore the request and the connection stays in Data-is-Strings.
+ *
+ * @param[in]   extend_data - extension asked for by the caller, or NULL
+ *
+ * @return char *
+ */
+static char *
+connect_extend(char *extend_data)
+{
+	if (extend_data != NULL || pbs_conf.pbs_dis_ascii)
+		return extend_data;
+	return PBS_DIS_BINARY_EXTEND;
+}
+
+/**
+ * @brief	Switches the connection to the binary encoding of DIS if
+ *		the server accepted it in the reply to the Connect request.
+ *
+ * @param[in]   sd - socket of the connection
+ * @param[in]   reply - reply to the Connect request, may be NULL
+ */
+static void
+connect_set_encoding(int sd, struct batch_reply *reply)
+{
+	if (reply != NULL && reply->brp_code == PBSE_NONE &&
+		reply->brp_auxcode == PBS_DIS_BINARY)
+		dis_set_binary(sd, 1);
+}
+
 /**
  * @brief	This function establishes a network connection to the given server.
  *
@@ -257,8 +291,9 @@ tcp_connect(char *hostname, int server_port, char *extend_data)
 	 * no leading authentication message needing to be sent on the client
 	 * socket, so will send a "dummy" message and discard the replyback.
 	 */
+	dis_set_binary(sd, 0);
 	if ((i = encode_DIS_ReqHdr(sd, PBS_BATCH_Connect, pbs_current_user)) ||
-		(i = encode_DIS_ReqExtend(sd, extend_data))) {
+		(i = encode_DIS_ReqExtend(sd, connect_extend(extend_data)))) {
 		closesocket(sd);
 		pbs_errno = PBSE_SYSTEM;
 		return -1;
@@ -271,6 +306,7 @@ tcp_connect(char *hostname, int server_port, char *extend_data)
 
 	pbs_errno = PBSE_NONE;
 	reply = PBSD_rdrpy(sd);
+	connect_set_encoding(sd, reply);
 	PBSD_FreeReply(reply);
 	if (pbs_errno != PBSE_NONE) {
 		closesocket(sd);
@@ -1125,8 +1161,9 @@ err:
 	 * no leading authentication message needing to be sent on the client
 	 * socket, so will send a "dummy" message and discard the replyback.
 	 */
+	dis_set_binary(sock, 0);
 	if ((i = encode_DIS_ReqHdr(sock, PBS_BATCH_Connect, pbs_current_user)) ||
-		(i = encode_DIS_ReqExtend(sock, NULL))) {
+		(i = encode_DIS_ReqExtend(sock, connect_extend(NULL)))) {
 		pbs_errno = PBSE_SYSTEM;
 		return -1;
 	}
@@ -1135,6 +1172,7 @@ err:
 		return -1;
 	}
 	reply = PBSD_rdrpy(sock);
+	connect_set_encoding(sock, reply);
 	PBSD_FreeReply(reply);
 
 	if (engage_client_auth(sock, server, server_port, errbuf, sizeof(errbuf)) != 0) {
@@ -131,6 +131,7 @@ struct pbs_config pbs_conf = {
 	NULL,					/* pbs_lr_save_path */
 	0,					/* high resolution timestamp logging */
 	0,					/* number of scheduler threads */
+	0,					/* ask servers for binary DIS */
 	NULL,					/* default scheduler user */
 	{'\0'}					/* current running user */
 #ifdef WIN32
@@ -641,6 +642,10 @@ __pbs_loadconf(int reload)
 				if (sscanf(conf_value, "%u", &uvalue) == 1)
 					pbs_conf.pbs_sched_threads = uvalue;
 			}
+			else if (!strcmp(conf_name, PBS_CONF_DIS_ASCII)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_dis_ascii = ((uvalue > 0) ? 1 : 0);
+			}
 #ifdef WIN32
 			else if (!strcmp(conf_name, PBS_CONF_REMOTE_VIEWER)) {
 				free(pbs_conf.pbs_conf_remote_viewer);
@@ -889,6 +894,10 @@ __pbs_loadconf(int reload)
 		if (sscanf(gvalue, "%u", &uvalue) == 1)
 			pbs_conf.pbs_sched_threads = uvalue;
 	}
+	if ((gvalue = getenv(PBS_CONF_DIS_ASCII)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_dis_ascii = ((uvalue > 0) ? 1 : 0);
+	}
 
 	if ((gvalue = getenv(PBS_CONF_DAEMON_SERVICE_USER)) != NULL) {
 		free(pbs_conf.pbs_daemon_service_user);
@@ -62,6 +62,7 @@
 #include "portability.h"
 #include "server_limits.h"
 #include "pbs_ifl.h"
+#include "libpbs.h"
 #include "net_connect.h"
 #include "log.h"
 #include "libsec.h"
@@ -101,6 +102,10 @@ static void	(*read_func[2])(int);
 static int	(*ready_read_func)(conn_t *);
 static char	logbuf[256];
 
+/* a writable event for a connection whose queued output was already written */
+#define IS_STALE_OUT_EVENT(ev, i, fd) \
+	((EM_GET_EVENT(ev, i) & (EM_IN | EM_HUP | EM_ERR)) == 0 && conn_queued_len(fd) == 0)
+
 /* Private function within this file */
 static int 	conn_find_usable_index(int);
 static int 	conn_find_actual_index(int);
@@ -213,6 +218,267 @@ get_conn(int sd)
 	return svr_conn[idx];
 }
 
+/**
+ * @brief
+ *	set the events polled for on a connection in all the poll contexts
+ *	it is in, from the state of its output queue
+ *
+ * @par Functionality:
+ *	The connection is polled for writability while output is queued.
+ *	Requests are read from it unless it is being closed or more than
+ *	PBS_NET_OUTQ_HIWATER bytes are queued, in which case the client has
+ *	to read its replies before it gets any more.
+ *
+ * @param[in]	conn - the connection
+ *
+ * @return	void
+ */
+static void
+conn_update_poll_events(conn_t *conn)
+{
+	size_t queued = conn->cn_outq_len - conn->cn_outq_off;
+	int events = EM_HUP | EM_ERR;
+
+	if (queued > 0)
+		events |= EM_OUT;
+	if (!conn->cn_closing && queued <= PBS_NET_OUTQ_HIWATER)
+		events |= EM_IN;
+	if (events == conn->cn_poll_events)
+		return;
+	conn->cn_poll_events = events;
+
+	if (tpp_em_mod_fd(poll_context, conn->cn_sock, events) < 0)
+		log_errf(errno, __func__, "could not modify socket %d in the poll list", conn->cn_sock);
+	if (conn->cn_prio_flag) {
+		if (tpp_em_mod_fd(priority_context, conn->cn_sock, events) < 0)
+			log_errf(errno, __func__, "could not modify socket %d in the priority poll list", conn->cn_sock);
+	}
+}
+
+/**
+ * @brief
+ *	write as much of a buffer to a connection as the socket will take
+ *	without blocking
+ *
+ * @param[in]	conn - the connection
+ * @param[in]	buf - data to write
+ * @param[in]	len - length of buf
+ *
+ * @return	ssize_t
+ * @retval	>=0 - number of bytes written
+ * @retval	-1 - write error (errno is set)
+ */
+static ssize_t
+conn_write_nb(conn_t *conn, char *buf, size_t len)
+{
+	size_t ct = 0;
+	int flg;
+	int err = 0;
+
+#ifndef WIN32
+	if ((flg = fcntl(conn->cn_sock, F_GETFL)) == -1)
+		return -1;
+	if (!(flg & O_NONBLOCK) && fcntl(conn->cn_sock, F_SETFL, flg | O_NONBLOCK) == -1)
+		return -1;
+
+	while (ct < len) {
+		int i;
+
+		i = CS_write(conn->cn_sock, buf + ct, len - ct);
+		if (i == CS_IO_FAIL) {
+			if (errno == EINTR)
+				continue;
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+				err = errno;
+			break;
+		}
+		ct += i;
+	}
+
+	if (!(flg & O_NONBLOCK))
+		(void)fcntl(conn->cn_sock, F_SETFL, flg);
+#endif
+
+	if (err) {
+		errno = err;
+		return -1;
+	}
+	return ct;
+}
+
+/**
+ * @brief
+ *	add data to the output queue of a connection
+ *
+ * @param[in]	conn - the connection
+ * @param[in]	data - data to queue
+ * @param[in]	len - length of data
+ *
+ * @return	int
+ * @retval	0 - success
+ * @retval	-1 - out of memory
+ */
+static int
+conn_queue_output(conn_t *conn, char *data, size_t len)
+{
+	size_t used = conn->cn_outq_len - conn->cn_outq_off;
+
+	if (conn->cn_outq_len + len > conn->cn_outq_size) {
+		/* reclaim space taken by output which was already written */
+		if (conn->cn_outq_off > 0) {
+			memmove(conn->cn_outq, conn->cn_outq + conn->cn_outq_off, used);
+			conn->cn_outq_off = 0;
+			conn->cn_outq_len = used;
+		}
+		if (used + len > conn->cn_outq_size) {
+			size_t nsize = conn->cn_outq_size * 2;
+			char *tmp;
+
+			if (nsize < used + len)
+				nsize = used + len;
+			if ((tmp = realloc(conn->cn_outq, nsize)) == NULL)
+				return -1;
+			conn->cn_outq = tmp;
+			conn->cn_outq_size = nsize;
+		}
+	}
+	memcpy(conn->cn_outq + conn->cn_outq_len, data, len);
+	conn->cn_outq_len += len;
+
+	return 0;
+}
+
+/**
+ * @brief
+ *	conn_send_queued - send data on a connection without blocking.
+ *
+ * @par Functionality:
+ *	This has the signature of a DIS transport send function.  Whatever the
+ *	socket won't take right away is queued on the connection and written
+ *	out by wait_request() when the socket becomes writable.  Once more
+ *	than PBS_NET_OUTQ_HIWATER bytes are queued, no more requests are read
+ *	from the connection, so a slow client only holds itself up.  If output
+ *	is already queued, the data is queued behind it to keep it in order.
+ *
+ * @param[in]	sd - socket descriptor
+ * @param[in]	data - data to send
+ * @param[in]	len - length of data
+ *
+ * @return	int
+ * @retval	len - data was sent or queued
+ * @retval	-1 - error
+ */
+int
+conn_send_queued(int sd, void *data, int len)
+{
+	conn_t *conn;
+	ssize_t ct = 0;
+
+	if ((conn = get_conn(sd)) == NULL || len < 0)
+		return -1;
+
+	if (conn->cn_outq_len == conn->cn_outq_off) {
+		if ((ct = conn_write_nb(conn, (char *) data, len)) == -1)
+			return -1;
+		if (ct == len)
+			return len;
+	}
+
+	if (conn_queue_output(conn, (char *) data + ct, len - ct) == -1)
+		return -1;
+	conn_update_poll_events(conn);
+
+	return len;
+}
+
+/**
+ * @brief
+ *	conn_flush_queued - write out the output queued on a connection
+ *
+ * @param[in]	sd - socket descriptor
+ * @param[in]	timeout - seconds to wait for all of the output to be written,
+ *			  0 to only write what can be without blocking
+ *
+ * @return	int
+ * @retval	0 - nothing is left queued
+ * @retval	1 - output is still queued
+ * @retval	-1 - write error or timeout (errno is set)
+ */
+int
+conn_flush_queued(int sd, int timeout)
+{
+	conn_t *conn;
+	time_t end;
+	int rc;
+
+	if ((conn = get_conn(sd)) == NULL)
+		return -1;
+	if (conn->cn_outq_len == conn->cn_outq_off)
+		return 0;
+
+	end = time(NULL) + timeout;
+	for (;;) {
+		ssize_t ct;
+#ifndef WIN32
+		struct pollfd pfd;
+		time_t now;
+		int i;
+#endif
+
+		ct = conn_write_nb(conn, conn->cn_outq + conn->cn_outq_off,
+			conn->cn_outq_len - conn->cn_outq_off);
+		if (ct == -1)
+			return -1;
+		conn->cn_outq_off += ct;
+		if (conn->cn_outq_off == conn->cn_outq_len) {
+			conn->cn_outq_off = conn->cn_outq_len = 0;
+			rc = 0;
+			break;
+		}
+		rc = 1;
+		if (timeout <= 0)
+			break;
+#ifndef WIN32
+		now = time(NULL);
+		if (now >= end) {
+			errno = EAGAIN;
+			return -1;
+		}
+		pfd.fd = sd;
+		pfd.events = POLLOUT;
+		pfd.revents = 0;
+		i = poll(&pfd, 1, (end - now) * 1000);
+		if (i == -1 && errno != EINTR)
+			return -1;
+#else
+		break;
+#endif
+	}
+
+	conn_update_poll_events(conn);
+
+	return rc;
+}
+
+/**
+ * @brief
+ *	conn_queued_len - amount of output queued on a connection
+ *
+ * @param[in]	sd - socket descriptor
+ *
+ * @return	size_t
+ */
+size_t
+conn_queued_len(int sd)
+{
+	conn_t *conn;
+
+	if ((conn = get_conn(sd)) == NULL)
+		return 0;
+
+	return conn->cn_outq_len - conn->cn_outq_off;
+}
+
 /**
  * @brief
  *	initialize the connection.
@@ -396,6 +662,12 @@ connection_idlecheck(void)
 		conn_t *cp = next_cp;
 		next_cp = GET_NEXT(cp->cn_link);
 
+		/* a closed connection whose client stopped reading its reply */
+		if (cp->cn_closing) {
+			if ((now - cp->cn_lasttime) > PBS_DIS_TCP_TIMEOUT_REPLY)
+				close_conn(cp->cn_sock);
+			continue;
+		}
 		if (cp->cn_active != FromClientDIS)
 			continue;
 		if ((now - cp->cn_lasttime) <= PBS_NET_MAXCONNECTIDLE)
@@ -472,19 +744,40 @@ engage_authentication(conn_t *pconn)
  *                    engages the appropriate connection authentication.
  *
  * @param[in]   sock 	- socket fd to process
+ * @param[in]   events	- events polled on the socket
  *
  * @retval	-1 for failure
  * @retval	0  for success
  *
  */
 static int
-process_socket(int sock)
+process_socket(int sock, int events)
 {
 	int idx = conn_find_actual_index(sock);
 	if (idx < 0) {
 		return -1;
 	}
 	svr_conn[idx]->cn_lasttime = time(NULL);
+
+	/* the socket is writable, keep draining queued output */
+	if (svr_conn[idx]->cn_outq_len > svr_conn[idx]->cn_outq_off) {
+		int rc = conn_flush_queued(sock, 0);
+
+		if (rc == -1) {
+			close_conn(sock);
+			return -1;
+		}
+		if (svr_conn[idx]->cn_closing) {
+			if (rc == 0)
+				close_conn(sock);
+			return 0;
+		}
+		/* only writable, or reading is held off until the client catches up */
+		if ((events & (EM_IN | EM_HUP | EM_ERR)) == 0 ||
+			!(svr_conn[idx]->cn_poll_events & EM_IN))
+			return 0;
+	}
+
 	if ((svr_conn[idx]->cn_active != Primary) &&
 		(svr_conn[idx]->cn_active != TppComm) &&
 		(svr_conn[idx]->cn_active != Secondary)) {
@@ -587,9 +880,11 @@ wait_request(float waittime, void *priority_context)
 #endif /* WIN32 */
                 	for (i = 0; i < pnfds; i++) {
                         	em_pfd = EM_GET_FD(pevents, i);
+				if (IS_STALE_OUT_EVENT(pevents, i, em_pfd))
+					continue;
 				log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SERVER,
                                         LOG_DEBUG, __func__, "processing priority socket");
-				if (process_socket(em_pfd) == -1) {
+				if (process_socket(em_pfd, EM_GET_EVENT(pevents, i)) == -1) {
                                 	log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER,
                                         	LOG_DEBUG, __func__, "process priority socket failed");
                         	} else {
@@ -617,6 +912,8 @@ wait_request(float waittime, void *priority_context)
 				}
 			}
 #endif
+			if (IS_STALE_OUT_EVENT(events, i, em_fd))
+				continue;
 			if (prio_sock_processed) {
 				int idx = conn_find_actual_index(em_fd);
 				if (idx < 0)
@@ -624,7 +921,7 @@ wait_request(float waittime, void *priority_context)
 				if (svr_conn[idx]->cn_prio_flag == 1)
 					continue;
 			}
-			if (process_socket(em_fd) == -1) {
+			if (process_socket(em_fd, EM_GET_EVENT(events, i)) == -1) {
 				log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER,
 					LOG_DEBUG, __func__, "process socket failed");
 			}
@@ -741,6 +1038,7 @@ add_conn(int sd, enum conn_type type, pbs_net_t addr, unsigned int port, int (*r
 	conn->cn_authen = 0;
 	conn->cn_prio_flag = 0;
 	conn->cn_auth_config = NULL;
+	conn->cn_poll_events = EM_IN | EM_HUP | EM_ERR;
 
 	num_connections++;
 
@@ -784,7 +1082,7 @@ set_conn_as_priority(conn_t *conn)
 	if (conn->cn_prio_flag == 1)
 		return 1;
 
-	if (tpp_em_add_fd(priority_context, conn->cn_sock, EM_IN | EM_HUP | EM_ERR) < 0) {
+	if (tpp_em_add_fd(priority_context, conn->cn_sock, conn->cn_poll_events) < 0) {
 		log_errf(errno, __func__, "could not add socket %d to the priority poll list", conn->cn_sock);
 		return 0;
 	}
@@ -884,6 +1182,23 @@ close_conn(int sd)
 	if (idx == -1)
 		return;
 
+	/*
+	 * A reply which is still queued is left for the poll loop to write out,
+	 * the socket is closed for real once it drains or in connection_idlecheck()
+	 * if the client does not read it.  A second close discards the output.
+	 */
+	if (!svr_conn[idx]->cn_closing && svr_conn[idx]->cn_active != ChildPipe &&
+		conn_flush_queued(sd, 0) == 1) {
+		dis_destroy_chan(sd);
+		if (svr_conn[idx]->cn_oncl != 0)
+			svr_conn[idx]->cn_oncl(sd);
+		svr_conn[idx]->cn_oncl = NULL;
+		svr_conn[idx]->cn_closing = 1;
+		svr_conn[idx]->cn_lasttime = time(NULL);
+		conn_update_poll_events(svr_conn[idx]);
+		return;
+	}
+
 	if (svr_conn[idx]->cn_active != ChildPipe) {
 		dis_destroy_chan(sd);
 	}
@@ -964,6 +1279,8 @@ cleanup_conn(int idx)
 		svr_conn[idx]->cn_auth_config = NULL;
 	}
 
+	free(svr_conn[idx]->cn_outq);
+
 	/* Free the connection memory */
 	free(svr_conn[idx]);
 	svr_conn[idx] = NULL;
@@ -1000,6 +1317,9 @@ net_close(int but)
 		cp = GET_NEXT(cp->cn_link);
 		if(sock != but) {
 			svr_conn[sock]->cn_oncl = NULL;
+			/* don't send output queued before a fork a second time */
+			svr_conn[sock]->cn_outq_len = 0;
+			svr_conn[sock]->cn_outq_off = 0;
 			close_conn(sock);
 			destroy_connection(sock);
 		}
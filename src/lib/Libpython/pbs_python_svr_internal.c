@@ -3608,6 +3608,12 @@ _pps_helper_get_job(job *pjob_o, const char *jobid, const char *qname, char *per
 		return py_job;
 	}
 
+	/* hooks see all of a history job, job_thaw() freezes it again later */
+	if (pjob->ji_frozen != NULL && job_thaw(pjob) != 0) {
+		log_err(PBSE_INTERNAL, __func__, "could not thaw history job");
+		return py_job;
+	}
+
 	/*
 	 * First things first create a Python queue  object.
 	 *  - Borrowed reference
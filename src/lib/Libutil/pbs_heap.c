@@ -0,0 +1,308 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+#include "pbs_heap.h"
+#include <stddef.h>
+#include <stdlib.h>
+
+#define PBS_HEAP_INIT_SIZE 64
+
+/* heap structure, opaque to application */
+typedef struct _pbs_heap {
+	pbs_heap_entry **entries;	/* array of entries, entries[0] is the top */
+	int count;			/* entries in use */
+	int size;			/* entries allocated */
+	unsigned long seq;		/* next insertion sequence number */
+} pbs_heap;
+
+/**
+ * @brief
+ *	compare two heap entries
+ *
+ * @return int
+ * @retval 1 - a comes out of the heap before b
+ * @retval 0 - otherwise
+ *
+ */
+static int
+heap_before(pbs_heap_entry *a, pbs_heap_entry *b)
+{
+	if (a->he_key != b->he_key)
+		return (a->he_key < b->he_key);
+	return (a->he_seq < b->he_seq);
+}
+
+/**
+ * @brief
+ *	put an entry at a position of the heap array
+ *
+ */
+static void
+heap_set(pbs_heap *h, int pos, pbs_heap_entry *entry)
+{
+	h->entries[pos] = entry;
+	entry->he_pos = pos;
+}
+
+/**
+ * @brief
+ *	move the entry at pos up towards the top until the heap is ordered
+ *
+ */
+static void
+heap_sift_up(pbs_heap *h, int pos)
+{
+	pbs_heap_entry *entry = h->entries[pos];
+	int parent;
+
+	while (pos > 0) {
+		parent = (pos - 1) / 2;
+		if (!heap_before(entry, h->entries[parent]))
+			break;
+		heap_set(h, pos, h->entries[parent]);
+		pos = parent;
+	}
+	heap_set(h, pos, entry);
+}
+
+/**
+ * @brief
+ *	move the entry at pos down away from the top until the heap is ordered
+ *
+ */
+static void
+heap_sift_down(pbs_heap *h, int pos)
+{
+	pbs_heap_entry *entry = h->entries[pos];
+	int child;
+
+	while ((child = 2 * pos + 1) < h->count) {
+		if (child + 1 < h->count && heap_before(h->entries[child + 1], h->entries[child]))
+			child++;
+		if (!heap_before(h->entries[child], entry))
+			break;
+		heap_set(h, pos, h->entries[child]);
+		pos = child;
+	}
+	heap_set(h, pos, entry);
+}
+
+/**
+ * @brief
+ *	Create an empty heap
+ *
+ * @return void *
+ * @retval !NULL - success
+ * @retval NULL  - failure
+ *
+ */
+void *
+pbs_heap_create(void)
+{
+	pbs_heap *h;
+
+	h = malloc(sizeof(pbs_heap));
+	if (h == NULL)
+		return NULL;
+
+	h->entries = malloc(PBS_HEAP_INIT_SIZE * sizeof(pbs_heap_entry *));
+	if (h->entries == NULL) {
+		free(h);
+		return NULL;
+	}
+	h->count = 0;
+	h->size = PBS_HEAP_INIT_SIZE;
+	h->seq = 0;
+
+	return h;
+}
+
+/**
+ * @brief
+ *	destroy heap, the objects in it are not touched
+ *
+ * @param[in] - heap - pointer to heap
+ *
+ * @return void
+ *
+ */
+void
+pbs_heap_destroy(void *heap)
+{
+	pbs_heap *h = heap;
+	int i;
+
+	if (h == NULL)
+		return;
+
+	for (i = 0; i < h->count; i++)
+		h->entries[i]->he_pos = -1;
+	free(h->entries);
+	free(h);
+}
+
+/**
+ * @brief
+ *	add an object to the heap, or re-key it if it is already there
+ *
+ * @param[in] - heap  - pointer to heap
+ * @param[in] - entry - heap entry embedded in the object
+ * @param[in] - key   - ordering key of the object
+ * @param[in] - data  - the object
+ *
+ * @return int
+ * @retval 0  - success
+ * @retval -1 - failure (no memory)
+ *
+ */
+int
+pbs_heap_insert(void *heap, pbs_heap_entry *entry, long key, void *data)
+{
+	pbs_heap *h = heap;
+	pbs_heap_entry **tmp;
+
+	if (h == NULL || entry == NULL)
+		return -1;
+
+	if (entry->he_pos >= 0) {
+		/* already in the heap, move it to where the new key puts it */
+		long oldkey = entry->he_key;
+
+		entry->he_key = key;
+		entry->he_data = data;
+		if (key < oldkey)
+			heap_sift_up(h, entry->he_pos);
+		else
+			heap_sift_down(h, entry->he_pos);
+		return 0;
+	}
+
+	if (h->count == h->size) {
+		tmp = realloc(h->entries, 2 * h->size * sizeof(pbs_heap_entry *));
+		if (tmp == NULL)
+			return -1;
+		h->entries = tmp;
+		h->size *= 2;
+	}
+
+	entry->he_key = key;
+	entry->he_seq = h->seq++;
+	entry->he_data = data;
+	heap_set(h, h->count, entry);
+	h->count++;
+	heap_sift_up(h, entry->he_pos);
+
+	return 0;
+}
+
+/**
+ * @brief
+ *	remove an object from the heap, no-op if it is not in it
+ *
+ * @param[in] - heap  - pointer to heap
+ * @param[in] - entry - heap entry embedded in the object
+ *
+ * @return void
+ *
+ */
+void
+pbs_heap_delete(void *heap, pbs_heap_entry *entry)
+{
+	pbs_heap *h = heap;
+	pbs_heap_entry *last;
+	int pos;
+
+	if (h == NULL || entry == NULL || entry->he_pos < 0)
+		return;
+
+	pos = entry->he_pos;
+	entry->he_pos = -1;
+	last = h->entries[--h->count];
+	if (last == entry)
+		return;
+
+	/* fill the hole with the last entry and restore the order */
+	heap_set(h, pos, last);
+	if (pos > 0 && heap_before(last, h->entries[(pos - 1) / 2]))
+		heap_sift_up(h, pos);
+	else
+		heap_sift_down(h, pos);
+}
+
+/**
+ * @brief
+ *	get the object with the smallest key, without removing it
+ *
+ * @param[in]  - heap - pointer to heap
+ * @param[out] - key  - if not NULL, set to the key of the object
+ *
+ * @return void *
+ * @retval !NULL - the object
+ * @retval NULL  - heap is empty
+ *
+ */
+void *
+pbs_heap_top(void *heap, long *key)
+{
+	pbs_heap *h = heap;
+
+	if (h == NULL || h->count == 0)
+		return NULL;
+
+	if (key != NULL)
+		*key = h->entries[0]->he_key;
+	return h->entries[0]->he_data;
+}
+
+/**
+ * @brief
+ *	number of objects in the heap
+ *
+ * @param[in] - heap - pointer to heap
+ *
+ * @return int
+ *
+ */
+int
+pbs_heap_count(void *heap)
+{
+	pbs_heap *h = heap;
+
+	return (h == NULL ? 0 : h->count);
+}
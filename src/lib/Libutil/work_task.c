@@ -52,6 +52,8 @@
 #include <sys/wait.h>
 #include "server_limits.h"
 #include "list_link.h"
+#include "pbs_idx.h"
+#include "pbs_heap.h"
 #include "work_task.h"
 
 
@@ -63,6 +65,151 @@ extern pbs_list_head task_list_event; /* list of tasks responding to an event */
 extern int svr_delay_entry;
 extern time_t	time_now;
 
+/*
+ * The tasks on task_list_timed are kept in task_heap_timed ordered by
+ * start time, the list itself is in no particular order.  Every task with
+ * a wt_parm1 is on the task list of that parm1 in task_parm1_idx.
+ */
+static void *task_heap_timed = NULL;
+static void *task_parm1_idx = NULL;
+
+struct task_parm1 {
+	void *tp_parm1;		/* the wt_parm1, the index key */
+	pbs_list_head tp_tasks;	/* tasks with this parm1, via wt_linkparm */
+};
+
+/**
+ * @brief
+ *	Find the list of tasks with a given wt_parm1
+ *
+ * @param[in]	parm1	- parameter to look up
+ *
+ * @return struct task_parm1 *
+ * @retval	!NULL	- the tasks of parm1
+ * @retval	NULL	- no task has parm1
+ */
+static struct task_parm1 *
+find_task_parm1(void *parm1)
+{
+	struct task_parm1 *ptp = NULL;
+	void *pkey = &parm1;
+
+	if (task_parm1_idx == NULL || parm1 == NULL)
+		return NULL;
+	if (pbs_idx_find(task_parm1_idx, &pkey, (void **)&ptp, NULL) != PBS_IDX_RET_OK)
+		return NULL;
+	return ptp;
+}
+
+/**
+ * @brief
+ *	Add a task to the list of tasks with the same wt_parm1
+ *
+ * @param[in]	ptask	- task just created
+ *
+ * @return int
+ * @retval	0	- success
+ * @retval	-1	- no memory
+ */
+static int
+link_task_parm1(struct work_task *ptask)
+{
+	struct task_parm1 *ptp;
+
+	if (ptask->wt_parm1 == NULL)
+		return 0;
+
+	if (task_parm1_idx == NULL) {
+		if ((task_parm1_idx = pbs_idx_create(0, sizeof(void *))) == NULL)
+			return -1;
+	}
+	if ((ptp = find_task_parm1(ptask->wt_parm1)) == NULL) {
+		if ((ptp = malloc(sizeof(struct task_parm1))) == NULL)
+			return -1;
+		ptp->tp_parm1 = ptask->wt_parm1;
+		CLEAR_HEAD(ptp->tp_tasks);
+		if (pbs_idx_insert(task_parm1_idx, &ptp->tp_parm1, ptp) != PBS_IDX_RET_OK) {
+			free(ptp);
+			return -1;
+		}
+	}
+	append_link(&ptp->tp_tasks, &ptask->wt_linkparm, ptask);
+	return 0;
+}
+
+/**
+ * @brief
+ *	Remove a task from the list of tasks with the same wt_parm1,
+ *	freeing the list when it becomes empty
+ *
+ * @param[in]	ptask	- task being unlinked
+ */
+static void
+unlink_task_parm1(struct work_task *ptask)
+{
+	struct task_parm1 *ptp;
+
+	if (ptask->wt_linkparm.ll_next == &ptask->wt_linkparm)
+		return;
+	delete_link(&ptask->wt_linkparm);
+
+	if ((ptp = find_task_parm1(ptask->wt_parm1)) == NULL)
+		return;
+	if (GET_NEXT(ptp->tp_tasks) == NULL) {
+		pbs_idx_delete(task_parm1_idx, &ptp->tp_parm1);
+		free(ptp);
+	}
+}
+
+/**
+ * @brief
+ *	Take a task off its event list and, if it is a timed task, off the
+ *	timed task heap
+ *
+ * @param[in]	ptask	- task being moved or removed
+ */
+static void
+unlink_task_event(struct work_task *ptask)
+{
+	delete_link(&ptask->wt_linkevent);
+	pbs_heap_delete(task_heap_timed, &ptask->wt_heap);
+}
+
+/**
+ * @brief
+ *	Put a task on the event list for its type; timed tasks also go
+ *	into the timed task heap, keyed by their start time
+ *
+ * @param[in]	ptask	- task being added
+ * @param[in]	type	- work task type deciding the list
+ *
+ * @return int
+ * @retval	0	- success
+ * @retval	-1	- no memory
+ */
+static int
+link_task_event(struct work_task *ptask, enum work_type type)
+{
+	ptask->wt_list_type = type;
+	switch (type) {
+	case WORK_Immed:
+		append_link(&task_list_immed, &ptask->wt_linkevent, ptask);
+		break;
+	case WORK_Timed:
+		if (task_heap_timed == NULL) {
+			if ((task_heap_timed = pbs_heap_create()) == NULL)
+				return -1;
+		}
+		if (pbs_heap_insert(task_heap_timed, &ptask->wt_heap, ptask->wt_event, ptask) != 0)
+			return -1;
+		append_link(&task_list_timed, &ptask->wt_linkevent, ptask);
+		break;
+	default:
+		append_link(&task_list_event, &ptask->wt_linkevent, ptask);
+	}
+	return 0;
+}
+
 /**
  *
  * @brief
@@ -84,7 +231,6 @@ extern time_t	time_now;
 struct work_task *set_task(enum work_type type, long event_id, void (*func)(struct work_task *) , void *parm)
 {
 	struct work_task *pnew;
-	struct work_task *pold;
 
 	pnew = (struct work_task *)malloc(sizeof(struct work_task));
 	if (pnew == NULL)
@@ -92,6 +238,8 @@ struct work_task *set_task(enum work_type type, long event_id, void (*func)(stru
 	CLEAR_LINK(pnew->wt_linkevent);
 	CLEAR_LINK(pnew->wt_linkobj);
 	CLEAR_LINK(pnew->wt_linkobj2);
+	CLEAR_LINK(pnew->wt_linkparm);
+	CLEAR_HEAP_ENTRY(pnew->wt_heap);
 	pnew->wt_event = event_id;
 	pnew->wt_event2 = NULL;
 	pnew->wt_type  = type;
@@ -102,22 +250,15 @@ struct work_task *set_task(enum work_type type, long event_id, void (*func)(stru
 	pnew->wt_aux   = 0;
 	pnew->wt_aux2  = 0;
 
-	if (type == WORK_Immed)
-		append_link(&task_list_immed, &pnew->wt_linkevent, pnew);
-	else if (type == WORK_Timed) {
-		pold = (struct work_task *)GET_NEXT(task_list_timed);
-		while (pold) {
-			if (pold->wt_event > pnew->wt_event)
-				break;
-			pold = (struct work_task *)GET_NEXT(pold->wt_linkevent);
-		}
-		if (pold)
-			insert_link(&pold->wt_linkevent, &pnew->wt_linkevent, pnew,
-				LINK_INSET_BEFORE);
-		else
-			append_link(&task_list_timed, &pnew->wt_linkevent, pnew);
-	} else
-		append_link(&task_list_event, &pnew->wt_linkevent, pnew);
+	if (link_task_event(pnew, type) != 0) {
+		free(pnew);
+		return NULL;
+	}
+	if (link_task_parm1(pnew) != 0) {
+		unlink_task_event(pnew);
+		free(pnew);
+		return NULL;
+	}
 	return (pnew);
 }
 
@@ -136,26 +277,11 @@ struct work_task *set_task(enum work_type type, long event_id, void (*func)(stru
 int
 convert_work_task(struct work_task *ptask, enum work_type wtype)
 {
-	pbs_list_head *list;
-
 	if (!ptask)
 		return -1;
 
-	switch (wtype) {
-	case WORK_Immed:
-		list = &task_list_immed;
-		break;
-	case WORK_Timed:
-		list = &task_list_timed;
-		break;
-	default:
-		list = &task_list_event;
-	}
-
-	delete_link(&ptask->wt_linkevent);
-	append_link(list, &ptask->wt_linkevent, ptask);
-
-	return 0;
+	unlink_task_event(ptask);
+	return (link_task_event(ptask, wtype));
 }
 
 /**
@@ -174,7 +300,8 @@ convert_work_task(struct work_task *ptask, enum work_type wtype)
 void
 dispatch_task(struct work_task *ptask)
 {
-	delete_link(&ptask->wt_linkevent);
+	unlink_task_event(ptask);
+	unlink_task_parm1(ptask);
 	delete_link(&ptask->wt_linkobj);
 	delete_link(&ptask->wt_linkobj2);
 	if (ptask->wt_func)
@@ -195,10 +322,33 @@ delete_task(struct work_task *ptask)
 {
 	delete_link(&ptask->wt_linkobj);
 	delete_link(&ptask->wt_linkobj2);
-	delete_link(&ptask->wt_linkevent);
+	unlink_task_event(ptask);
+	unlink_task_parm1(ptask);
 	(void)free(ptask);
 }
 
+/**
+ * @brief
+ *	Return the task list a task is on, which is decided by the type it
+ *	was set or last converted to, not by its current wt_type
+ *
+ * @param[in]	ptask	- task
+ *
+ * @return pbs_list_head *
+ */
+static pbs_list_head *
+task_event_list(struct work_task *ptask)
+{
+	switch (ptask->wt_list_type) {
+	case WORK_Immed:
+		return &task_list_immed;
+	case WORK_Timed:
+		return &task_list_timed;
+	default:
+		return &task_list_event;
+	}
+}
+
 /**
  * @brief
  *	Check if some task in the specified task list
@@ -212,14 +362,31 @@ delete_task(struct work_task *ptask)
  * @return work task
  * @retval	!NULL if 'parm1' and 'func' was matched
  * @retval	NULL otherwise
+ *
+ * @par
+ *	When 'parm1' is given only the tasks of 'parm1' are looked at.
  */
 static struct work_task *
-find_worktask_by_parm_func(pbs_list_head task_list, void *parm1, void *func)
+find_worktask_by_parm_func(pbs_list_head *task_list, void *parm1, void *func)
 {
 	struct work_task *ptask;
 	struct work_task *ptask_next;
+	struct task_parm1 *ptp;
 
-	for (ptask = GET_NEXT(task_list); ptask; ptask = ptask_next) {
+	if (parm1) {
+		if ((ptp = find_task_parm1(parm1)) == NULL)
+			return NULL;
+		for (ptask = GET_NEXT(ptp->tp_tasks); ptask; ptask = GET_NEXT(ptask->wt_linkparm)) {
+			if (task_event_list(ptask) != task_list)
+				continue;
+			if (func && (ptask->wt_func != func))
+				continue;
+			return ptask;
+		}
+		return NULL;
+	}
+
+	for (ptask = GET_NEXT(*task_list); ptask; ptask = ptask_next) {
 		ptask_next = GET_NEXT(ptask->wt_linkevent);
 
 		if (parm1 && (ptask->wt_parm1 != parm1))
@@ -254,19 +421,19 @@ find_work_task(enum work_type wtype, void *parm1, void *func)
 	struct work_task  *ptask;
 
 	if (wtype == -1 || wtype == WORK_Immed) {
-		ptask = find_worktask_by_parm_func(task_list_immed, parm1, func);
+		ptask = find_worktask_by_parm_func(&task_list_immed, parm1, func);
 		if (ptask)
 			return ptask;
 	}
 
 	if (wtype == -1 || wtype == WORK_Timed) {
-		ptask = find_worktask_by_parm_func(task_list_timed, parm1, func);
+		ptask = find_worktask_by_parm_func(&task_list_timed, parm1, func);
 		if (ptask)
 			return ptask;
 	}
 
 	if (wtype == -1 || (wtype != WORK_Timed && wtype != WORK_Immed)) {
-		ptask = find_worktask_by_parm_func(task_list_event, parm1, func);
+		ptask = find_worktask_by_parm_func(&task_list_event, parm1, func);
 		if (ptask)
 			return ptask;
 	}
@@ -295,12 +462,35 @@ delete_task_by_parm1_func(void *parm1, void (*func)(struct work_task *), enum wt
 {
 	struct work_task  *ptask;
 	struct work_task  *ptask_next;
+	struct task_parm1 *ptp;
 	pbs_list_head task_lists[] = {task_list_event, task_list_timed, task_list_immed};
+	pbs_list_head *plists[] = {&task_list_event, &task_list_timed, &task_list_immed};
 	int i;
 
 	if (parm1 == NULL && func == NULL)
 		return;
 
+	if (parm1 != NULL) {
+		/* only the tasks of parm1 need to be looked at */
+		for (i = 0; i < 3; i++) {
+			if ((ptp = find_task_parm1(parm1)) == NULL)
+				return;
+			for (ptask = GET_NEXT(ptp->tp_tasks); ptask; ptask = ptask_next) {
+				ptask_next = GET_NEXT(ptask->wt_linkparm);
+
+				if (task_event_list(ptask) != plists[i])
+					continue;
+				if ((func != NULL) && (ptask->wt_func != func))
+					continue;
+
+				delete_task(ptask);
+				if (option == DELETE_ONE)
+					return;
+			}
+		}
+		return;
+	}
+
 	for (i = 0; i < 3; i++) {
 		for (ptask = (struct work_task *) GET_NEXT(task_lists[i]); ptask; ptask = ptask_next) {
 			ptask_next = (struct work_task *) GET_NEXT(ptask->wt_linkevent);
@@ -348,7 +538,7 @@ has_task_by_parm1(void *parm1)
  *	1. If svr_delay_entry is set, then a delayed task in the
  *	   task_list_event is ready so find and process it.
  *	2. All items on the immediate list, then
- *	3. All items on the timed task list which have expired times
+ *	3. All items on the timed task heap which have expired times
  *
  * @return time_t
  * @retval The amount of time till next task
@@ -358,6 +548,7 @@ time_t
 default_next_task(void)
 {
 	time_t		   delay;
+	long		   when;
 	struct work_task  *nxt;
 	struct work_task  *ptask;
 	/*
@@ -385,11 +576,14 @@ default_next_task(void)
 	while ((ptask=(struct work_task *)GET_NEXT(task_list_immed)) != NULL)
 		dispatch_task(ptask);
 
-	while ((ptask=(struct work_task *)GET_NEXT(task_list_timed))!=NULL) {
-		if ((delay = ptask->wt_event - time_now) > 0) {
+	while ((ptask = (struct work_task *)pbs_heap_top(task_heap_timed, &when)) != NULL) {
+		if ((delay = when - time_now) > 0) {
 			if (tilwhen > delay)
 				tilwhen = delay;
 			break;
+		} else if (ptask->wt_event > when) {
+			/* start time was moved later, re-key it */
+			(void)pbs_heap_insert(task_heap_timed, &ptask->wt_heap, ptask->wt_event, ptask);
 		} else {
 			dispatch_task(ptask);	/* will delete link */
 		}
@@ -5277,6 +5277,7 @@ alps_create_reserve_request(job *pjob, basil_request_reserve_t **req)
 	vmpiprocs	*vp;
 	size_t		len = 0;
 	size_t		nsize = 0;
+	char		*savep;
 	char		*cp;
 	long		pstate = 0;
 	char		*pgov = NULL;
@@ -5357,8 +5358,8 @@ alps_create_reserve_request(job *pjob, basil_request_reserve_t **req)
 		 * Check string array to be sure CRAY_COMPUTE is
 		 * one of the values.
 		 */
-		for (vnt = parse_comma_string(vntype); vnt != NULL;
-			vnt = parse_comma_string(NULL)) {
+		for (vnt = parse_comma_string(vntype, &savep); vnt != NULL;
+			vnt = parse_comma_string(NULL, &savep)) {
 			if (strcmp(vnt, CRAY_COMPUTE) == 0)
 				break;
 			sprintf(log_buffer, "vnode %s has vntype %s",
@@ -696,6 +696,8 @@ is_request(int stream, int version)
 			DBPRT(("%s: IS_REPLYHELLO, state=0x%x stream=%d\n", __func__,
 				internal_state, stream))
 			time_delta_hellosvr(MOM_DELTA_RESET);
+			/* server may have restarted, next updates carry full usage */
+			reset_update_baselines();
 			need_inv = disrsi(stream, &ret);
 			if (ret != DIS_SUCCESS)
 				goto err;
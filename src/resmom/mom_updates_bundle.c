@@ -62,6 +62,8 @@ static ruu *get_job_update(job *pjob);
 static PyObject *json_loads(char *value, char *msg, size_t msg_len);
 static char *json_dumps(PyObject *py_val, char *msg, size_t msg_len);
 static void encode_used(job *pjob, pbs_list_head *phead);
+static void strip_unchanged_used(job *pjob, ruu *prused);
+static void record_sent_used(ruu *rud);
 
 static PyObject *py_json_name = NULL;
 static PyObject *py_json_module = NULL;
@@ -69,6 +71,13 @@ static PyObject *py_json_dict = NULL;
 static PyObject *py_json_func_loads = NULL;
 static PyObject *py_json_func_dumps = NULL;
 
+/*
+ * Bumped whenever the server may have lost what was last sent to it (new
+ * server connection or a send error); a job's ji_ruu_sent is only trusted
+ * while its ji_ruu_gen matches.
+ */
+static int ruu_baseline_gen = 1;
+
 #ifdef PYTHON
 /**
  * @brief
@@ -769,6 +778,154 @@ get_job_update(job *pjob)
 	return prused;
 }
 
+/**
+ * @brief
+ * 	is_delta_attr - check whether an update entry is sent to the server
+ * 	only when its value differs from the one last sent
+ *
+ * @param[in] pal - update entry
+ *
+ * @return int
+ * @retval 1 - delta encoded
+ * @retval 0 - always sent
+ */
+static int
+is_delta_attr(svrattrl *pal)
+{
+	return ((strcmp(pal->al_name, ATTR_used) == 0) ||
+		(strcmp(pal->al_name, ATTR_used_update) == 0) ||
+		(strcmp(pal->al_name, ATTR_session) == 0));
+}
+
+/**
+ * @brief
+ * 	find_sent_used - find the entry with the same attribute and resource
+ * 	name in a job's last sent values
+ *
+ * @param[in] pjob - pointer to job
+ * @param[in] pal  - update entry to match
+ *
+ * @return svrattrl *
+ * @retval !NULL - matching entry
+ * @retval NULL  - not sent before
+ */
+static svrattrl *
+find_sent_used(job *pjob, svrattrl *pal)
+{
+	svrattrl *psent;
+
+	for (psent = (svrattrl *)GET_NEXT(pjob->ji_ruu_sent); psent != NULL;
+	     psent = (svrattrl *)GET_NEXT(psent->al_link)) {
+		if (strcmp(psent->al_name, pal->al_name) != 0)
+			continue;
+		if ((psent->al_resc == NULL) != (pal->al_resc == NULL))
+			continue;
+		if (pal->al_resc == NULL || strcmp(psent->al_resc, pal->al_resc) == 0)
+			return psent;
+	}
+	return NULL;
+}
+
+/**
+ * @brief
+ * 	strip_unchanged_used - remove from an update the resources_used and
+ * 	session id entries whose value is the one the server already has
+ *
+ * @param[in] pjob    - pointer to job
+ * @param[in,out] prused - update to strip
+ *
+ * @return void
+ */
+static void
+strip_unchanged_used(job *pjob, ruu *prused)
+{
+	svrattrl *pal;
+	svrattrl *next;
+	svrattrl *psent;
+
+	if (pjob->ji_ruu_gen != ruu_baseline_gen) {
+		free_attrlist(&pjob->ji_ruu_sent);
+		CLEAR_HEAD(pjob->ji_ruu_sent);
+		pjob->ji_ruu_gen = ruu_baseline_gen;
+		return;
+	}
+
+	for (pal = (svrattrl *)GET_NEXT(prused->ru_attr); pal != NULL; pal = next) {
+		next = (svrattrl *)GET_NEXT(pal->al_link);
+		if (!is_delta_attr(pal) || (psent = find_sent_used(pjob, pal)) == NULL)
+			continue;
+		if ((psent->al_valln == pal->al_valln) && (psent->al_flags == pal->al_flags) &&
+		    (pal->al_valln == 0 || strcmp(psent->al_value, pal->al_value) == 0)) {
+			delete_link(&pal->al_link);
+			free(pal);
+		}
+	}
+}
+
+/**
+ * @brief
+ * 	record_sent_used - remember the delta encoded values of updates which
+ * 	were handed to the server, later updates of the same jobs are sent
+ * 	relative to them
+ *
+ * @param[in] rud - chain of updates sent
+ *
+ * @return void
+ */
+static void
+record_sent_used(ruu *rud)
+{
+	job *pjob;
+	svrattrl *pal;
+	svrattrl *psent;
+	svrattrl *pnew;
+
+	for (; rud != NULL; rud = rud->ru_next) {
+		pjob = rud->ru_pjob;
+		if (pjob == NULL || rud->ru_cmd == IS_JOBOBIT)
+			continue;
+		if (pjob->ji_ruu_gen != ruu_baseline_gen) {
+			free_attrlist(&pjob->ji_ruu_sent);
+			CLEAR_HEAD(pjob->ji_ruu_sent);
+			pjob->ji_ruu_gen = ruu_baseline_gen;
+		}
+		for (pal = (svrattrl *)GET_NEXT(rud->ru_attr); pal != NULL;
+		     pal = (svrattrl *)GET_NEXT(pal->al_link)) {
+			if (!is_delta_attr(pal))
+				continue;
+			pnew = attrlist_create(pal->al_name, pal->al_resc, pal->al_valln);
+			if (pnew == NULL) {
+				/* cannot track it, send everything next time */
+				free_attrlist(&pjob->ji_ruu_sent);
+				CLEAR_HEAD(pjob->ji_ruu_sent);
+				pjob->ji_ruu_gen = 0;
+				break;
+			}
+			if (pal->al_valln > 0)
+				memcpy(pnew->al_value, pal->al_value, pal->al_valln);
+			pnew->al_flags = pal->al_flags;
+			if ((psent = find_sent_used(pjob, pal)) != NULL) {
+				delete_link(&psent->al_link);
+				free(psent);
+			}
+			append_link(&pjob->ji_ruu_sent, &pnew->al_link, pnew);
+		}
+	}
+}
+
+/**
+ * @brief
+ * 	reset_update_baselines - forget what was sent to the server, the next
+ * 	update of every job carries all of its resources_used values
+ *
+ * @return void
+ */
+void
+reset_update_baselines(void)
+{
+	ruu_baseline_gen++;
+}
+
 /**
  * @brief
  * 	generate resc used update for given job and put it in queue
@@ -797,6 +954,21 @@ enqueue_update_for_send(job *pjob, int cmd)
 		return 0;
 	}
 
+	if (cmd == IS_RESCUSED) {
+		/* send only what changed since the last update the server got */
+		strip_unchanged_used(pjob, prused);
+		if (GET_NEXT(prused->ru_attr) == NULL && prused->ru_comment == NULL) {
+			/* server is up to date, any pending update is stale */
+			if (pjob->ji_pending_ruu != NULL) {
+				ruu *x = (ruu *)(pjob->ji_pending_ruu);
+				if (x->ru_cmd == IS_RESCUSED)
+					FREE_RUU(x);
+			}
+			FREE_RUU(prused);
+			return 0;
+		}
+	}
+
 	if (pjob->ji_pending_ruu != NULL) {
 		ruu *x = (ruu *)(pjob->ji_pending_ruu);
 		FREE_RUU(x);
@@ -890,6 +1062,7 @@ void
 send_resc_used(int cmd, int count, ruu *rud)
 {
 	int ret;
+	ruu *head = rud;
 
 	if (count == 0 || rud == NULL || server_stream < 0)
 		return;
@@ -940,6 +1113,7 @@ send_resc_used(int cmd, int count, ruu *rud)
 	if (dis_flush(server_stream) != 0)
 		goto err;
 
+	record_sent_used(head);
 	return;
 
 err:
@@ -949,6 +1123,8 @@ err:
 #endif
 		log_err(errno, "send_resc_used", log_buffer);
 
+	/* the server may not have all of it, resend full values */
+	reset_update_baselines();
 	if (cmd != IS_RESCUSED_FROM_HOOK) {
 		tpp_close(server_stream);
 		server_stream = -1;
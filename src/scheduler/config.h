@@ -61,9 +61,17 @@
 
 /* usage file "magic number" - needs to be 8 chars */
 #define USAGE_MAGIC "PBS_MAG!"
-#define USAGE_VERSION 2
+#define USAGE_VERSION 3
 #define USAGE_NAME_MAX 50
 
+/* usage file journal for in place updates - magic needs to be 8 chars */
+#define USAGE_JOURNAL_SUFFIX ".journal"
+#define USAGE_JOURNAL_MAGIC "PBS_JRN!"
+
+/* minimum room for entries in a usage file and the expected name length */
+#define USAGE_MIN_ENTRIES 64
+#define USAGE_AVG_NAME_LEN 16
+
 #define UNKNOWN_GROUP_NAME "unknown"
 
 /* preempt priority values */
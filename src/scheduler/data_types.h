@@ -101,6 +101,7 @@ struct bucket_bitpool;
 struct chunk_map;
 struct node_bucket_count;
 struct preempt_job_st;
+struct preempt_index;
 
 
 typedef struct state_count state_count;
@@ -137,6 +138,7 @@ typedef struct bucket_bitpool bucket_bitpool;
 typedef struct chunk_map chunk_map;
 typedef struct node_bucket_count node_bucket_count;
 typedef struct preempt_job_st preempt_job_st;
+typedef struct preempt_index preempt_index;
 typedef struct th_task_info th_task_info;
 typedef struct th_data_nd_eligible th_data_nd_eligible;
 typedef struct th_data_dup_nd_info th_data_dup_nd_info;
@@ -680,18 +682,37 @@ struct node_info
 	unsigned is_sleeping:1;		/* node put to sleep through power on/off or ramp rate limit */
 	unsigned has_ghost_job:1;	/* race condition occurred: recalculate resources_assigned */
 
+	/* The fields below are laid out so the ones read while searching nodes
+	 * for a job share the first cache lines of the struct.  Fields which are
+	 * mostly used while querying, logging, or freeing are at the end.
+	 *
+	 * They are not moved out into arrays owned by server_info: a node is
+	 * reached through node_info pointers held by queues, placement sets,
+	 * hostsets, buckets and reservations, reservation nodes are copies
+	 * outside the server's node array, and every simulated server dups
+	 * its nodes one by one (dup_node()).  Per-node resources are a list
+	 * (res), so the bulk of what a node search reads would stay behind a
+	 * pointer anyway.
+	 */
+
 	/* sharing */
 	enum vnode_sharing sharing;	/* deflt or forced sharing/excl of the node */
+	unsigned int nscr;		/* scratch space local to node search code */
 
-	char *name;			/* name of the node */
-	char *mom;			/* host name on which mom resides */
+	int rank;			/* unique numeric identifier for node */
+	int node_ind;			/* node's index into sinfo->unordered_nodes */
+	int bucket_ind;			/* index in server's bucket array */
+	int nodesig_ind;		/* resource signature index in server array */
+	int priority;			/* node priority */
 
-	char **jobs;			/* the name of the jobs currently on the node */
-	char **resvs;			/* the name of the reservations currently on the node */
-	resource_resv **job_arr;	/* ptrs to structs of the jobs on the node */
-	resource_resv **run_resvs_arr;	/* ptrs to structs of resvs holding resources on the node */
+	int num_jobs;			/* number of jobs running on the node */
+	int num_run_resv;		/* number of running advanced reservations */
 
-	int pcpus;			/* the number of physical cpus */
+	int max_running;		/* max number of jobs on the node */
+	int max_user_run;		/* max number of jobs running by a user */
+	int max_group_run;		/* max number of jobs running by a UNIX group */
+
+	schd_resource *res;		/* list of resources max/current usage */
 
 	/* This element is the server the node is associated with.  In the case
 	 * of a node which is part of an advanced reservation, the nodes are
@@ -700,24 +721,29 @@ struct node_info
 	 * nodes do.  This means ninfo is not part of ninfo -> server -> nodes.
 	 */
 	server_info *server;
-	char *queue_name;		/* the queue the node is associated with */
-
-	int num_jobs;			/* number of jobs running on the node */
-	int num_run_resv;		/* number of running advanced reservations */
-	int num_susp_jobs;		/* number of suspended jobs on the node */
-
-	int priority;			/* node priority */
+	node_info *svr_node;		/* ptr to svr's node if we're a resv node */
+	node_partition *hostset;	/* other vnodes on on the same host */
+	te_list *node_events;		/* list of run events that affect the node */
 
 	counts *group_counts;		/* group resource and running counts */
 	counts *user_counts;		/* user resource and running counts */
 
-	int max_running;		/* max number of jobs on the node */
-	int max_user_run;		/* max number of jobs running by a user */
-	int max_group_run;		/* max number of jobs running by a UNIX group */
+	char *current_aoe;		/* AOE name instantiated on node */
+	char *current_eoe;		/* EOE name instantiated on node */
 
-	schd_resource *res;		/* list of resources max/current usage */
+	resource_resv **job_arr;	/* ptrs to structs of the jobs on the node */
+	resource_resv **run_resvs_arr;	/* ptrs to structs of resvs holding resources on the node */
 
-	int rank;			/* unique numeric identifier for node */
+	char *name;			/* name of the node */
+	char *mom;			/* host name on which mom resides */
+
+	char **jobs;			/* the name of the jobs currently on the node */
+	char **resvs;			/* the name of the reservations currently on the node */
+
+	int pcpus;			/* the number of physical cpus */
+	int num_susp_jobs;		/* number of suspended jobs on the node */
+
+	char *queue_name;		/* the queue the node is associated with */
 
 #ifdef NAS
 	/* localmod 034 */
@@ -725,19 +751,10 @@ struct node_info
 	int	sh_type;		/* Share type of node */
 #endif
 
-	char *current_aoe;		/* AOE name instantiated on node */
-	char *current_eoe;		/* EOE name instantiated on node */
 	char *nodesig;			/* resource signature */
-	int nodesig_ind;		/* resource signature index in server array */
-	node_info *svr_node;		/* ptr to svr's node if we're a resv node */
-	node_partition *hostset;	/* other vnodes on on the same host */
-	unsigned int nscr;		/* scratch space local to node search code */
 	char *partition;		/* partition to which node belongs to */
 	time_t last_state_change_time;	/* Node state change at time stamp */
 	time_t last_used_time;		/* Node was last active at this time */
-	te_list *node_events;		/* list of run events that affect the node */
-	int bucket_ind;			/* index in server's bucket array */
-	int node_ind;			/* node's index into sinfo->unordered_nodes */
 	node_partition **np_arr;	/* array of node partitions node is in */
 	char *svr_inst_id;
 };
@@ -787,15 +804,18 @@ struct resource_resv
 
 	unsigned will_use_multinode:1;	/* res resv will use multiple nodes */
 
-	char *name;			/* name of res resv */
-	char *user;			/* username of the owner of the res resv */
-	char *group;			/* exec group of owner of res resv */
-	char *project;			/* exec project of owner of res resv */
-	char *nodepart_name;		/* name of node partition to run res resv in */
+	/* Fields read while sorting and placing jobs come first so they share
+	 * the first cache lines of the struct.  Names and strings which are
+	 * mostly used for logging and limits are at the end.
+	 */
+	server_info *server;		/* pointer to server which owns res resv */
+	job_info *job;			/* pointer to job specific structure */
+	resv_info *resv;		/* pointer to reservation specific structure */
 
 	long sch_priority;		/* scheduler priority of res resv */
 	int rank;			/* unique numeric identifier for resource_resv */
 	int ec_index;			/* Index into server's job_set array*/
+	int resresv_ind;		   /* resource_resv index in all_resresv array */
 
 	time_t qtime;			/* time res resv was submitted */
 	long qrank;			/* time on which we might need to stabilize the sort */
@@ -810,23 +830,26 @@ struct resource_resv
 	selspec *execselect;		/* select spec from exec_vnode and resv_nodes */
 	place *place_spec;		/* placement spec */
 
-	server_info *server;		/* pointer to server which owns res resv */
 	node_info **ninfo_arr; 		/* nodes belonging to res resv */
 	nspec **nspec_arr;		/* exec vnode of object in internal sched form (one nspec per node) */
 
-	job_info *job;			/* pointer to job specific structure */
-	resv_info *resv;		/* pointer to reservation specific structure */
+	timed_event *run_event;		   /* run event in calendar */
+	timed_event *end_event;		   /* end event in calendar */
 
 	char *aoename;			   /* store name of aoe if requested */
 	char *eoename;			   /* store name of eoe if requested */
+
+	char *name;			/* name of res resv */
+	char *user;			/* username of the owner of the res resv */
+	char *group;			/* exec group of owner of res resv */
+	char *project;			/* exec project of owner of res resv */
+	char *nodepart_name;		/* name of node partition to run res resv in */
+
 	char **node_set_str;		   /* user specified node string */
 	node_info **node_set;		   /* node array specified by node_set_str */
 #ifdef NAS				   /* localmod 034 */
 	enum site_j_share_type share_type; /* How resv counts against group share */
 #endif					   /* localmod 034 */
-	int resresv_ind;		   /* resource_resv index in all_resresv array */
-	timed_event *run_event;		   /* run event in calendar */
-	timed_event *end_event;		   /* end event in calendar */
 };
 
 struct resource_type
@@ -910,11 +933,34 @@ struct resource_count
 
 /* global data types */
 
+/* what we know of the usage file a fairshare tree was last synced with */
+struct usage_file_state
+{
+	long long file_id;		/* file_id of the file (0 if none) */
+	int num_entries;
+	int entry_cap;
+	int strtab_len;
+	int strtab_cap;
+	time_t last_decay;		/* last_decay in the file */
+};
+
 /* fairshare head structure */
 struct fairshare_head
 {
 	group_info *root;			/* root of fairshare tree */
 	time_t last_decay;			/* last time tree was decayed */
+	void *ginfo_idx;			/* index of group_info's by name */
+
+	/* Decaying the tree and resetting temp_usage are done lazily.  These
+	 * count how many times each was requested for the whole tree.  A
+	 * group_info catches up the next time it is settled (settle_usage())
+	 */
+	int decay_count;			/* number of times the tree was decayed */
+	int temp_gen;				/* number of times temp_usage was reset */
+	int temp_decay_count;			/* decay_count at the last temp_usage reset */
+	int usage_gen;				/* number of times usage_factor was invalidated */
+
+	struct usage_file_state ufile;		/* usage file the tree was last synced with */
 };
 
 /* a path from the root to a group_info in the tree */
@@ -948,6 +994,14 @@ struct group_info
 	group_info *parent;			/* parent node */
 	group_info *sibling;			/* sibling node */
 	group_info *child;			/* child node */
+
+	fairshare_head *fhead;			/* head of the tree the group is in */
+	int decay_count;			/* fhead->decay_count when usage was last settled */
+	int temp_gen;				/* fhead->temp_gen when temp_usage was last reset */
+	int usage_gen;				/* fhead->usage_gen when usage_factor was calculated */
+
+	int usage_slot;				/* index of entity in the usage file (-1 if none) */
+	usage_t written_usage;			/* usage last written to the usage file */
 };
 
 /**
@@ -1026,6 +1080,55 @@ struct group_node_usage_v2
 	usage_t usage;
 };
 
+/* Usage file version 3 is laid out so it can be mapped into memory and have
+ * individual entries updated in place:
+ *	usage_header_v3
+ *	usage_entry_v3[entry_cap]
+ *	string table[strtab_cap]
+ * Room is left at the end of the entry array and string table so new
+ * entities can be added without rewriting the file.  file_id changes every
+ * time the whole file is rewritten so a writer can tell if the file it knows
+ * the layout of has been replaced (e.g., by pbsfs).
+ */
+struct usage_header_v3
+{
+	struct group_node_header head;	/* same as the older versions */
+	time_t last_decay;		/* last time the tree was decayed */
+	long long file_id;		/* identifies the full write of the file */
+	int num_entries;		/* number of entries in use */
+	int entry_cap;			/* number of entries there is room for */
+	int strtab_len;			/* number of bytes used in the string table */
+	int strtab_cap;			/* size of the string table */
+};
+
+struct usage_entry_v3
+{
+	int name_off;			/* offset of the name in the string table */
+	int reserved;
+	usage_t usage;
+};
+
+/* journal of an in place update of a version 3 usage file */
+struct usage_journal_header
+{
+	char tag[9];			/* USAGE_JOURNAL_MAGIC */
+	long long file_id;		/* file_id of the usage file being updated */
+	time_t last_decay;		/* new header values of the usage file */
+	int num_entries;
+	int strtab_len;
+	int nrecs;			/* number of usage_journal_rec's which follow */
+	int names_len;			/* bytes of names which follow the records */
+};
+
+struct usage_journal_rec
+{
+	int slot;			/* entry being written */
+	int name_off;			/* offset of the name of a new entry (-1 if not new) */
+	int name_len;			/* length of the name of a new entry (0 if not new) */
+	int reserved;
+	usage_t usage;
+};
+
 struct usage_info
 {
 	char *name;			/* name of the user */
@@ -1261,6 +1364,23 @@ struct resresv_filter {
 	resource_resv *job;
 	schd_error *err;		/* reason why set can not run*/
 };
+
+/**
+ * Index used while searching for jobs to preempt for one high priority job.
+ * Whether a node can satisfy a chunk of the high priority job does not change
+ * while we simulate preemption, so it is tested once per node and remembered
+ * here rather than once per candidate job and per call to
+ * select_index_to_preempt().  Node bits are indexed by node_info->node_ind.
+ * The running jobs of the useful nodes, found through each node's job_arr,
+ * are the candidates, see preempt_candidates_by_node().
+ */
+struct preempt_index {
+	pbs_bitmap *checked_nodes;	/* nodes which have been tested */
+	pbs_bitmap *useful_nodes;	/* nodes which can satisfy a chunk of the job */
+	pbs_bitmap *candidates;		/* resresv_ind of the jobs running on useful nodes */
+	resdef **rdtc_non_consumable;	/* non-consumables to check on multi-vnoded hosts */
+	schd_error *err;		/* scratch error used by the node tests */
+};
 #ifdef	__cplusplus
 }
 #endif
@@ -48,6 +48,7 @@
  * 	add_child()
  * 	add_unknown()
  * 	find_group_info()
+ * 	rec_find_group_info()
  * 	find_alloc_ginfo()
  * 	new_group_info()
  * 	parse_group()
@@ -60,10 +61,14 @@
  * 	compare_path()
  * 	print_fairshare()
  * 	write_usage()
- * 	rec_write_usage()
+ * 	collect_usage_entities()
+ * 	write_usage_full()
+ * 	write_usage_changes()
+ * 	replay_usage_journal()
  * 	read_usage()
  * 	read_usage_v1()
  * 	read_usage_v2()
+ * 	read_usage_v3()
  * 	new_group_path()
  * 	free_group_path_list()
  * 	create_group_path()
@@ -75,6 +80,8 @@
  * 	dup_fairshare_head()
  * 	free_fairshare_head()
  * 	reset_temp_usage()
+ * 	settle_usage()
+ * 	get_usage_factor()
  *
  */
 #include <pbs_config.h>
@@ -83,8 +90,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 
 #include <log.h>
+#include <pbs_idx.h>
 
 #include "data_types.h"
 #include "job_info.h"
@@ -105,6 +119,13 @@
 
 extern time_t last_decay;
 
+static void set_usage_file_state(fairshare_head *fhead, struct usage_header_v3 *uhead);
+static int write_usage_journal(const char *filename, struct usage_header_v3 *uhead,
+	struct usage_journal_rec *recs, int nrecs, char *names, int names_len);
+static void remove_usage_journal(const char *filename);
+static int apply_usage_changes(int fd, struct usage_header_v3 *uhead,
+	struct usage_journal_rec *recs, int nrecs, char *names);
+
 /**
  * @brief
  *		add_child - add a group_info to the resource group tree
@@ -124,6 +145,16 @@ add_child(group_info *ginfo, group_info *parent)
 		ginfo->parent = parent;
 		ginfo->resgroup = parent->cresgroup;
 		ginfo->gpath = create_group_path(ginfo);
+
+		ginfo->fhead = parent->fhead;
+		if (ginfo->fhead != NULL) {
+			/* a new node is current with the rest of the tree */
+			ginfo->decay_count = ginfo->fhead->decay_count;
+			ginfo->temp_gen = ginfo->fhead->temp_gen;
+			ginfo->usage_gen = ginfo->fhead->usage_gen;
+			if (ginfo->fhead->ginfo_idx != NULL && ginfo->name != NULL)
+				pbs_idx_insert(ginfo->fhead->ginfo_idx, ginfo->name, ginfo);
+		}
 	}
 }
 
@@ -149,8 +180,9 @@ add_unknown(group_info *ginfo, group_info *root)
 
 /**
  * @brief
- *		find_group_info - recursive function to find a group_info in the
- *			  resgroup tree
+ *		find_group_info - find a group_info in the resgroup tree.
+ *			  If root is the root of a tree, the tree's name index
+ *			  is used.  Otherwise the sub-tree is searched.
  *
  * @param[in]	name	-	name of the ginfo to find
  * @param[in]	root	-	the root of the current sub-tree
@@ -160,14 +192,42 @@ add_unknown(group_info *ginfo, group_info *root)
  */
 group_info *
 find_group_info(const char *name, group_info *root)
+{
+	group_info *ginfo = NULL;
+
+	if (root == NULL || name == NULL)
+		return root;
+
+	if (root->fhead != NULL && root->fhead->root == root && root->fhead->ginfo_idx != NULL) {
+		if (pbs_idx_find(root->fhead->ginfo_idx, (void **) &name, (void **) &ginfo, NULL) != PBS_IDX_RET_OK)
+			return NULL;
+		return ginfo;
+	}
+
+	return rec_find_group_info(name, root);
+}
+
+/**
+ * @brief
+ *		rec_find_group_info - recursive function to find a group_info in the
+ *			  resgroup tree
+ *
+ * @param[in]	name	-	name of the ginfo to find
+ * @param[in]	root	-	the root of the current sub-tree
+ *
+ * @return	the found group_info or NULL
+ *
+ */
+group_info *
+rec_find_group_info(const char *name, group_info *root)
 {
 	group_info *ginfo;		/* the found group */
 	if (root == NULL || name == NULL || !strcmp(name, root->name))
 		return root;
 
-	ginfo = find_group_info(name, root->sibling);
+	ginfo = rec_find_group_info(name, root->sibling);
 	if (ginfo == NULL)
-		ginfo = find_group_info(name, root->child);
+		ginfo = rec_find_group_info(name, root->child);
 
 	return ginfo;
 }
@@ -235,6 +295,12 @@ new_group_info()
 	ngi->parent = NULL;
 	ngi->sibling = NULL;
 	ngi->child = NULL;
+	ngi->fhead = NULL;
+	ngi->decay_count = 0;
+	ngi->temp_gen = 0;
+	ngi->usage_gen = 0;
+	ngi->usage_slot = -1;
+	ngi->written_usage = 0;
 
 	return ngi;
 }
@@ -375,11 +441,13 @@ preload_tree()
 	}
 
 	head->root = root;
+	root->fhead = head;
 
 	if ((root->name = string_dup(FAIRSHARE_ROOT_NAME)) == NULL) {
 		free_fairshare_head(head);
 		return NULL;
 	}
+	pbs_idx_insert(head->ginfo_idx, root->name, root);
 
 	root->resgroup = -1;
 	root->cresgroup = 0;
@@ -496,6 +564,7 @@ update_usage_on_run(resource_resv *resresv)
 	if (resresv->job->ginfo !=NULL) {
 		gpath = resresv->job->ginfo->gpath;
 		while (gpath != NULL) {
+			settle_usage(gpath->ginfo);
 			gpath->ginfo->temp_usage += u;
 			gpath = gpath->next;
 		}
@@ -508,7 +577,9 @@ update_usage_on_run(resource_resv *resresv)
 /**
  * @brief
  *		decay_fairshare_tree - decay the usage information kept in the fair
- *			       share tree
+ *			       share tree.  If root is the root of a tree, the decay
+ *			       is only recorded.  Each node will be decayed when it
+ *			       is next settled.
  *
  * @param[in,out]	root	-	the root of the fairshare tree
  *
@@ -521,9 +592,15 @@ decay_fairshare_tree(group_info *root)
 	if (root == NULL)
 		return;
 
+	if (root->fhead != NULL && root->fhead->root == root) {
+		root->fhead->decay_count++;
+		return;
+	}
+
 	decay_fairshare_tree(root->sibling);
 	decay_fairshare_tree(root->child);
 
+	settle_usage(root);
 	root->usage *= conf.fairshare_decay_factor;
 	if (root->usage < FAIRSHARE_MIN_USAGE)
 		root->usage = FAIRSHARE_MIN_USAGE;
@@ -574,6 +651,8 @@ compare_path(struct group_path *gp1, struct group_path *gp2)
 			if (cur1->ginfo->tree_percentage <= 0 && cur2->ginfo->tree_percentage<= 0)
 				return 0;
 
+			settle_usage(cur1->ginfo);
+			settle_usage(cur2->ginfo);
 			curval1 = cur1->ginfo->temp_usage / cur1->ginfo->tree_percentage;
 			curval2 = cur2->ginfo->temp_usage / cur2->ginfo->tree_percentage;
 
@@ -592,8 +671,11 @@ compare_path(struct group_path *gp1, struct group_path *gp2)
 
 /**
  * @brief
- *		write_usage - write the usage information to the usage file
- *		      This function uses a recursive helper function
+ *		write_usage - write the usage information to the usage file.
+ *		      If the file on disk is the one the tree was last synced with,
+ *		      only the entities whose usage changed are written, in place.
+ *		      Otherwise (or if the file is out of room or most entities
+ *		      changed), the whole file is rewritten.
  *
  * @param[in]	filename	-	usage file
  * @param[in]	fhead	-	Pointer to fairshare_head structure.
@@ -604,8 +686,13 @@ compare_path(struct group_path *gp1, struct group_path *gp2)
 int
 write_usage(const char *filename, fairshare_head *fhead)
 {
-	FILE *fp;		/* file pointer to usage file */
-	struct group_node_header head;
+	group_info **entities = NULL;
+	int num_entities = 0;
+	int size = 0;
+	int num_changed = 0;
+	int num_in_file = 0;
+	int i;
+	int rc = 0;
 
 	if (fhead == NULL)
 		return 0;
@@ -613,69 +700,627 @@ write_usage(const char *filename, fairshare_head *fhead)
 	if (filename == NULL)
 		filename = USAGE_FILE;
 
-	if ((fp = fopen(filename, "wb")) == NULL) {
-		sprintf(log_buffer, "Error opening file %s", filename);
-		log_err(errno, "write_usage", log_buffer);
+	if (collect_usage_entities(fhead->root, &entities, &num_entities, &size) == 0) {
+		free(entities);
 		return 0;
 	}
 
-	/* version 2:
-	 * header
-	 * last_decay
-	 * group_node_usage_v2
-	 * group_node_usage_v2
-	 * ...
-	 */
+	for (i = 0; i < num_entities; i++) {
+		if (entities[i]->usage_slot != -1)
+			num_in_file++;
+		if (entities[i]->usage_slot == -1 || entities[i]->usage != entities[i]->written_usage)
+			num_changed++;
+	}
 
-	memset(&head, 0, sizeof(struct group_node_header));
+	/* once most of the file changes (e.g., after a decay) it is cheaper to
+	 * write it all out again.  If entries in the file are no longer in the
+	 * tree (e.g., the tree was trimmed), the file needs to be rewritten
+	 * without them.
+	 */
+	if (fhead->ufile.file_id != 0 && num_in_file == fhead->ufile.num_entries &&
+		num_changed <= fhead->ufile.num_entries / 2)
+		rc = write_usage_changes(filename, fhead, entities, num_entities);
 
-	pbs_strncpy(head.tag, USAGE_MAGIC, sizeof(head.tag));
-	head.version = USAGE_VERSION;
-	fwrite(&head, sizeof(struct group_node_header), 1, fp);
-	fwrite(&fhead->last_decay, sizeof(time_t), 1, fp);
+	if (rc == 0)
+		rc = write_usage_full(filename, fhead);
 
-	rec_write_usage(fhead->root, fp);
-	fclose(fp);
-	return 1;
+	free(entities);
+	return rc;
 }
 
 /**
  * @brief
- *		rec_write_usage - recursive helper function which will write out all
- *			  the group_info structs of the resgroup tree
+ *		collect_usage_entities - recursive helper function which collects
+ *			  the group_info structs of the resgroup tree which are
+ *			  written to the usage file
  *
  * @param[in]	root	-	the root of the current subtree
- * @param[in]	fp	-	the file to write the ginfo out to
+ * @param[in,out]	arr	-	array of collected group_info's
+ * @param[in,out]	num	-	number of collected group_info's
+ * @param[in,out]	size	-	allocated size of arr
  *
- * @return nothing
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: failure
  *
  */
-void
-rec_write_usage(group_info *root, FILE *fp)
+int
+collect_usage_entities(group_info *root, group_info ***arr, int *num, int *size)
 {
-	struct group_node_usage_v2 grp;	/* used to write out usage info */
-
 	if (root == NULL)
-		return;
+		return 1;
+
+	settle_usage(root);
 
 	/* only write out leaves of the tree (fairshare entities)
-	 * usage defaults to 1 so don't bother writing those out either
+	 * usage defaults to 1 so don't bother writing those out either unless
+	 * they are already in the file.
 	 * It is possible that the unknown group is empty.  Don't want to write it out
 	 */
 #ifdef NAS /* localmod 043 */
 	if (root->child == NULL) {
 #else
-	if (root->usage != 1 && root->child == NULL && strcmp(root->name, UNKNOWN_GROUP_NAME) != 0) {
+	if ((root->usage != 1 || root->usage_slot != -1) && root->child == NULL &&
+		strcmp(root->name, UNKNOWN_GROUP_NAME) != 0) {
 #endif /* localmod 043 */
-		memset(&grp, 0, sizeof(struct group_node_usage_v2));
-		snprintf(grp.name, sizeof(grp.name), "%s", root->name);
-		grp.usage = root->usage;
+		if (*num == *size) {
+			group_info **tmp;
+			int nsize = *size == 0 ? 1024 : *size * 2;
+
+			tmp = static_cast<group_info **>(realloc(*arr, nsize * sizeof(group_info *)));
+			if (tmp == NULL) {
+				log_err(errno, __func__, MEM_ERR_MSG);
+				return 0;
+			}
+			*arr = tmp;
+			*size = nsize;
+		}
+		(*arr)[(*num)++] = root;
+	}
+
+	if (collect_usage_entities(root->sibling, arr, num, size) == 0)
+		return 0;
+	return collect_usage_entities(root->child, arr, num, size);
+}
+
+/**
+ * @brief
+ *		clear the usage file slots of a tree.  Used when the tree is no
+ *		longer in sync with the usage file.
+ *
+ * @param[in,out]	root	-	the root of the current subtree
+ *
+ * @return void
+ */
+static void
+clear_usage_slots(group_info *root)
+{
+	if (root == NULL)
+		return;
+
+	root->usage_slot = -1;
+	clear_usage_slots(root->sibling);
+	clear_usage_slots(root->child);
+}
+
+/**
+ * @brief
+ *		length of an entity name as stored in the usage file.  Names are
+ *		limited to USAGE_NAME_MAX like in the older versions of the file.
+ *
+ * @param[in]	name	-	entity name
+ *
+ * @return	int
+ */
+static int
+usage_name_len(const char *name)
+{
+	int len;
+
+	len = strlen(name);
+	if (len > USAGE_NAME_MAX - 1)
+		len = USAGE_NAME_MAX - 1;
+
+	return len;
+}
+
+/**
+ * @brief
+ *		write_usage_full - write a whole new version 3 usage file.
+ *		      The file is written to the side, synced and renamed over
+ *		      the old one, so the old file is intact if we crash.
+ *
+ * @param[in]	filename	-	usage file
+ * @param[in]	fhead	-	Pointer to fairshare_head structure.
+ *
+ * @return	success/failure
+ *
+ */
+int
+write_usage_full(const char *filename, fairshare_head *fhead)
+{
+	char tmpname[MAXPATHLEN + 1];
+	struct usage_header_v3 uhead;
+	struct usage_entry_v3 *entries = NULL;
+	char *strtab = NULL;
+	group_info **entities = NULL;
+	int num_entities = 0;
+	int size = 0;
+	int strtab_len = 0;
+	int i;
+	int fd;
+	off_t entries_off;
+	off_t strtab_off;
+	int rc = 0;
+
+	/* the file will be written with the current slots, start from scratch */
+	clear_usage_slots(fhead->root);
+	if (collect_usage_entities(fhead->root, &entities, &num_entities, &size) == 0) {
+		free(entities);
+		return 0;
+	}
+
+	memset(&uhead, 0, sizeof(uhead));
+	pbs_strncpy(uhead.head.tag, USAGE_MAGIC, sizeof(uhead.head.tag));
+	uhead.head.version = USAGE_VERSION;
+	uhead.last_decay = fhead->last_decay;
+	uhead.file_id = ((long long) time(NULL) << 32) | (getpid() & 0xffffffff);
+	uhead.num_entries = num_entities;
+	uhead.entry_cap = num_entities < USAGE_MIN_ENTRIES ? USAGE_MIN_ENTRIES : num_entities * 2;
+
+	for (i = 0; i < num_entities; i++)
+		strtab_len += usage_name_len(entities[i]->name) + 1;
+	uhead.strtab_len = strtab_len;
+	uhead.strtab_cap = uhead.entry_cap * USAGE_AVG_NAME_LEN;
+	if (uhead.strtab_cap < strtab_len * 2)
+		uhead.strtab_cap = strtab_len * 2;
+
+	entries = static_cast<struct usage_entry_v3 *>(calloc(num_entities + 1, sizeof(struct usage_entry_v3)));
+	strtab = static_cast<char *>(calloc(strtab_len + 1, 1));
+	if (entries == NULL || strtab == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		goto cleanup;
+	}
+
+	strtab_len = 0;
+	for (i = 0; i < num_entities; i++) {
+		int len = usage_name_len(entities[i]->name);
+
+		entries[i].name_off = strtab_len;
+		entries[i].usage = entities[i]->usage;
+		memcpy(strtab + strtab_len, entities[i]->name, len);
+		strtab_len += len + 1;
+	}
+
+	entries_off = sizeof(uhead);
+	strtab_off = entries_off + (off_t) uhead.entry_cap * sizeof(struct usage_entry_v3);
+
+	snprintf(tmpname, sizeof(tmpname), "%s.new", filename);
+	if ((fd = open(tmpname, O_WRONLY | O_CREAT | O_TRUNC, 0644)) == -1) {
+		snprintf(log_buffer, sizeof(log_buffer), "Error opening file %s", tmpname);
+		log_err(errno, __func__, log_buffer);
+		goto cleanup;
+	}
+
+	if (pwrite(fd, &uhead, sizeof(uhead), 0) != sizeof(uhead) ||
+		pwrite(fd, entries, num_entities * sizeof(struct usage_entry_v3), entries_off) !=
+			(ssize_t) (num_entities * sizeof(struct usage_entry_v3)) ||
+		pwrite(fd, strtab, strtab_len, strtab_off) != strtab_len ||
+		ftruncate(fd, strtab_off + uhead.strtab_cap) == -1 ||
+		fsync(fd) == -1) {
+		snprintf(log_buffer, sizeof(log_buffer), "Error writing file %s", tmpname);
+		log_err(errno, __func__, log_buffer);
+		close(fd);
+		unlink(tmpname);
+		goto cleanup;
+	}
+	close(fd);
+
+	if (rename(tmpname, filename) == -1) {
+		snprintf(log_buffer, sizeof(log_buffer), "Error renaming %s to %s", tmpname, filename);
+		log_err(errno, __func__, log_buffer);
+		unlink(tmpname);
+		goto cleanup;
+	}
+
+	for (i = 0; i < num_entities; i++) {
+		entities[i]->usage_slot = i;
+		entities[i]->written_usage = entities[i]->usage;
+	}
+	set_usage_file_state(fhead, &uhead);
+	rc = 1;
+
+cleanup:
+	free(entities);
+	free(entries);
+	free(strtab);
+	return rc;
+}
+
+/**
+ * @brief
+ *		write_usage_changes - update a version 3 usage file in place with
+ *		      the entities whose usage has changed and the entities which
+ *		      are new to the file.  The changes are first written to a
+ *		      journal which is replayed by read_usage() if we crash
+ *		      while applying them.
+ *
+ * @param[in]	filename	-	usage file
+ * @param[in]	fhead	-	Pointer to fairshare_head structure.
+ * @param[in]	entities	-	entities which are written to the usage file
+ * @param[in]	num_entities	-	number of entities
+ *
+ * @return	int
+ * @retval	1	: file was updated
+ * @retval	0	: file needs to be fully rewritten
+ *
+ */
+int
+write_usage_changes(const char *filename, fairshare_head *fhead, group_info **entities, int num_entities)
+{
+	struct usage_header_v3 uhead;
+	struct usage_journal_rec *recs = NULL;
+	char *names = NULL;
+	int nrecs = 0;
+	int names_len = 0;
+	int num_entries;
+	int strtab_len;
+	int fd;
+	int i;
+	int rc = 0;
+
+	/* a journal from a previous crash needs to be applied first */
+	replay_usage_journal(filename);
+
+	if ((fd = open(filename, O_RDWR)) == -1)
+		return 0;
+
+	if (pread(fd, &uhead, sizeof(uhead), 0) != sizeof(uhead) ||
+		strcmp(uhead.head.tag, USAGE_MAGIC) != 0 || uhead.head.version != USAGE_VERSION ||
+		uhead.file_id != fhead->ufile.file_id ||
+		uhead.num_entries != fhead->ufile.num_entries ||
+		uhead.strtab_len != fhead->ufile.strtab_len) {
+		/* someone else has rewritten the file */
+		close(fd);
+		return 0;
+	}
+
+	recs = static_cast<struct usage_journal_rec *>(calloc(num_entities + 1, sizeof(struct usage_journal_rec)));
+	names = static_cast<char *>(malloc((size_t) num_entities * USAGE_NAME_MAX + 1));
+	if (recs == NULL || names == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		goto cleanup;
+	}
+
+	num_entries = uhead.num_entries;
+	strtab_len = uhead.strtab_len;
+	for (i = 0; i < num_entities; i++) {
+		group_info *ginfo = entities[i];
+
+		if (ginfo->usage_slot == -1) {
+			int len = usage_name_len(ginfo->name);
+
+			if (num_entries == uhead.entry_cap || strtab_len + len + 1 > uhead.strtab_cap)
+				goto cleanup; /* out of room */
+
+			recs[nrecs].slot = num_entries++;
+			recs[nrecs].name_off = strtab_len;
+			recs[nrecs].name_len = len + 1;
+			memcpy(names + names_len, ginfo->name, len);
+			names[names_len + len] = '\0';
+			names_len += len + 1;
+			strtab_len += len + 1;
+		} else if (ginfo->usage != ginfo->written_usage) {
+			recs[nrecs].slot = ginfo->usage_slot;
+			recs[nrecs].name_off = -1;
+			recs[nrecs].name_len = 0;
+		} else
+			continue;
+		recs[nrecs].usage = ginfo->usage;
+		nrecs++;
+	}
+
+	if (nrecs == 0 && uhead.last_decay == fhead->last_decay) {
+		rc = 1;
+		goto cleanup;
+	}
+
+	uhead.num_entries = num_entries;
+	uhead.strtab_len = strtab_len;
+	uhead.last_decay = fhead->last_decay;
+
+	if (write_usage_journal(filename, &uhead, recs, nrecs, names, names_len) == 0)
+		goto cleanup;
+
+	if (apply_usage_changes(fd, &uhead, recs, nrecs, names) == 0) {
+		/* leave the journal for read_usage() */
+		snprintf(log_buffer, sizeof(log_buffer), "Error updating file %s", filename);
+		log_err(errno, __func__, log_buffer);
+		goto cleanup;
+	}
+	remove_usage_journal(filename);
+
+	nrecs = 0;
+	for (i = 0; i < num_entities; i++) {
+		group_info *ginfo = entities[i];
+
+		if (ginfo->usage_slot == -1 || ginfo->usage != ginfo->written_usage) {
+			ginfo->usage_slot = recs[nrecs++].slot;
+			ginfo->written_usage = ginfo->usage;
+		}
+	}
+	set_usage_file_state(fhead, &uhead);
+	rc = 1;
+
+cleanup:
+	close(fd);
+	free(recs);
+	free(names);
+	return rc;
+}
+
+/**
+ * @brief
+ *		remember the layout of the usage file the tree is in sync with
+ *
+ * @param[in,out]	fhead	-	fairshare head
+ * @param[in]	uhead	-	header of the usage file
+ *
+ * @return void
+ */
+static void
+set_usage_file_state(fairshare_head *fhead, struct usage_header_v3 *uhead)
+{
+	fhead->ufile.file_id = uhead->file_id;
+	fhead->ufile.num_entries = uhead->num_entries;
+	fhead->ufile.entry_cap = uhead->entry_cap;
+	fhead->ufile.strtab_len = uhead->strtab_len;
+	fhead->ufile.strtab_cap = uhead->strtab_cap;
+	fhead->ufile.last_decay = uhead->last_decay;
+}
+
+/**
+ * @brief
+ *		checksum of a usage journal
+ *
+ * @param[in]	buf	-	journal contents
+ * @param[in]	len	-	length of buf
+ *
+ * @return	unsigned long
+ */
+static unsigned long
+usage_journal_cksum(const char *buf, size_t len)
+{
+	unsigned long sum = 0;
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		sum = sum * 31 + (unsigned char) buf[i];
+
+	return sum;
+}
+
+/**
+ * @brief
+ *		write the changes about to be made to a usage file to its journal
+ *
+ * @par	FORMAT:	usage_journal_header
+ *		usage_journal_rec[nrecs]
+ *		names of new entities (names_len bytes)
+ *		checksum of all of the above
+ *
+ * @param[in]	filename	-	usage file
+ * @param[in]	uhead	-	the header the usage file will have
+ * @param[in]	recs	-	the entries to write
+ * @param[in]	nrecs	-	number of entries
+ * @param[in]	names	-	names of new entries
+ * @param[in]	names_len	-	length of names
+ *
+ * @return	success/failure
+ */
+static int
+write_usage_journal(const char *filename, struct usage_header_v3 *uhead,
+	struct usage_journal_rec *recs, int nrecs, char *names, int names_len)
+{
+	char jname[MAXPATHLEN + 1];
+	struct usage_journal_header jhead;
+	char *buf;
+	size_t len;
+	size_t off;
+	unsigned long cksum;
+	int fd;
+	int rc = 0;
 
-		fwrite(&grp, sizeof(struct group_node_usage_v2), 1, fp);
+	memset(&jhead, 0, sizeof(jhead));
+	pbs_strncpy(jhead.tag, USAGE_JOURNAL_MAGIC, sizeof(jhead.tag));
+	jhead.file_id = uhead->file_id;
+	jhead.last_decay = uhead->last_decay;
+	jhead.num_entries = uhead->num_entries;
+	jhead.strtab_len = uhead->strtab_len;
+	jhead.nrecs = nrecs;
+	jhead.names_len = names_len;
+
+	len = sizeof(jhead) + nrecs * sizeof(struct usage_journal_rec) + names_len;
+	if ((buf = static_cast<char *>(malloc(len + sizeof(cksum)))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return 0;
+	}
+	off = 0;
+	memcpy(buf, &jhead, sizeof(jhead));
+	off += sizeof(jhead);
+	memcpy(buf + off, recs, nrecs * sizeof(struct usage_journal_rec));
+	off += nrecs * sizeof(struct usage_journal_rec);
+	memcpy(buf + off, names, names_len);
+	cksum = usage_journal_cksum(buf, len);
+	memcpy(buf + len, &cksum, sizeof(cksum));
+
+	snprintf(jname, sizeof(jname), "%s%s", filename, USAGE_JOURNAL_SUFFIX);
+	if ((fd = open(jname, O_WRONLY | O_CREAT | O_TRUNC, 0644)) == -1) {
+		snprintf(log_buffer, sizeof(log_buffer), "Error opening file %s", jname);
+		log_err(errno, __func__, log_buffer);
+	} else {
+		if (write(fd, buf, len + sizeof(cksum)) == (ssize_t) (len + sizeof(cksum)) && fsync(fd) == 0)
+			rc = 1;
+		else {
+			snprintf(log_buffer, sizeof(log_buffer), "Error writing file %s", jname);
+			log_err(errno, __func__, log_buffer);
+		}
+		close(fd);
+		if (rc == 0)
+			unlink(jname);
+	}
+
+	free(buf);
+	return rc;
+}
+
+/**
+ * @brief
+ *		remove the journal of a usage file
+ *
+ * @param[in]	filename	-	usage file
+ *
+ * @return void
+ */
+static void
+remove_usage_journal(const char *filename)
+{
+	char jname[MAXPATHLEN + 1];
+
+	snprintf(jname, sizeof(jname), "%s%s", filename, USAGE_JOURNAL_SUFFIX);
+	unlink(jname);
+}
+
+/**
+ * @brief
+ *		apply changes to a usage file in place and sync it
+ *
+ * @param[in]	fd	-	open usage file
+ * @param[in]	uhead	-	the new header of the usage file
+ * @param[in]	recs	-	the entries to write
+ * @param[in]	nrecs	-	number of entries
+ * @param[in]	names	-	names of new entries
+ *
+ * @return	success/failure
+ */
+static int
+apply_usage_changes(int fd, struct usage_header_v3 *uhead,
+	struct usage_journal_rec *recs, int nrecs, char *names)
+{
+	off_t entries_off;
+	off_t strtab_off;
+	int names_off = 0;
+	int i;
+
+	entries_off = sizeof(struct usage_header_v3);
+	strtab_off = entries_off + (off_t) uhead->entry_cap * sizeof(struct usage_entry_v3);
+
+	for (i = 0; i < nrecs; i++) {
+		off_t eoff;
+
+		if (recs[i].slot < 0 || recs[i].slot >= uhead->num_entries)
+			return 0;
+
+		eoff = entries_off + (off_t) recs[i].slot * sizeof(struct usage_entry_v3);
+		if (recs[i].name_len > 0) {
+			struct usage_entry_v3 entry;
+
+			if (recs[i].name_off < 0 || recs[i].name_off + recs[i].name_len > uhead->strtab_len)
+				return 0;
+			if (pwrite(fd, names + names_off, recs[i].name_len, strtab_off + recs[i].name_off) != recs[i].name_len)
+				return 0;
+			names_off += recs[i].name_len;
+
+			memset(&entry, 0, sizeof(entry));
+			entry.name_off = recs[i].name_off;
+			entry.usage = recs[i].usage;
+			if (pwrite(fd, &entry, sizeof(entry), eoff) != sizeof(entry))
+				return 0;
+		} else {
+			/* only the usage of an existing entry changes */
+			if (pwrite(fd, &recs[i].usage, sizeof(usage_t), eoff + offsetof(struct usage_entry_v3, usage)) != sizeof(usage_t))
+				return 0;
+		}
 	}
 
-	rec_write_usage(root->sibling, fp);
-	rec_write_usage(root->child, fp);
+	/* the header is written last so new entries are only seen once they're complete */
+	if (pwrite(fd, uhead, sizeof(struct usage_header_v3), 0) != sizeof(struct usage_header_v3))
+		return 0;
+
+	return fsync(fd) == 0;
+}
+
+/**
+ * @brief
+ *		replay_usage_journal - if a usage file has a journal, a previous
+ *		      update of the file didn't finish.  If the journal is
+ *		      complete and belongs to the file, apply it.  The journal
+ *		      is removed either way.
+ *
+ * @param[in]	filename	-	usage file
+ *
+ * @return void
+ */
+void
+replay_usage_journal(const char *filename)
+{
+	char jname[MAXPATHLEN + 1];
+	struct stat sb;
+	struct usage_journal_header jhead;
+	struct usage_header_v3 uhead;
+	char *buf = NULL;
+	unsigned long cksum;
+	size_t len;
+	int jfd;
+	int fd = -1;
+
+	snprintf(jname, sizeof(jname), "%s%s", filename, USAGE_JOURNAL_SUFFIX);
+	if ((jfd = open(jname, O_RDONLY)) == -1)
+		return;
+
+	if (fstat(jfd, &sb) == -1 || sb.st_size < (off_t) (sizeof(jhead) + sizeof(cksum)))
+		goto done;
+
+	len = sb.st_size - sizeof(cksum);
+	if ((buf = static_cast<char *>(malloc(sb.st_size))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		goto done;
+	}
+	if (read(jfd, buf, sb.st_size) != sb.st_size)
+		goto done;
+
+	memcpy(&cksum, buf + len, sizeof(cksum));
+	memcpy(&jhead, buf, sizeof(jhead));
+	if (cksum != usage_journal_cksum(buf, len) ||
+		strcmp(jhead.tag, USAGE_JOURNAL_MAGIC) != 0 ||
+		len != sizeof(jhead) + jhead.nrecs * sizeof(struct usage_journal_rec) + jhead.names_len) {
+		/* the crash happened while writing the journal, the file was not touched */
+		goto done;
+	}
+
+	if ((fd = open(filename, O_RDWR)) == -1)
+		goto done;
+	if (pread(fd, &uhead, sizeof(uhead), 0) != sizeof(uhead) || uhead.file_id != jhead.file_id)
+		goto done;
+
+	uhead.last_decay = jhead.last_decay;
+	uhead.num_entries = jhead.num_entries;
+	uhead.strtab_len = jhead.strtab_len;
+	if (apply_usage_changes(fd, &uhead, (struct usage_journal_rec *) (buf + sizeof(jhead)), jhead.nrecs,
+		buf + sizeof(jhead) + jhead.nrecs * sizeof(struct usage_journal_rec)) == 0) {
+		snprintf(log_buffer, sizeof(log_buffer), "Error replaying journal %s", jname);
+		log_err(errno, __func__, log_buffer);
+		goto done;
+	}
+	log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_FILE, LOG_NOTICE, "fairshare usage",
+		"Replayed usage file journal");
+
+done:
+	if (fd != -1)
+		close(fd);
+	close(jfd);
+	free(buf);
+	unlink(jname);
 }
 
 /**
@@ -704,6 +1349,9 @@ read_usage(const char *filename, int flags, fairshare_head *fhead)
 	if (filename == NULL)
 		filename = USAGE_FILE;
 
+	/* finish an interrupted in place update of the file */
+	replay_usage_journal(filename);
+
 	if ((fp = fopen(filename, "r")) == NULL) {
 		log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_FILE, LOG_WARNING, "fairshare usage",
 			  "Creating usage database for fairshare");
@@ -725,6 +1373,8 @@ read_usage(const char *filename, int flags, fairshare_head *fhead)
 				if (!error)
 					read_usage_v2(fp, flags, fhead->root);
 			}
+			else if (head.version == 3)
+				error = !read_usage_v3(fileno(fp), flags, fhead);
 			else
 				error = 1;
 
@@ -768,12 +1418,14 @@ read_usage_v1(FILE *fp, group_info *root)
 		if (grp.usage >= 0 && is_valid_pbs_name(grp.name, USAGE_NAME_MAX)) {
 			ginfo = find_alloc_ginfo(grp.name, root);
 			if (ginfo != NULL) {
+				settle_usage(ginfo);
 				ginfo->usage = grp.usage;
 				ginfo->temp_usage = grp.usage;
 				if (ginfo->child == NULL) {
 					gpath = ginfo->gpath;
 					/* add usage down the path from the root to our parent */
 					while (gpath->next != NULL) {
+						settle_usage(gpath->ginfo);
 						gpath->ginfo->usage += grp.usage;
 						gpath->ginfo->temp_usage += grp.usage;
 						gpath = gpath->next;
@@ -823,12 +1475,14 @@ read_usage_v2(FILE *fp, int flags, group_info *root)
 				ginfo = find_alloc_ginfo(grp.name, root);
 
 			if (ginfo != NULL) {
+				settle_usage(ginfo);
 				ginfo->usage = grp.usage;
 				ginfo->temp_usage = grp.usage;
 				if (ginfo->child == NULL) {
 					gpath = ginfo->gpath;
 					/* add usage down the path from the root to our parent */
 					while (gpath->next != NULL) {
+						settle_usage(gpath->ginfo);
 						gpath->ginfo->usage += grp.usage;
 						gpath->ginfo->temp_usage += grp.usage;
 						gpath = gpath->next;
@@ -844,6 +1498,108 @@ read_usage_v2(FILE *fp, int flags, group_info *root)
 	return 1;
 }
 
+/**
+ * @brief
+ * 		read version 3 usage file.  The file is mapped into memory and the
+ * 		entries are read directly out of it.
+ *
+ * @param[in]	fd	- the open usage file
+ * @param[in]	flags	- flags to check whether to trim or not.
+ * @param[in]	fhead	- the fairshare tree
+ *
+ *	@retval 1 success
+ *	@retval 0 failure
+ *
+ */
+int
+read_usage_v3(int fd, int flags, fairshare_head *fhead)
+{
+	struct stat sb;
+	char *map;
+	struct usage_header_v3 *uhead;
+	struct usage_entry_v3 *entries;
+	char *strtab;
+	size_t strtab_off;
+	group_info *ginfo;
+	struct group_path *gpath;
+	int i;
+
+	if (fd < 0 || fhead == NULL)
+		return 0;
+
+	if (fstat(fd, &sb) == -1 || sb.st_size < (off_t) sizeof(struct usage_header_v3))
+		return 0;
+
+	map = static_cast<char *>(mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0));
+	if (map == MAP_FAILED) {
+		log_err(errno, __func__, "Error mapping usage file");
+		return 0;
+	}
+
+	uhead = (struct usage_header_v3 *) map;
+	strtab_off = sizeof(struct usage_header_v3) + (size_t) uhead->entry_cap * sizeof(struct usage_entry_v3);
+	/* 946713600 = 1/1/2000 00:00 - before usage version 2 existed */
+	if ((uhead->last_decay != 0 && uhead->last_decay <= 946713600) ||
+		uhead->num_entries < 0 || uhead->entry_cap < uhead->num_entries ||
+		uhead->strtab_len < 0 || uhead->strtab_cap < uhead->strtab_len ||
+		strtab_off + uhead->strtab_cap > (size_t) sb.st_size) {
+		munmap(map, sb.st_size);
+		return 0;
+	}
+
+	fhead->last_decay = uhead->last_decay;
+	entries = (struct usage_entry_v3 *) (map + sizeof(struct usage_header_v3));
+	strtab = map + strtab_off;
+
+	for (i = 0; i < uhead->num_entries; i++) {
+		char *name;
+
+		if (entries[i].name_off < 0 || entries[i].name_off >= uhead->strtab_len ||
+			memchr(strtab + entries[i].name_off, '\0', uhead->strtab_len - entries[i].name_off) == NULL) {
+			log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_FILE, LOG_WARNING,
+				  "fairshare usage", "Invalid entity");
+			continue;
+		}
+		name = strtab + entries[i].name_off;
+
+		if (entries[i].usage >= 0 && is_valid_pbs_name(name, USAGE_NAME_MAX)) {
+			/* if we're trimming the tree, don't add any new nodes which are not
+			 * already in the resource_group file
+			 */
+			if (flags & FS_TRIM)
+				ginfo = find_group_info(name, fhead->root);
+			else
+				ginfo = find_alloc_ginfo(name, fhead->root);
+
+			if (ginfo != NULL) {
+				settle_usage(ginfo);
+				ginfo->usage = entries[i].usage;
+				ginfo->temp_usage = entries[i].usage;
+				ginfo->usage_slot = i;
+				ginfo->written_usage = entries[i].usage;
+				if (ginfo->child == NULL) {
+					gpath = ginfo->gpath;
+					/* add usage down the path from the root to our parent */
+					while (gpath->next != NULL) {
+						settle_usage(gpath->ginfo);
+						gpath->ginfo->usage += entries[i].usage;
+						gpath->ginfo->temp_usage += entries[i].usage;
+						gpath = gpath->next;
+					}
+				}
+			}
+		}
+		else
+			log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_FILE, LOG_WARNING,
+				  "fairshare usage", "Invalid entity");
+	}
+
+	set_usage_file_state(fhead, uhead);
+	munmap(map, sb.st_size);
+
+	return 1;
+}
+
 /**
  * @brief
  *		new_group_path - create a new group_path structure and init it
@@ -944,6 +1700,8 @@ struct group_path *create_group_path(group_info *ginfo)
 int
 over_fs_usage(group_info *ginfo)
 {
+	settle_usage(ginfo);
+	settle_usage(ginfo->gpath->ginfo);
 	return ginfo->gpath->ginfo->usage * ginfo->tree_percentage < ginfo->usage;
 }
 
@@ -977,6 +1735,11 @@ dup_fairshare_tree(group_info *root, group_info *nparent)
 	nroot->usage = root->usage;
 	nroot->usage_factor = root->usage_factor;
 	nroot->temp_usage = root->temp_usage;
+	nroot->decay_count = root->decay_count;
+	nroot->temp_gen = root->temp_gen;
+	nroot->usage_gen = root->usage_gen;
+	nroot->usage_slot = root->usage_slot;
+	nroot->written_usage = root->written_usage;
 	nroot->name = string_dup(root->name);
 
 	if (nroot->name == NULL) {
@@ -1043,10 +1806,44 @@ new_fairshare_head()
 
 	fhead->root = NULL;
 	fhead->last_decay = 0;
+	fhead->decay_count = 0;
+	fhead->temp_gen = 0;
+	fhead->temp_decay_count = 0;
+	fhead->usage_gen = 0;
+	memset(&fhead->ufile, 0, sizeof(fhead->ufile));
+
+	if ((fhead->ginfo_idx = pbs_idx_create(0, 0)) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free(fhead);
+		return NULL;
+	}
 
 	return fhead;
 }
 
+/**
+ * @brief
+ *		attach a fairshare tree to its head: point each node at the head
+ *		and add it to the head's name index
+ *
+ * @param[in,out]	root	-	root of the (sub)tree
+ * @param[in]	fhead	-	the head of the tree
+ *
+ * @return void
+ */
+static void
+attach_fairshare_tree(group_info *root, fairshare_head *fhead)
+{
+	if (root == NULL)
+		return;
+
+	root->fhead = fhead;
+	pbs_idx_insert(fhead->ginfo_idx, root->name, root);
+
+	attach_fairshare_tree(root->sibling, fhead);
+	attach_fairshare_tree(root->child, fhead);
+}
+
 /**
  * @brief
  *		copy constructor for fairshare_head
@@ -1070,11 +1867,17 @@ dup_fairshare_head(fairshare_head *ofhead)
 		return NULL;
 
 	nfhead->last_decay = ofhead->last_decay;
+	nfhead->decay_count = ofhead->decay_count;
+	nfhead->temp_gen = ofhead->temp_gen;
+	nfhead->temp_decay_count = ofhead->temp_decay_count;
+	nfhead->usage_gen = ofhead->usage_gen;
+	nfhead->ufile = ofhead->ufile;
 	nfhead->root = dup_fairshare_tree(ofhead->root, NULL);
 	if (nfhead->root == NULL) {
 		free_fairshare_head(nfhead);
 		return NULL;
 	}
+	attach_fairshare_tree(nfhead->root, nfhead);
 
 	return nfhead;
 }
@@ -1092,13 +1895,17 @@ free_fairshare_head(fairshare_head *fhead)
 		return;
 
 	free_fairshare_tree(fhead->root);
+	pbs_idx_destroy(fhead->ginfo_idx);
 
 	free(fhead);
 }
 
 /**
  * @brief
- * 		recursively walk the fairshare tree resetting temp_usage = usage
+ * 		reset temp_usage = usage for the fairshare tree.  If head is
+ *		the root of a tree, the reset is only recorded.  Each node
+ *		will be reset when it is next settled.  Otherwise the
+ *		sub-tree is walked.
  *
  * @param[in]	head	-	fairshare node to reset
  *
@@ -1110,6 +1917,13 @@ reset_temp_usage(group_info *head)
 	if (head == NULL)
 		return;
 
+	if (head->fhead != NULL && head->fhead->root == head) {
+		head->fhead->temp_gen++;
+		head->fhead->temp_decay_count = head->fhead->decay_count;
+		return;
+	}
+
+	settle_usage(head);
 	head->temp_usage = head->usage;
 	reset_temp_usage(head->sibling);
 	reset_temp_usage(head->child);
@@ -1117,33 +1931,105 @@ reset_temp_usage(group_info *head)
 
 /**
  * @brief
- *		recursive helper function to calc_usage_factor()
- * @param root	- parent fairshare tree node
- * @param ginfo	- child fairshare tree node
+ *		decay a node's usage a number of times
+ *
+ * @param[in,out]	ginfo	-	the node to decay
+ * @param[in]	count	-	number of times to decay
  *
  * @return void
  */
 static void
-calc_usage_factor_rec(group_info *root, group_info *ginfo)
+decay_usage(group_info *ginfo, int count)
 {
-	float usage;
+	for (; count > 0; count--) {
+		ginfo->usage *= conf.fairshare_decay_factor;
+		if (ginfo->usage < FAIRSHARE_MIN_USAGE) {
+			/* further decays won't change it */
+			ginfo->usage = FAIRSHARE_MIN_USAGE;
+			break;
+		}
+	}
+}
 
-	if (root == NULL || ginfo == NULL)
+/**
+ * @brief
+ *		bring a node's usage and temp_usage up to date with the decays
+ *		and temp_usage resets which were recorded on its tree since it
+ *		was last settled.  This must be called before usage or
+ *		temp_usage are read or modified.
+ *
+ * @param[in,out]	ginfo	-	the node to settle
+ *
+ * @return void
+ */
+void
+settle_usage(group_info *ginfo)
+{
+	fairshare_head *fhead;
+
+	if (ginfo == NULL || ginfo->fhead == NULL)
 		return;
 
+	fhead = ginfo->fhead;
+
+	if (ginfo->temp_gen != fhead->temp_gen) {
+		/* temp_usage is a copy of usage as it was at the last reset */
+		decay_usage(ginfo, fhead->temp_decay_count - ginfo->decay_count);
+		ginfo->decay_count = fhead->temp_decay_count;
+		ginfo->temp_usage = ginfo->usage;
+		ginfo->temp_gen = fhead->temp_gen;
+	}
+
+	if (ginfo->decay_count != fhead->decay_count) {
+		decay_usage(ginfo, fhead->decay_count - ginfo->decay_count);
+		ginfo->decay_count = fhead->decay_count;
+	}
+}
+
+/**
+ * @brief
+ *		return the usage_factor of a node.  The usage_factor is a number
+ *		that takes the node's usage plus part of its parent's
+ *		usage_factor into account.  This will give a number that is
+ *		comparable across the tree.  It is calculated when first asked
+ *		for after calc_usage_factor() and only along the path from the
+ *		node to the root.
+ *
+ * @param[in,out]	ginfo	-	the node
+ *
+ * @return float
+ */
+float
+get_usage_factor(group_info *ginfo)
+{
+	group_info *root;
+	float usage;
+
+	if (ginfo == NULL)
+		return 0;
+
+	if (ginfo->fhead == NULL || ginfo->parent == NULL || ginfo->usage_gen == ginfo->fhead->usage_gen)
+		return ginfo->usage_factor;
+
+	root = ginfo->fhead->root;
+	settle_usage(ginfo);
+	settle_usage(root);
+
 	usage = ginfo->usage / root->usage;
-	ginfo->usage_factor = usage + ((ginfo->parent->usage_factor - usage) * ginfo->group_percentage);
+	/* Root's children use their real usage as their arbitrary usage */
+	if (ginfo->parent == root)
+		ginfo->usage_factor = usage;
+	else
+		ginfo->usage_factor = usage + ((get_usage_factor(ginfo->parent) - usage) * ginfo->group_percentage);
+	ginfo->usage_gen = ginfo->fhead->usage_gen;
 
-	calc_usage_factor_rec(root, ginfo->sibling);
-	calc_usage_factor_rec(root, ginfo->child);
+	return ginfo->usage_factor;
 }
 
 /**
  * @brief
- *		calculate usage_factor numbers for entire tree.
- *		The usage_factor is a number that takes the node's usage
- *		plus part of its parent's usage_factor into account.  This
- *		will give a number that is comparable across the tree.
+ *		invalidate the usage_factor numbers for the entire tree.
+ *		They will be recalculated by get_usage_factor() when needed.
  *
  * @param[in] tree - fairshare tree
  *
@@ -1152,19 +2038,10 @@ calc_usage_factor_rec(group_info *root, group_info *ginfo)
 void
 calc_usage_factor(fairshare_head *tree)
 {
-	group_info *ginfo;
-	group_info *root;
-
 	if (tree == NULL)
 		return;
 
-	root = tree->root;
-	/* Root's children use their real usage as their arbitrary usage */
-	for (ginfo = root->child; ginfo != NULL; ginfo = ginfo->sibling) {
-		ginfo->usage_factor = ginfo->usage / root->usage;
-		calc_usage_factor_rec(root, ginfo->child);
-	}
-
+	tree->usage_gen++;
 }
 
 /**
@@ -1178,6 +2055,7 @@ void reset_usage(group_info *node) {
 		return;
 	reset_usage(node->sibling);
 	reset_usage(node->child);
+	settle_usage(node);
 	node->usage = 1;
 	node->temp_usage = 1;
 }
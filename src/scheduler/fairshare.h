@@ -55,6 +55,12 @@ void add_child(group_info *ginfo, group_info *parent);
  */
 group_info *find_group_info(const char *name, group_info *root);
 
+/*
+ *      rec_find_group_info - recursive function to find a ginfo in a
+ *                            sub-tree of the resgroup tree
+ */
+group_info *rec_find_group_info(const char *name, group_info *root);
+
 /*
  *      find_alloc_ginfo - trys to find a ginfo in the fair share tree.  If it
  *                        can not find the ginfo, then allocate a new one and
@@ -135,15 +141,31 @@ void decay_fairshare_tree(group_info *root);
 
 /*
  *      write_usage - write the usage information to the usage file
- *                    This fuction uses a recursive helper function
+ *                    Only changed entities are written if possible
  */
 int write_usage(const char *filename, fairshare_head *fhead);
 
 /*
- *      rec_write_usage - recursive helper function which will write out all
- *                        the group_info structs of the resgroup tree
+ *      collect_usage_entities - recursive helper function which collects
+ *                        the group_info structs written to the usage file
+ */
+int collect_usage_entities(group_info *root, group_info ***arr, int *num, int *size);
+
+/*
+ *      write_usage_full - write a whole new version 3 usage file
+ */
+int write_usage_full(const char *filename, fairshare_head *fhead);
+
+/*
+ *      write_usage_changes - update a version 3 usage file in place
  */
-void rec_write_usage(group_info *root, FILE *fp);
+int write_usage_changes(const char *filename, fairshare_head *fhead, group_info **entities, int num_entities);
+
+/*
+ *      replay_usage_journal - finish an interrupted in place update of a
+ *                             usage file
+ */
+void replay_usage_journal(const char *filename);
 
 /*
  *      read_usage - read the usage information and load it into the
@@ -161,6 +183,11 @@ int read_usage_v1(FILE *fp, group_info *root);
  */
 int read_usage_v2(FILE *fp, int flags, group_info *root);
 
+/*
+ *      read_usage_v3 - read version 3 usage file
+ */
+int read_usage_v3(int fd, int flags, fairshare_head *fhead);
+
 /*
  *      new_group_path - create a new group_path structure and init it
  */
@@ -262,9 +289,15 @@ void reset_temp_usage(group_info *head);
 /* reset the tree to 1 usage */
 void reset_usage(group_info *node);
 
-/* Calculate the arbitrary usage of the tree */
+/* Invalidate the arbitrary usage of the tree */
 void calc_usage_factor(fairshare_head *tree);
 
+/* Return the arbitrary usage of a node, calculating it if needed */
+float get_usage_factor(group_info *ginfo);
+
+/* Bring a node's usage up to date with lazy decays and temp_usage resets */
+void settle_usage(group_info *ginfo);
+
 
 
 #ifdef	__cplusplus
@@ -371,6 +371,7 @@ init_scheduling_cycle(status *policy, int pbs_sd, server_info *sinfo)
 
 							gpath = user->gpath;
 							while (gpath != NULL) {
+								settle_usage(gpath->ginfo);
 								gpath->ginfo->usage += delta;
 								gpath = gpath->next;
 							}
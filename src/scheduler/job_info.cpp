@@ -62,6 +62,9 @@
  * 	preempt_job()
  * 	find_and_preempt_jobs()
  * 	find_jobs_to_preempt()
+ * 	new_preempt_index()
+ * 	free_preempt_index()
+ * 	preempt_candidates_by_node()
  * 	select_index_to_preempt()
  * 	preempt_level()
  * 	set_preempt_prio()
@@ -3240,6 +3243,18 @@ find_and_preempt_jobs(status *policy, int pbs_sd, resource_resv *hjob, server_in
  *        need to be preempted.  Finally we'll return the list if we found
  *        one, NULL if not.
  *
+ * @par
+ *        The candidates are the running jobs sorted by preemption priority
+ *        (or start time), cut down to the jobs running on nodes which
+ *        could satisfy a chunk of the job (see struct preempt_index and
+ *        preempt_candidates_by_node()).  The simulation runs on a dup of
+ *        the server, which is skipped when no candidate can be picked.
+ *        Candidates are not kept in per-placement-set indexes, and the
+ *        dup is not replaced by an undo log: preempting a job in the
+ *        simulation updates its nodes, queue, server, limit counts and
+ *        calendar through the same code as a real preemption, so every
+ *        one of those would have to log its changes to be rolled back.
+ *
  * @param[in]	policy		-	policy info
  * @param[in]	hjob		-	the high priority job
  * @param[in]	sinfo		-	the server of the jobs to preempt
@@ -3286,7 +3301,9 @@ find_jobs_to_preempt(status *policy, resource_resv *hjob, server_info *sinfo, in
 	resource_req *preempt_targets_req = NULL;
 	char **preempt_targets_list = NULL;
 	resource_resv **prjobs = NULL;
+	resource_resv **nrjobs = NULL;	/* the running jobs on useful nodes */
 	int rjobs_count = 0;
+	preempt_index *pidx = NULL;
 
 
 	*no_of_jobs = 0;
@@ -3403,8 +3420,35 @@ find_jobs_to_preempt(status *policy, resource_resv *hjob, server_info *sinfo, in
 		}
 	}
 
+	if ((pidx = new_preempt_index(policy)) == NULL) {
+		free_schd_error_list(full_err);
+		free(pjobs);
+		free_string_array(preempt_targets_list);
+		return NULL;
+	}
+
+	/* Duplicating the universe is expensive.  Before doing so, make sure at
+	 * least one running job can be picked.  Nothing is modified by the check,
+	 * so it is safe to run on the real universe.  The nodes it tests are
+	 * remembered in pidx and are not tested again in the duplicated universe.
+	 */
+	rjobs_subset = filter_preemptable_jobs(sinfo->running_jobs, hjob, full_err);
+	if (rjobs_subset == NULL ||
+		select_index_to_preempt(policy, hjob, rjobs_subset, 0, full_err, fail_list, pidx) == NO_JOB_FOUND) {
+		log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_INFO, hjob->name, "Found no preemptable candidates");
+		free(rjobs_subset);
+		free_preempt_index(pidx);
+		free_schd_error_list(full_err);
+		free(pjobs);
+		free_string_array(preempt_targets_list);
+		return NULL;
+	}
+	free(rjobs_subset);
+	rjobs_subset = NULL;
+
 	/* use locally dup'd copy of sinfo so we don't modify the original */
 	if ((nsinfo = dup_server_info(sinfo)) == NULL) {
+		free_preempt_index(pidx);
 		free_schd_error_list(full_err);
 		free(pjobs);
 		free_string_array(preempt_targets_list);
@@ -3459,6 +3503,15 @@ find_jobs_to_preempt(status *policy, resource_resv *hjob, server_info *sinfo, in
 		cmp_preempt_priority_asc);
 	}
 
+	/* only the jobs on nodes which could run a chunk of the job can help */
+	if ((nrjobs = preempt_candidates_by_node(pidx, nhjob, nsinfo->nodes, rjobs)) != NULL) {
+		if (count_array(nrjobs) < rjobs_count)
+			log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_JOB, LOG_DEBUG, nhjob->name,
+				"Limited running jobs used for preemption from %d to %d by node", rjobs_count, count_array(nrjobs));
+		rjobs = nrjobs;
+		rjobs_count = count_array(nrjobs);
+	}
+
 	err = dup_schd_error(full_err);	/* only first element */
 	if(err == NULL) {
 		log_err(errno, __func__, MEM_ERR_MSG);
@@ -3474,7 +3527,7 @@ find_jobs_to_preempt(status *policy, resource_resv *hjob, server_info *sinfo, in
 	}
 
 	skipto = 0;
-	while ((indexfound = select_index_to_preempt(npolicy, nhjob, rjobs_subset, skipto, err, fail_list)) != NO_JOB_FOUND) {
+	while ((indexfound = select_index_to_preempt(npolicy, nhjob, rjobs_subset, skipto, err, fail_list, pidx)) != NO_JOB_FOUND) {
 		struct preempt_ordering *po;
 		int dont_preempt_job = 0;
 		int ind = 0;
@@ -3671,14 +3724,214 @@ find_jobs_to_preempt(status *policy, resource_resv *hjob, server_info *sinfo, in
 	}
 cleanup:
 	free_server(nsinfo);
+	free_preempt_index(pidx);
 	free(pjobs);
 	free(prjobs);
+	free(nrjobs);
 	free_schd_error_list(full_err);
 	free_schd_error(err);
 
 	return pjobs_list;
 }
 
+/**
+ * @brief
+ *		create a preempt_index to be used while finding jobs to preempt
+ *		for one high priority job
+ *
+ * @param[in]	policy	-	policy info
+ *
+ * @return	preempt_index *
+ * @retval	new preempt_index
+ * @retval	NULL	: on error
+ */
+preempt_index *
+new_preempt_index(status *policy)
+{
+	preempt_index *pidx;
+	long max_resdefs = 0;
+
+	if ((pidx = static_cast<preempt_index *>(malloc(sizeof(preempt_index)))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+
+	pidx->checked_nodes = pbs_bitmap_alloc(NULL, 1);
+	pidx->useful_nodes = pbs_bitmap_alloc(NULL, 1);
+	pidx->candidates = pbs_bitmap_alloc(NULL, 1);
+	pidx->rdtc_non_consumable = NULL;
+	pidx->err = new_schd_error();
+
+	if (pidx->checked_nodes == NULL || pidx->useful_nodes == NULL ||
+		pidx->candidates == NULL || pidx->err == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free_preempt_index(pidx);
+		return NULL;
+	}
+
+	/* unsafe to consider vnodes from multivnoded hosts "no good" when "not enough" of some consumable
+	 * resource can be found in the vnode, since rest may be provided by other vnodes on the same host
+	 * restrict check on these vnodes to check only against non consumable resources
+	 */
+	if (policy != NULL)
+		max_resdefs = count_array(policy->resdef_to_check);
+
+	if (max_resdefs > 0) {
+		pidx->rdtc_non_consumable = static_cast<resdef **>(calloc((size_t) max_resdefs + 1, sizeof(resdef *)));
+		if (pidx->rdtc_non_consumable != NULL) {
+			long resdef_index;
+			long rdtc_nc_index = 0;
+			for (resdef_index = 0; policy->resdef_to_check[resdef_index] != NULL; resdef_index++) {
+				if (policy->resdef_to_check[resdef_index]->type.is_non_consumable)
+					pidx->rdtc_non_consumable[rdtc_nc_index++] = policy->resdef_to_check[resdef_index];
+			}
+			pidx->rdtc_non_consumable[rdtc_nc_index] = NULL;
+		}
+	}
+
+	return pidx;
+}
+
+/**
+ * @brief
+ *		free a preempt_index
+ *
+ * @param[in]	pidx	-	preempt_index to free
+ *
+ * @return	nothing
+ */
+void
+free_preempt_index(preempt_index *pidx)
+{
+	if (pidx == NULL)
+		return;
+
+	pbs_bitmap_free(pidx->checked_nodes);
+	pbs_bitmap_free(pidx->useful_nodes);
+	pbs_bitmap_free(pidx->candidates);
+	free(pidx->rdtc_non_consumable);
+	free_schd_error(pidx->err);
+	free(pidx);
+}
+
+/**
+ * @brief
+ *		can a node satisfy at least one chunk of the high priority job
+ *		if the work on it was preempted.  The answer only depends on the
+ *		total resources of the node, so it is remembered in the index.
+ *		Nodes which are not server nodes (e.g., reservation nodes) are
+ *		not remembered since they share a node_ind with the server node.
+ *
+ * @param[in,out]	pidx	-	preempt index
+ * @param[in]	hjob	-	the high priority job
+ * @param[in]	node	-	the node to check
+ *
+ * @return	int
+ * @retval	1	: node is useful
+ * @retval	0	: node is not useful
+ */
+static int
+preempt_node_is_useful(preempt_index *pidx, resource_resv *hjob, node_info *node)
+{
+	int memo;
+	int useful = 0;
+	int k;
+	resdef **rdtc_here = NULL;	/* at first assume all resources (including consumables) need to be checked */
+
+	memo = (node->node_ind != -1 && node->svr_node == NULL);
+	if (memo && pbs_bitmap_get_bit(pidx->checked_nodes, node->node_ind))
+		return pbs_bitmap_get_bit(pidx->useful_nodes, node->node_ind);
+
+	if (node->is_multivnoded)
+		rdtc_here = pidx->rdtc_non_consumable;
+
+	for (k = 0; hjob->select->chunks[k] != NULL; k++) {
+		long num_chunks_returned;
+		/* if only non consumables are checked, infinite number of chunks can be satisfied,
+		 * and SCHD_INFINITY is negative, so don't be tempted to check on positive value
+		 */
+		clear_schd_error(pidx->err);
+		num_chunks_returned = check_avail_resources(node->res, hjob->select->chunks[k]->req,
+					COMPARE_TOTAL | CHECK_ALL_BOOLS | UNSET_RES_ZERO,
+					rdtc_here, INSUFFICIENT_RESOURCE, pidx->err);
+		if ((num_chunks_returned > 0) || (num_chunks_returned == SCHD_INFINITY)) {
+			useful = 1;
+			break;
+		}
+	}
+
+	if (memo) {
+		pbs_bitmap_bit_on(pidx->checked_nodes, node->node_ind);
+		if (useful)
+			pbs_bitmap_bit_on(pidx->useful_nodes, node->node_ind);
+	}
+
+	return useful;
+}
+
+/**
+ * @brief
+ *		find the preemption candidates for a high priority job through
+ *		the nodes rather than through every running job.  The jobs on
+ *		each node which could satisfy a chunk of the job (its job_arr)
+ *		are marked, and the candidates are cut down to the marked ones,
+ *		keeping their order.
+ *
+ * @par
+ *		select_index_to_preempt() never picks a job with no useful node,
+ *		so this only drops candidates it would skip anyway, once, rather
+ *		than on every pass over them.  Jobs in reservations are on the
+ *		job_arr of the reservation's nodes, not the server's, so they are
+ *		kept, as are jobs with no index in the universe.
+ *
+ * @param[in,out]	pidx	-	preempt index
+ * @param[in]	hjob	-	the high priority job
+ * @param[in]	nodes	-	the server's nodes
+ * @param[in]	rjobs	-	candidates, in preemption order
+ *
+ * @return	resource_resv **
+ * @retval	the candidates running on a useful node, in preemption order
+ * @retval	NULL	: on error
+ * @par NOTE:	returned array is allocated with malloc() --  needs freeing
+ */
+resource_resv **
+preempt_candidates_by_node(preempt_index *pidx, resource_resv *hjob, node_info **nodes, resource_resv **rjobs)
+{
+	resource_resv **cands;
+	int i;
+	int j;
+
+	if (pidx == NULL || hjob == NULL || nodes == NULL || rjobs == NULL)
+		return NULL;
+
+	if ((cands = static_cast<resource_resv **>(malloc((count_array(rjobs) + 1) * sizeof(resource_resv *)))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+
+	for (i = pbs_bitmap_first_on_bit(pidx->candidates); i >= 0; i = pbs_bitmap_next_on_bit(pidx->candidates, i))
+		pbs_bitmap_bit_off(pidx->candidates, i);
+	for (i = 0; nodes[i] != NULL; i++) {
+		if (nodes[i]->job_arr == NULL || nodes[i]->job_arr[0] == NULL)
+			continue;
+		if (!preempt_node_is_useful(pidx, hjob, nodes[i]))
+			continue;
+		for (j = 0; nodes[i]->job_arr[j] != NULL; j++) {
+			if (nodes[i]->job_arr[j]->resresv_ind >= 0)
+				pbs_bitmap_bit_on(pidx->candidates, nodes[i]->job_arr[j]->resresv_ind);
+		}
+	}
+
+	for (i = 0, j = 0; rjobs[i] != NULL; i++) {
+		if (rjobs[i]->resresv_ind < 0 || rjobs[i]->job->resv != NULL ||
+			pbs_bitmap_get_bit(pidx->candidates, rjobs[i]->resresv_ind))
+			cands[j++] = rjobs[i];
+	}
+	cands[j] = NULL;
+
+	return cands;
+}
+
 /**
  * @brief
  *		select a good candidate for preemption
@@ -3690,6 +3943,7 @@ cleanup:
  * @param[in] err    - reason the high prio job isn't running
  * @param[in] fail_list - list of jobs to skip. They previously failed to be preempted.
  *			  Do not select them again.
+ * @param[in,out] pidx - index of nodes already tested against hjob
  *
  * @return long
  * @retval index of the job to preempt
@@ -3699,15 +3953,14 @@ cleanup:
 long
 select_index_to_preempt(status *policy, resource_resv *hjob,
 	resource_resv **rjobs, long skipto, schd_error *err,
-	int *fail_list)
+	int *fail_list, preempt_index *pidx)
 {
-	int i, j, k;
+	int i, j;
 	int good = 1;		/* good boolean: Is job eligible to be preempted */
 	struct preempt_ordering *po;
-	resdef **rdtc_non_consumable = NULL;
 
 	if ( err == NULL || hjob == NULL || hjob->job == NULL ||
-		rjobs == NULL || rjobs[0] == NULL)
+		rjobs == NULL || rjobs[0] == NULL || pidx == NULL)
 		return NO_JOB_FOUND;
 
 	/* This shouldn't happen, but you can never be too paranoid */
@@ -3809,60 +4062,9 @@ select_index_to_preempt(status *policy, resource_resv *hjob,
 			}
 		}
 		if (good) {
-			schd_error *err;
 			node_good = 0;
-
-			err = new_schd_error();
-			if(err == NULL)
-				return NO_JOB_FOUND;
-
-			for (j = 0; rjobs[i]->ninfo_arr[j] != NULL && !node_good; j++) {
-				resdef **rdtc_here = NULL; /* at first assume all resources (including consumables) need to be checked */
-				node_info *node = rjobs[i]->ninfo_arr[j];
-				if (node->is_multivnoded) {
-					/* unsafe to consider vnodes from multivnoded hosts "no good" when "not enough" of some consumable
-					 * resource can be found in the vnode, since rest may be provided by other vnodes on the same host
-					 * restrict check on these vnodes to check only against non consumable resources
-					 */
-					if (rdtc_non_consumable == NULL) {
-						long max_resdefs = 0;
-						if (policy != NULL)
-							max_resdefs = count_array(policy->resdef_to_check);
-
-						if (max_resdefs > 0)    {
-							rdtc_non_consumable = static_cast<resdef **>(calloc(sizeof(resdef *),(size_t) max_resdefs + 1));
-							if (rdtc_non_consumable != NULL) {
-								long resdef_index = 0;
-								long rdtc_nc_index = 0;
-								for (; policy->resdef_to_check[resdef_index] != NULL; resdef_index++) {
-									if (policy->resdef_to_check[resdef_index]->type.is_non_consumable) {
-										rdtc_non_consumable[rdtc_nc_index] = policy->resdef_to_check[resdef_index];
-										rdtc_nc_index++;
-									}
-									rdtc_non_consumable[rdtc_nc_index] = NULL;
-								}
-							}
-						}
-					}
-					rdtc_here = rdtc_non_consumable;
-				}
-				for (k = 0; hjob->select->chunks[k] != NULL; k++) {
-					long num_chunks_returned = 0;
-					/* if only non consumables are checked, infinite number of chunks can be satisfied,
-					 * and SCHD_INFINITY is negative, so don't be tempted to check on positive value
-					 */
-					clear_schd_error(err);
-					num_chunks_returned = check_avail_resources(node->res, hjob->select->chunks[k]->req,
-								COMPARE_TOTAL | CHECK_ALL_BOOLS | UNSET_RES_ZERO,
-								rdtc_here, INSUFFICIENT_RESOURCE, err);
-					if ( (num_chunks_returned > 0) || (num_chunks_returned == SCHD_INFINITY) ) {
-						node_good = 1;
-						break;
-					}
-
-				}
-			}
-			free_schd_error(err);
+			for (j = 0; rjobs[i]->ninfo_arr[j] != NULL && !node_good; j++)
+				node_good = preempt_node_is_useful(pidx, hjob, rjobs[i]->ninfo_arr[j]);
 		}
 
 		if (node_good == 0)
@@ -3872,9 +4074,6 @@ select_index_to_preempt(status *policy, resource_resv *hjob,
 		if (good)
 			break;
 	}
-	if (rdtc_non_consumable != NULL)
-		free (rdtc_non_consumable);
-
 	if (good && rjobs[i] != NULL)
 		return i;
 
@@ -4389,9 +4588,9 @@ formula_evaluate(char *formula, resource_resv *resresv, resource_req *resreq)
 		FORMULA_JOB_PRIO, resresv->job->priority,
 		FORMULA_FSPERC, resresv->job->ginfo->tree_percentage,
 		FORMULA_FSPERC_DEP, resresv->job->ginfo->tree_percentage,
-		FORMULA_TREE_USAGE, resresv->job->ginfo->usage_factor,
+		FORMULA_TREE_USAGE, get_usage_factor(resresv->job->ginfo),
 		FORMULA_FSFACTOR, resresv->job->ginfo->tree_percentage == 0 ? 0 :
-			pow(2, -(resresv->job->ginfo->usage_factor/resresv->job->ginfo->tree_percentage)),
+			pow(2, -(get_usage_factor(resresv->job->ginfo)/resresv->job->ginfo->tree_percentage)),
 		FORMULA_ACCRUE_TYPE, resresv -> job -> accrue_type);
 	if (pbs_strcat(&globals, &globals_size, buf) == NULL) {
 		free(globals);
@@ -166,7 +166,26 @@ find_jobs_to_preempt(status *policy, resource_resv *jinfo,
 long
 select_index_to_preempt(status *policy, resource_resv *hjob,
 	resource_resv **rjobs, long skipto, schd_error *err,
-	int *fail_list);
+	int *fail_list, preempt_index *pidx);
+
+/*
+ *      new_preempt_index - create an index of nodes tested while finding
+ *                          jobs to preempt for a high priority job
+ */
+preempt_index *new_preempt_index(status *policy);
+
+/*
+ *      free_preempt_index - free a preempt_index
+ */
+void free_preempt_index(preempt_index *pidx);
+
+/*
+ *      preempt_candidates_by_node - the running jobs of the nodes which
+ *                                   could satisfy a chunk of a high
+ *                                   priority job
+ */
+resource_resv **preempt_candidates_by_node(preempt_index *pidx, resource_resv *hjob,
+	node_info **nodes, resource_resv **rjobs);
 
 /*
  *      preempt_level - take a preemption priority and return a preemption
@@ -263,8 +263,10 @@ main(int argc, char *argv[])
 			testp = argv[optind + 1];
 			val = strtod(testp, &endp);
 
-			if (*endp == '\0')
+			if (*endp == '\0') {
+				settle_usage(ginfo);
 				ginfo->usage = val;
+			}
 		}
 	}
 
@@ -291,6 +293,10 @@ static void
 print_fairshare_entity(group_info *ginfo)
 {
 	struct group_path *gp;
+
+	for (gp = ginfo->gpath; gp != NULL; gp = gp->next)
+		settle_usage(gp->ginfo);
+
 	printf(
 		"fairshare entity: %s\n"
 		"Resgroup		: %d\n"
@@ -305,7 +311,7 @@ print_fairshare_entity(group_info *ginfo)
 		ginfo->cresgroup,
 		ginfo->shares,
 		ginfo->tree_percentage * 100,
-		ginfo->usage_factor,
+		get_usage_factor(ginfo),
 		ginfo->usage, conf.fairshare_res,
 		ginfo->tree_percentage == 0 ? -1 : ginfo->usage / ginfo->tree_percentage);
 
@@ -336,6 +342,7 @@ print_fairshare(group_info *root, int level)
 	if (root == NULL)
 		return;
 
+	settle_usage(root);
 	if (level < 0) {
 		printf(
 			"%-10s: Grp: %-5d  cgrp: %-5d"
@@ -156,13 +156,12 @@ grow_acct_buf(char **pb, int *avail, int need)
 static void
 sum_resc_alloc(const job *pjob, pbs_list_head *list)
 {
-	char	  *chunk;
 	char	  *exechost;
 	int        i;
 	int        j;
-	int        nelem;
-	char	  *noden;
-	struct key_value_pair *pkvp;
+	int        k;
+	exec_vnode_cache  *pevn;
+	exec_vnode_chunk  *pch;
 	resource          *presc;
 	struct pbsnode    *pnode;
 	int	           rc;
@@ -195,57 +194,50 @@ sum_resc_alloc(const job *pjob, pbs_list_head *list)
 	/* now, go through the exec_vnode specified for the job, for any       */
 	/* resource that matches an entry in the table, set the pointer and set flag */
 
-	chunk = parse_plus_spec(exechost, &rc);
-	if (rc != 0)
+	pevn = job_exec_vnode((job *)pjob, exechost);
+	if (pevn == NULL)
 		return;
-	while (chunk) {
-		if (parse_node_resc(chunk, &noden, &nelem, &pkvp) == 0) {
+	for (k = 0; k < pevn->evn_nchunk; k++) {
+		pch = &pevn->evn_chunk[k];
 
-			/* find if node is shared or excl */
+		/* find if node is shared or excl */
 
-			pnode = find_nodebyname(noden);
-			if (pnode) {
-				if ((pnode->nd_state & INUSE_JOBEXCL) == 0) {
+		pnode = pch->ec_pnode;
+		if (pnode) {
+			if ((pnode->nd_state & INUSE_JOBEXCL) == 0) {
 
-					/* shared, record only what was requested from the vnode */
+				/* shared, record only what was requested from the vnode */
 
-					for (j=0; j<nelem; ++j) {
-						for (i=0; svr_resc_sum[i].rs_def; ++i) {
-							if (strcmp(svr_resc_sum[i].rs_def->rs_name, pkvp[j].kv_keyw) == 0) {
-								/* incr sum by amount requested by user */
-								rc = svr_resc_sum[i].rs_def->rs_decode(&tmpatr,
-									0, 0, pkvp[j].kv_val);
-								if (rc != 0)
-									return;
-								(void)svr_resc_sum[i].rs_def->rs_set(&svr_resc_sum[i].rs_attr, &tmpatr, INCR);
+				for (j=0; j<pch->ec_nresc; ++j) {
+					for (i=0; svr_resc_sum[i].rs_def; ++i) {
+						if (svr_resc_sum[i].rs_def == pch->ec_resc[j].er_def) {
+							/* incr sum by amount requested by user */
+							rc = svr_resc_sum[i].rs_def->rs_decode(&tmpatr,
+								0, 0, pch->ec_resc[j].er_val);
+							if (rc != 0)
+								return;
+							(void)svr_resc_sum[i].rs_def->rs_set(&svr_resc_sum[i].rs_attr, &tmpatr, INCR);
 
-								svr_resc_sum[i].rs_set = 1;
-							}
+							svr_resc_sum[i].rs_set = 1;
 						}
 					}
+				}
 
-				} else if (pnode->nd_accted == 0) {
+			} else if (pnode->nd_accted == 0) {
 
-					/* vnode used exclusively and not already accounted, */
-					/* so incr sum by amount in whole vnode              */
+				/* vnode used exclusively and not already accounted, */
+				/* so incr sum by amount in whole vnode              */
 
-					pnode->nd_accted = 1;  /* mark that it has been recorded */
-					for (i=0; svr_resc_sum[i].rs_def; ++i) {
-						presc = find_resc_entry(&pnode->nd_attr[ND_ATR_ResourceAvail], svr_resc_sum[i].rs_def);
-						if (presc && (is_attr_set(&presc->rs_value))) {
-							(void)svr_resc_sum[i].rs_def->rs_set(&svr_resc_sum[i].rs_attr, &presc->rs_value, INCR);
-							svr_resc_sum[i].rs_set = 1;
-						}
+				pnode->nd_accted = 1;  /* mark that it has been recorded */
+				for (i=0; svr_resc_sum[i].rs_def; ++i) {
+					presc = find_resc_entry(&pnode->nd_attr[ND_ATR_ResourceAvail], svr_resc_sum[i].rs_def);
+					if (presc && (is_attr_set(&presc->rs_value))) {
+						(void)svr_resc_sum[i].rs_def->rs_set(&svr_resc_sum[i].rs_attr, &presc->rs_value, INCR);
+						svr_resc_sum[i].rs_set = 1;
 					}
 				}
 			}
-
-		} else {
-			return;
 		}
-		chunk = parse_plus_spec(NULL, &rc);
-		if (rc != 0)
-			return;
 	}
 
 	for (i=0; svr_resc_sum[i].rs_def != NULL; ++i) {
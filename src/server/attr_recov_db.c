@@ -169,6 +169,7 @@ encode_attr_db(struct attribute_def *padef, struct attribute *pattr, int numattr
  * @param[in/out] pattr - Address of the parent objects attribute array
  * @param[in]	  limit - Number of attributes in the list
  * @param[in]	  unknown	- The index of the unknown attribute if any
+ * @param[in]	  actions	- Whether to run the ATR_ACTION_RECOV action functions
  *
  * @return      Error code
  * @retval	 0  - Success
@@ -176,8 +177,8 @@ encode_attr_db(struct attribute_def *padef, struct attribute *pattr, int numattr
  *
  *
  */
-int
-decode_attr_db(void *parent, pbs_db_attr_list_t *db_attr_list, void *padef_idx, struct attribute_def *padef, struct attribute *pattr, int limit, int unknown)
+static int
+decode_attr_db_ex(void *parent, pbs_db_attr_list_t *db_attr_list, void *padef_idx, struct attribute_def *padef, struct attribute *pattr, int limit, int unknown, int actions)
 {
 	int index;
 	svrattrl *pal = (svrattrl *)0;
@@ -268,7 +269,7 @@ decode_attr_db(void *parent, pbs_db_attr_list_t *db_attr_list, void *padef_idx,
 				if (padef[index].at_decode) {
 					int act_rc = 0;
 					padef[index].at_decode(&pattr[index], pal->al_name, pal->al_resc, pal->al_value);
-					if (padef[index].at_action)
+					if (actions && padef[index].at_action)
 						if ((act_rc = (padef[index].at_action(&pattr[index], parent, ATR_ACTION_RECOV)))) {
 							log_errf(act_rc, __func__, "Action function failed for %s attr, errn %d", (padef+index)->at_name, act_rc);
 							for ( index++; index <= limit; index++) {
@@ -298,3 +299,74 @@ decode_attr_db(void *parent, pbs_db_attr_list_t *db_attr_list, void *padef_idx,
 
 	return 0;
 }
+
+/**
+ * @brief
+ *	Decode the list of attributes from the database to the regular attribute
+ *	structure, running the recovery action function of each attribute
+ *
+ * @see decode_attr_db_ex
+ *
+ * @return      Error code
+ * @retval	 0  - Success
+ * @retval	-1  - Failure
+ *
+ */
+int
+decode_attr_db(void *parent, pbs_db_attr_list_t *db_attr_list, void *padef_idx, struct attribute_def *padef, struct attribute *pattr, int limit, int unknown)
+{
+	return (decode_attr_db_ex(parent, db_attr_list, padef_idx, padef, pattr, limit, unknown, 1));
+}
+
+/**
+ * @brief
+ *	Decode the list of attributes from the database without running any
+ *	action function. Action functions may touch server wide state, this
+ *	variant only writes to the attributes of the parent and so may be used
+ *	from several threads on different parents. The actions are run later
+ *	with recov_attr_db_actions().
+ *
+ * @see decode_attr_db_ex
+ *
+ * @return      Error code
+ * @retval	 0  - Success
+ * @retval	-1  - Failure
+ *
+ */
+int
+decode_attr_db_noact(void *parent, pbs_db_attr_list_t *db_attr_list, void *padef_idx, struct attribute_def *padef, struct attribute *pattr, int limit, int unknown)
+{
+	return (decode_attr_db_ex(parent, db_attr_list, padef_idx, padef, pattr, limit, unknown, 0));
+}
+
+/**
+ * @brief
+ *	Run the ATR_ACTION_RECOV action function of every set attribute of an
+ *	object decoded with decode_attr_db_noact(), in attribute index order
+ *
+ * @param[in]	  parent - pointer to parent object
+ * @param[in]	  padef - Address of parent's attribute definition array
+ * @param[in/out] pattr - Address of the parent objects attribute array
+ * @param[in]	  limit - Number of attributes in the array
+ *
+ * @return      Error code
+ * @retval	 0  - Success
+ * @retval	-1  - An action function failed
+ *
+ */
+int
+recov_attr_db_actions(void *parent, struct attribute_def *padef, struct attribute *pattr, int limit)
+{
+	int index;
+	int act_rc;
+
+	for (index = 0; index < limit; index++) {
+		if (padef[index].at_action == NULL || !(pattr[index].at_flags & ATR_VFLAG_SET))
+			continue;
+		if ((act_rc = padef[index].at_action(&pattr[index], parent, ATR_ACTION_RECOV))) {
+			log_errf(act_rc, __func__, "Action function failed for %s attr, errn %d", padef[index].at_name, act_rc);
+			return -1;
+		}
+	}
+	return 0;
+}
@@ -50,6 +50,51 @@
 #include "pbs_error.h"
 
 
+#ifndef PBS_MOM
+/**
+ * @brief	Get a job attribute to read, from the few a frozen history job
+ *		keeps decoded or else from the thawed job, see job_freeze()
+ *
+ * @param[in]	pjob - pointer to the job
+ * @param[in]	attr_idx - index of the attribute
+ *
+ * @return	attribute *
+ */
+static attribute *
+jattr_for_read(const job *pjob, int attr_idx)
+{
+	attribute *pattr;
+
+	if (pjob->ji_frozen != NULL) {
+		if ((pattr = get_frozen_jattr(pjob->ji_frozen, attr_idx)) != NULL)
+			return pattr;
+		(void)job_thaw((job *)pjob);
+	}
+	return &pjob->ji_wattr[attr_idx];
+}
+
+/**
+ * @brief	Thaw a frozen history job before one of its attributes is
+ *		changed, see job_freeze()
+ *
+ * @param[in]	pjob - pointer to the job
+ *
+ * @return	int
+ * @retval	0 the attributes can be written
+ * @retval	1 the job is still frozen
+ */
+static int
+jattr_for_write(job *pjob)
+{
+	if (pjob->ji_frozen != NULL)
+		(void)job_thaw(pjob);
+	return (pjob->ji_frozen != NULL);
+}
+#else
+#define jattr_for_read(pjob, attr_idx) ((attribute *)&(pjob)->ji_wattr[attr_idx])
+#define jattr_for_write(pjob) 0
+#endif
+
 
 /**
  * @brief	Check if the job is in the state specified
@@ -108,7 +153,7 @@ char
 get_job_state(const job *pjob)
 {
 	if (pjob != NULL) {
-		return get_attr_c(&pjob->ji_wattr[JOB_ATR_state]);
+		return get_attr_c(jattr_for_read(pjob, JOB_ATR_state));
 	}
 
 	return -1;
@@ -132,7 +177,7 @@ get_job_state_num(const job *pjob)
 	if (pjob == NULL)
 		return -1;
 
-	statec = get_attr_c(&pjob->ji_wattr[JOB_ATR_state]);
+	statec = get_attr_c(jattr_for_read(pjob, JOB_ATR_state));
 	if (statec == -1)
 		return -1;
 
@@ -154,12 +199,31 @@ long
 get_job_substate(const job *pjob)
 {
 	if (pjob != NULL) {
-		return get_attr_l(&pjob->ji_wattr[JOB_ATR_substate]);
+		return get_attr_l(jattr_for_read(pjob, JOB_ATR_substate));
 	}
 
 	return -1;
 }
 
+/**
+ * @brief	Getter function for a job attribute, to be read only
+ *
+ * @param[in]	pjob - pointer to the job
+ * @param[in]	attr_idx - index of the attribute to return
+ *
+ * @return	attribute *
+ * @retval	attribute
+ * @retval	NULL if pjob is NULL
+ */
+attribute *
+get_jattr(const job *pjob, int attr_idx)
+{
+	if (pjob != NULL)
+		return jattr_for_read(pjob, attr_idx);
+
+	return NULL;
+}
+
 /**
  * @brief	Getter function for job attribute of type string
  *
@@ -174,7 +238,7 @@ char *
 get_jattr_str(const job *pjob, int attr_idx)
 {
 	if (pjob != NULL)
-		return pjob->ji_wattr[attr_idx].at_val.at_str;
+		return jattr_for_read(pjob, attr_idx)->at_val.at_str;
 
 	return NULL;
 }
@@ -193,7 +257,7 @@ long
 get_jattr_long(const job *pjob, int attr_idx)
 {
 	if (pjob != NULL)
-		return pjob->ji_wattr[attr_idx].at_val.at_long;
+		return jattr_for_read(pjob, attr_idx)->at_val.at_long;
 
 	return -1;
 }
@@ -212,7 +276,7 @@ svrattrl *
 get_jattr_usr_encoded(const job *pjob, int attr_idx)
 {
 	if (pjob != NULL)
-		return pjob->ji_wattr[attr_idx].at_user_encoded;
+		return get_attr_usr_encoded(jattr_for_read(pjob, attr_idx));
 
 	return NULL;
 }
@@ -231,7 +295,7 @@ svrattrl *
 get_jattr_priv_encoded(const job *pjob, int attr_idx)
 {
 	if (pjob != NULL)
-		return pjob->ji_wattr[attr_idx].at_priv_encoded;
+		return get_attr_priv_encoded(jattr_for_read(pjob, attr_idx));
 
 	return NULL;
 }
@@ -247,7 +311,10 @@ get_jattr_priv_encoded(const job *pjob, int attr_idx)
 void
 set_job_state(job *pjob, char val)
 {
-	if (pjob != NULL) {
+	if (pjob != NULL && !jattr_for_write(pjob)) {
+#ifndef PBS_MOM
+		update_job_state_index(pjob, val);
+#endif
 		set_attr_c(&pjob->ji_wattr[JOB_ATR_state], val, SET);
 	}
 }
@@ -283,7 +350,7 @@ set_job_substate(job *pjob, long val)
 int
 set_jattr_generic(job *pjob, int attr_idx, char *val, char *rscn, enum batch_op op)
 {
-	if (pjob == NULL || val == NULL)
+	if (pjob == NULL || val == NULL || jattr_for_write(pjob))
 		return 1;
 
 	return set_attr_generic(&pjob->ji_wattr[attr_idx], &job_attr_def[attr_idx], val, rscn, op);
@@ -304,7 +371,7 @@ set_jattr_generic(job *pjob, int attr_idx, char *val, char *rscn, enum batch_op
 int
 set_jattr_str_slim(job *pjob, int attr_idx, char *val, char *rscn)
 {
-	if (pjob == NULL || val == NULL)
+	if (pjob == NULL || val == NULL || jattr_for_write(pjob))
 		return 1;
 
 	return set_attr_generic(&pjob->ji_wattr[attr_idx], &job_attr_def[attr_idx], val, rscn, INTERNAL);
@@ -325,7 +392,7 @@ set_jattr_str_slim(job *pjob, int attr_idx, char *val, char *rscn)
 int
 set_jattr_l_slim(job *pjob, int attr_idx, long val, enum batch_op op)
 {
-	if (pjob == NULL)
+	if (pjob == NULL || jattr_for_write(pjob))
 		return 1;
 
 	set_attr_l(&pjob->ji_wattr[attr_idx], val, op);
@@ -348,7 +415,7 @@ set_jattr_l_slim(job *pjob, int attr_idx, long val, enum batch_op op)
 int
 set_jattr_b_slim(job *pjob, int attr_idx, long val, enum batch_op op)
 {
-	if (pjob == NULL)
+	if (pjob == NULL || jattr_for_write(pjob))
 		return 1;
 
 	set_attr_b(&pjob->ji_wattr[attr_idx], val, op);
@@ -371,7 +438,7 @@ set_jattr_b_slim(job *pjob, int attr_idx, long val, enum batch_op op)
 int
 set_jattr_c_slim(job *pjob, int attr_idx, char val, enum batch_op op)
 {
-	if (pjob == NULL)
+	if (pjob == NULL || jattr_for_write(pjob))
 		return 1;
 
 	set_attr_c(&pjob->ji_wattr[attr_idx], val, op);
@@ -394,7 +461,7 @@ int
 is_jattr_set(const job *pjob, int attr_idx)
 {
 	if (pjob != NULL)
-		return pjob->ji_wattr[attr_idx].at_flags & ATR_VFLAG_SET;
+		return jattr_for_read(pjob, attr_idx)->at_flags & ATR_VFLAG_SET;
 
 	return 0;
 }
@@ -410,7 +477,7 @@ is_jattr_set(const job *pjob, int attr_idx)
 void
 mark_jattr_not_set(job *pjob, int attr_idx)
 {
-	if (pjob != NULL)
+	if (pjob != NULL && !jattr_for_write(pjob))
 		pjob->ji_wattr[attr_idx].at_flags &= ~ATR_VFLAG_SET;
 }
 
@@ -425,7 +492,7 @@ mark_jattr_not_set(job *pjob, int attr_idx)
 void
 mark_jattr_set(job *pjob, int attr_idx)
 {
-	if (pjob != NULL)
+	if (pjob != NULL && !jattr_for_write(pjob))
 		pjob->ji_wattr[attr_idx].at_flags |= ATR_VFLAG_SET;
 }
 
@@ -440,6 +507,6 @@ mark_jattr_set(job *pjob, int attr_idx)
 void
 free_jattr(job *pjob, int attr_idx)
 {
-	if (pjob != NULL)
+	if (pjob != NULL && !jattr_for_write(pjob))
 		job_attr_def[attr_idx].at_free(&pjob->ji_wattr[attr_idx]);
 }
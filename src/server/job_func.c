@@ -117,6 +117,7 @@ static void post_resv_purge(struct work_task *pwt);
 /* Global Data items */
 #ifndef PBS_MOM
 extern struct server   server;
+extern void *svr_history_heap;
 #endif	/* PBS_MOM */
 extern char *msg_abt_err;
 extern char *path_jobs;
@@ -306,15 +307,28 @@ job_alloc(void)
 		return NULL;
 	}
 	(void)memset((char *)pj, (int)0, (size_t)sizeof(job));
+#ifndef PBS_MOM
+	pj->ji_wattr = (attribute *)malloc(JOB_ATR_LAST * sizeof(attribute));
+	if (pj->ji_wattr == NULL) {
+		log_err(errno, __func__, "no memory");
+		free(pj);
+		return NULL;
+	}
+#endif
 
 	CLEAR_LINK(pj->ji_alljobs);
 	CLEAR_LINK(pj->ji_jobque);
 	CLEAR_LINK(pj->ji_unlicjobs);
+	CLEAR_LINK(pj->ji_statejobs);
+	CLEAR_LINK(pj->ji_ownerjobs);
+	CLEAR_LINK(pj->ji_dirtyjobs);
+	CLEAR_HEAP_ENTRY(pj->ji_histheap);
 
 	pj->ji_rerun_preq = NULL;
 
 #ifdef	PBS_MOM
 	CLEAR_HEAD(pj->ji_tasks);
+	CLEAR_HEAD(pj->ji_ruu_sent);
 	CLEAR_HEAD(pj->ji_failed_node_list);
 	CLEAR_HEAD(pj->ji_node_list);
 	pj->ji_taskid = TM_INIT_TASK;
@@ -504,14 +518,27 @@ job_free(job *pj)
 
 	/* remove any malloc working attribute space */
 
+#ifndef PBS_MOM
+	if (pj->ji_frozen != NULL)
+		discard_frozen_job(pj);
+	else {
+		for (i = 0; i < (int)JOB_ATR_LAST; i++)
+			free_jattr(pj, i);
+		free(pj->ji_wattr);
+	}
+#else
 	for (i = 0; i < (int)JOB_ATR_LAST; i++)
 		free_jattr(pj, i);
+#endif
 
 #ifndef PBS_MOM
 	{
 		/* Server only */
 		badplace		*bp;
 
+		delete_link(&pj->ji_dirtyjobs);
+		if (IN_HEAP(pj->ji_histheap))
+			pbs_heap_delete(svr_history_heap, &pj->ji_histheap);
 		free_job_work_tasks(pj);
 
 		/* free any bad destination structs */
@@ -539,6 +566,8 @@ job_free(job *pj)
 		free(pj->ji_script);
 	if (pj->ji_prov_startjob_task)
 		delete_task(pj->ji_prov_startjob_task);
+	free_status_cache(pj->ji_stcache);
+	free_exec_vnode(pj->ji_execvn);
 
 #else	/* PBS_MOM  Mom Only */
 
@@ -1030,6 +1059,13 @@ job_purge(job *pjob)
 		pjob->ji_rerun_preq = NULL;
 	}
 #ifndef PBS_MOM
+	/*
+	 * A frozen history job keeps decoded what purging it reads, its state
+	 * and owner, so it is purged as it is.  Only nodes it still holds need
+	 * its attributes read back to be freed.
+	 */
+	if (pjob->ji_frozen != NULL && (pjob->ji_qs.ji_svrflags & JOB_SVFLG_HasNodes))
+		(void)job_thaw(pjob);
 	if (pjob->ji_pmt_preq != NULL) {
 		log_joberr(PBSE_INTERNAL, __func__, "preempt request outstanding",
 			   pjob->ji_qs.ji_jobid);
@@ -1042,6 +1078,7 @@ job_purge(job *pjob)
 		send_resc_used(x->ru_cmd, 1, x);
 		FREE_RUU(x);
 	}
+	free_attrlist(&pjob->ji_ruu_sent);
 	delete_link(&pjob->ji_jobque);
 	delete_link(&pjob->ji_alljobs);
 	delete_link(&pjob->ji_unlicjobs);
@@ -1210,13 +1247,16 @@ job_purge(job *pjob)
 #endif
 
 #else
-	/* delete job and dependants from database */
-	obj.pbs_db_obj_type = PBS_DB_JOB;
-	obj.pbs_db_un.pbs_db_job = &dbjob;
-	strcpy(dbjob.ji_jobid, pjob->ji_qs.ji_jobid);
-	if (pbs_db_delete_obj(conn, &obj) == -1) {
-		log_joberr(-1, __func__, msg_err_purgejob_db,
-			pjob->ji_qs.ji_jobid);
+	/* delete job and dependants from database, batched with other saves */
+	delete_link(&pjob->ji_dirtyjobs);
+	if (defer_job_delete(pjob->ji_qs.ji_jobid) != 0) {
+		obj.pbs_db_obj_type = PBS_DB_JOB;
+		obj.pbs_db_un.pbs_db_job = &dbjob;
+		strcpy(dbjob.ji_jobid, pjob->ji_qs.ji_jobid);
+		if (pbs_db_delete_obj(conn, &obj) == -1) {
+			log_joberr(-1, __func__, msg_err_purgejob_db,
+				pjob->ji_qs.ji_jobid);
+		}
 	}
 
 	if (pjob->ji_qs.ji_svrflags & JOB_SVFLG_HasNodes)
@@ -1246,7 +1286,32 @@ job_purge(job *pjob)
 
 /**
  * @brief
- * 		find_job() - find job by jobid
+ * 		find_job() - find job by jobid, see find_job_nothaw().  A frozen
+ *		history job is thawed, since the caller may look at any of its
+ *		attributes.
+ *
+ * @param[in]	jobid - job ID string.
+ *
+ * @return	pointer to job struct
+ * @retval NULL	- if job by jobid not found.
+ */
+job *
+find_job(char *jobid)
+{
+	job *pj;
+
+	pj = find_job_nothaw(jobid);
+#ifndef PBS_MOM
+	if (pj != NULL && pj->ji_frozen != NULL)
+		(void)job_thaw(pj);
+#endif
+	return pj;
+}
+
+/**
+ * @brief
+ * 		find_job_nothaw() - find job by jobid, leaving a frozen history
+ *		job frozen, see job_freeze()
  *
  *		Search list of all server jobs for one with same job id
  *		Return NULL if not found or pointer to job struct if found.
@@ -1266,7 +1331,7 @@ job_purge(job *pjob)
  */
 
 job *
-find_job(char *jobid)
+find_job_nothaw(char *jobid)
 {
 #ifndef PBS_MOM
 	size_t len;
@@ -1564,6 +1629,7 @@ update_resources_list(job *pjob, char *res_list_name,
 
 		}
 
+		free_resc_index(&pjob->ji_wattr[res_list_index]);
 		pr = (resource *)GET_NEXT(pjob->ji_wattr[res_list_index].at_val.at_list);
 		while (pr != NULL) {
 			next = (resource *)GET_NEXT(pr->rs_link);
@@ -1690,6 +1756,7 @@ resv_alloc(char *resvid)
 	}
 
 	CLEAR_LINK(resvp->ri_allresvs);
+	CLEAR_LINK(resvp->ri_dirtyresvs);
 	CLEAR_HEAD(resvp->ri_svrtask);
 	CLEAR_HEAD(resvp->ri_rejectdest);
 	resvp->newobj = 1;
@@ -1742,6 +1809,8 @@ resv_free(resc_resv *presv)
 	char *dot = NULL;
 	char *resvid = presv->ri_qs.ri_resvID;
 
+	delete_link(&presv->ri_dirtyresvs);
+
 	/* remove any malloc working attribute space */
 
 	for (i=0; i < (int)RESV_ATR_LAST; i++) {
@@ -1768,6 +1837,8 @@ resv_free(resc_resv *presv)
 	if (presv->ri_brp)
 		free_br(presv->ri_brp);
 
+	free_status_cache(presv->ri_stcache);
+
 	if ((dot = strchr(resvid, (int)'.')) != 0)
 		*dot = '\0';
 
@@ -1898,6 +1969,7 @@ resv_purge(resc_resv *presv)
 	free_resvNodes(presv);
 	set_scheduler_flag(SCH_SCHEDULE_TERM, dflt_scheduler);
 
+	delete_link(&presv->ri_dirtyresvs);
 	strcpy(dbresv.ri_resvid, presv->ri_qs.ri_resvID);
 	obj.pbs_db_obj_type = PBS_DB_RESV;
 	obj.pbs_db_un.pbs_db_resv = &dbresv;
@@ -43,6 +43,8 @@
 #include <sys/types.h>
 #include <sys/param.h>
 #include <execinfo.h>
+#include <pthread.h>
+#include <sys/time.h>
 
 #include "pbs_ifl.h"
 #include <errno.h>
@@ -71,13 +73,14 @@
 extern void *svr_db_conn;
 extern int server_init_type;
 extern pbs_list_head svr_allresvs;
+extern pbs_list_head svr_dirty_jobs;
+extern pbs_list_head svr_dirty_resvs;
 #define BACKTRACE_BUF_SIZE 50
 void print_backtrace(char *);
 
 /* global data items */
 extern time_t time_now;
 
-job *recov_job_cb(pbs_db_obj_info_t *dbobj, int *refreshed);
 resc_resv *recov_resv_cb(pbs_db_obj_info_t *dbobj, int *refreshed);
 
 /**
@@ -101,7 +104,8 @@ job_to_db(job *pjob, pbs_db_job_info_t *dbjob)
 
 	strcpy(dbjob->ji_jobid, pjob->ji_qs.ji_jobid);
 
-	if (check_job_state(pjob, JOB_STATE_LTR_FINISHED))
+	/* a history job is saved whole, job_thaw() reads it back from here */
+	if (is_history_state(get_job_state(pjob)))
 		save_all_attrs = 1;
 
 	if ((encode_attr_db(job_attr_def, pjob->ji_wattr, JOB_ATR_LAST, &dbjob->db_attr_list, save_all_attrs)) != 0)
@@ -158,12 +162,14 @@ job_to_db(job *pjob, pbs_db_job_info_t *dbjob)
  *
  * @param[out]	pjob - Address of the job in the server
  * @param[in]	dbjob - Address of the database job object
+ * @param[in]	actions - Run the attribute recovery actions, these are not
+ *			  safe to run outside the main thread
  *
  * @retval   !=0  Failure
  * @retval   0    Success
  */
 static int
-db_to_job(job *pjob,  pbs_db_job_info_t *dbjob)
+db_to_job(job *pjob,  pbs_db_job_info_t *dbjob, int actions)
 {
 	char statec;
 
@@ -205,7 +211,10 @@ db_to_job(job *pjob,  pbs_db_job_info_t *dbjob)
 	strcpy(pjob->ji_extended.ji_ext.ji_jid, dbjob->ji_jid);
 	pjob->ji_extended.ji_ext.ji_credtype = dbjob->ji_credtype;
 
-	if ((decode_attr_db(pjob, &dbjob->db_attr_list, job_attr_idx, job_attr_def, pjob->ji_wattr, JOB_ATR_LAST, JOB_ATR_UNKN)) != 0)
+	if (actions) {
+		if ((decode_attr_db(pjob, &dbjob->db_attr_list, job_attr_idx, job_attr_def, pjob->ji_wattr, JOB_ATR_LAST, JOB_ATR_UNKN)) != 0)
+			return -1;
+	} else if ((decode_attr_db_noact(pjob, &dbjob->db_attr_list, job_attr_idx, job_attr_def, pjob->ji_wattr, JOB_ATR_LAST, JOB_ATR_UNKN)) != 0)
 		return -1;
 
 	compare_obj_hash(&pjob->ji_qs, sizeof(pjob->ji_qs), pjob->qs_hash);
@@ -217,7 +226,37 @@ db_to_job(job *pjob,  pbs_db_job_info_t *dbjob)
 
 /**
  * @brief
- *		Save job to database
+ *	Save job to database, or queue it for the next flush_db_saves()
+ *	when saves are being deferred. New jobs are always saved at once so that
+ *	id clashes are reported to the caller.
+ *
+ * @param[in]	pjob - The job to save
+ *
+ * @return      Error code
+ * @retval	 0 - Success (or queued)
+ * @retval	-1 - Failure
+ * @retval	 1 - jobid clash, retry with new jobid
+ *
+ */
+int
+job_save_db(job *pjob)
+{
+	/* a reused job id must not be inserted before the old row is deleted */
+	if (pjob->newobj && job_delete_pending(pjob->ji_qs.ji_jobid))
+		flush_db_saves();
+
+	if (pjob->newobj || !db_saves_deferred())
+		return (job_save_db_now(pjob));
+
+	if (pjob->ji_dirtyjobs.ll_next == &pjob->ji_dirtyjobs)
+		append_link(&svr_dirty_jobs, &pjob->ji_dirtyjobs, pjob);
+
+	return 0;
+}
+
+/**
+ * @brief
+ *		Write job to database now, dropping it from the deferred save list
  *
  * @param[in]	pjob - The job to save
  *
@@ -228,7 +267,7 @@ db_to_job(job *pjob,  pbs_db_job_info_t *dbjob)
  *
  */
 int
-job_save_db(job *pjob)
+job_save_db_now(job *pjob)
 {
 	pbs_db_job_info_t dbjob = {{0}};
 	pbs_db_obj_info_t obj;
@@ -238,6 +277,8 @@ job_save_db(job *pjob)
 	int old_mtime, old_flags;
 	char *conn_db_err = NULL;
 
+	delete_link(&pjob->ji_dirtyjobs);
+
 	old_mtime = get_jattr_long(pjob, JOB_ATR_mtime);
 	old_flags = pjob->ji_wattr[JOB_ATR_mtime].at_flags;
 
@@ -297,7 +338,7 @@ job_recov_db_spl(pbs_db_job_info_t *dbjob, job *pjob)
 	}
 
 	if (pjob) {
-		if (db_to_job(pjob, dbjob) == 0)
+		if (db_to_job(pjob, dbjob, 1) == 0)
 			return (pjob);
 	}
 
@@ -350,6 +391,48 @@ job_recov_db(char *jid, job *pjob)
 	return (pjob);
 }
 
+/**
+ * @brief
+ *	Load the attributes of a job from the database into its attribute
+ *	array, without running any action function.  The quick save area is
+ *	left alone.
+ *
+ * @param[in,out]	pjob - job, its attributes are all unset
+ *
+ * @return      Error code
+ * @retval	 0 - Success
+ * @retval	-1 - Failure
+ *
+ */
+int
+job_recov_attrs_db(job *pjob)
+{
+	pbs_db_job_info_t dbjob = {{0}};
+	pbs_db_obj_info_t obj;
+	char *conn_db_err = NULL;
+	int rc;
+
+	/* a child serving a status request has no connection of its own */
+	if (svr_db_conn == NULL)
+		return -1;
+
+	strcpy(dbjob.ji_jobid, pjob->ji_qs.ji_jobid);
+	obj.pbs_db_obj_type = PBS_DB_JOB;
+	obj.pbs_db_un.pbs_db_job = &dbjob;
+
+	if ((rc = pbs_db_load_obj(svr_db_conn, &obj)) != 0) {
+		pbs_db_get_errmsg(PBS_DB_ERR, &conn_db_err);
+		log_errf(PBSE_INTERNAL, __func__, "Failed to load job %s %s", pjob->ji_qs.ji_jobid, conn_db_err ? conn_db_err : "");
+		free(conn_db_err);
+		rc = -1;
+	} else if (decode_attr_db_noact(pjob, &dbjob.db_attr_list, job_attr_idx, job_attr_def, pjob->ji_wattr, JOB_ATR_LAST, JOB_ATR_UNKN) != 0)
+		rc = -1;
+
+	free_db_attr_list(&dbjob.db_attr_list);
+
+	return (rc);
+}
+
 /**
  * @brief
  *		convert resv structure to DB format
@@ -428,7 +511,33 @@ db_to_resv(resc_resv *presv, pbs_db_resv_info_t *dbresv)
 
 /**
  * @brief
- *	Save resv to database
+ *	Save resv to database, or queue it for the next flush_db_saves()
+ *	when saves are being deferred. New resvs are always saved at once so that
+ *	id clashes are reported to the caller.
+ *
+ * @param[in]	presv - The resv to save
+ *
+ * @return      Error code
+ * @retval	 0 - Success (or queued)
+ * @retval	-1 - Failure
+ * @retval	 1 - resvid clash, retry with new resvid
+ *
+ */
+int
+resv_save_db(resc_resv *presv)
+{
+	if (presv->newobj || !db_saves_deferred())
+		return (resv_save_db_now(presv));
+
+	if (presv->ri_dirtyresvs.ll_next == &presv->ri_dirtyresvs)
+		append_link(&svr_dirty_resvs, &presv->ri_dirtyresvs, presv);
+
+	return 0;
+}
+
+/**
+ * @brief
+ *	Write resv to database now, dropping it from the deferred save list
  *
  * @param[in]	presv - The resv to save
  * @param[in]   updatetype:
@@ -443,7 +552,7 @@ db_to_resv(resc_resv *presv, pbs_db_resv_info_t *dbresv)
  *
  */
 int
-resv_save_db(resc_resv *presv)
+resv_save_db_now(resc_resv *presv)
 {
 	pbs_db_resv_info_t dbresv = {{0}};
 	pbs_db_obj_info_t obj;
@@ -453,6 +562,8 @@ resv_save_db(resc_resv *presv)
 	int old_mtime, old_flags;
 	char *conn_db_err = NULL;
 
+	delete_link(&presv->ri_dirtyresvs);
+
 	old_mtime = presv->ri_wattr[RESV_ATR_mtime].at_val.at_long;
 	old_flags = presv->ri_wattr[RESV_ATR_mtime].at_flags;
 
@@ -546,49 +657,198 @@ resv_recov_db(char *resvid, resc_resv *presv)
 	return presv;
 }
 
+/* rows of the job table decoded by one thread, see recov_jobs_db() */
+struct recov_jobs_slice {
+	void *res;	/* resultset of pbs_db_find_jobs() */
+	job **jobs;	/* decoded job of each row, NULL if decoding failed */
+	char **badids;	/* job id of each row that failed to decode */
+	int start;	/* first row of the slice */
+	int end;	/* row after the last row of the slice */
+	int is_main;	/* slice is decoded by the main thread */
+};
+
 /**
  * @brief
- *	Refresh/retrieve job from database and add it into AVL tree if not present
+ *	Decode the rows of one slice of the job table into job structures.
+ *	Runs on its own thread, so only the job being decoded is written to;
+ *	the attribute actions and everything that links the job into server
+ *	wide lists is left to recov_jobs_db().
  *
- *	@param[in]  dbobj     - The pointer to the wrapper job object of type pbs_db_job_info_t
- * 	@param[out]  refreshed - To check if job is refreshed
+ * @param[in,out]	arg - the struct recov_jobs_slice to decode
  *
- * @return	The recovered job
- * @retval	NULL - Failure
- * @retval	!NULL - Success, pointer to job structure recovered
+ * @return	NULL
  *
  */
-job *
-recov_job_cb(pbs_db_obj_info_t *dbobj, int *refreshed)
+static void *
+recov_jobs_decode(void *arg)
 {
-	job *pj = NULL;
-	pbs_db_job_info_t *dbjob = dbobj->pbs_db_un.pbs_db_job;
-	static int numjobs = 0;
-
-	*refreshed = 0;
-	if ((pj = job_recov_db_spl(dbjob, NULL)) == NULL) {
-		if ((server_init_type == RECOV_COLD) || (server_init_type == RECOV_CREATE)) {
-			/* remove the loaded job from db */
-			if (pbs_db_delete_obj(svr_db_conn, dbobj) != 0)
-				log_errf(PBSE_SYSTEM, __func__, "job %s not purged", dbjob->ji_jobid);
+	struct recov_jobs_slice *slice = arg;
+	pbs_db_job_info_t dbjob;
+	job *pj;
+	int i;
+
+	for (i = slice->start; i < slice->end; i++) {
+		memset(&dbjob, 0, sizeof(dbjob));
+		pj = NULL;
+		if (pbs_db_load_job_row(slice->res, i, &dbjob) == 0 && (pj = job_alloc()) != NULL) {
+			if (db_to_job(pj, &dbjob, 0) != 0) {
+				job_free(pj);
+				pj = NULL;
+			}
 		}
-		goto err;
-	}
+		if (pj == NULL)
+			slice->badids[i] = strdup(dbjob.ji_jobid);
+		slice->jobs[i] = pj;
+		free_db_attr_list(&dbjob.db_attr_list);
 
-	pbsd_init_job(pj, server_init_type);
-	*refreshed = 1;
-
-	if ((++numjobs % 20) == 0) {
 		/* periodically touch the file so the  */
 		/* world knows we are alive and active */
-		update_svrlive();
+		if (slice->is_main && ((i - slice->start) % 1000) == 999)
+			update_svrlive();
 	}
 
-err:
-	free_db_attr_list(&dbjob->db_attr_list);
-	if (pj == NULL)
-		log_errf(PBSE_SYSTEM, __func__, "Failed to recover job %s", dbjob->ji_jobid);
-	return pj;
+	return NULL;
+}
+
+/**
+ * @brief
+ *	Recover all jobs from the database at server startup
+ *
+ * @par Functionality:
+ *	The jobs are read with a single query, so they come back in queue rank
+ *	order from one consistent snapshot. Decoding the rows into job
+ *	structures is the bulk of the work and is spread over up to
+ *	PBS_RECOV_MAX_THREADS threads, each taking a contiguous range of rows.
+ *	The attribute actions and pbsd_init_job(), which link each job into
+ *	the queues, arrays, dependencies and indexes, then run on the main
+ *	thread in queue rank order, the same as a serial recovery. A job that
+ *	cannot be recovered is logged and skipped, as before.
+ *
+ * @return	int
+ * @retval	-1	- Failure, the database query or cursor failed
+ * @retval	>=0	- Number of jobs recovered
+ *
+ */
+int
+recov_jobs_db(void)
+{
+	struct recov_jobs_slice slices[PBS_RECOV_MAX_THREADS];
+	pthread_t tids[PBS_RECOV_MAX_THREADS];
+	int started[PBS_RECOV_MAX_THREADS];
+	struct timeval tv_start;
+	struct timeval tv_end;
+	pbs_db_job_info_t dbjob;
+	pbs_db_obj_info_t obj;
+	void *res;
+	job **jobs;
+	char **badids;
+	job *pj;
+	long ncpus;
+	int nthreads = 1;
+	int count;
+	int per;
+	int numjobs = 0;
+	int i;
+
+	gettimeofday(&tv_start, NULL);
+
+	if ((res = pbs_db_find_jobs(svr_db_conn, &count)) == NULL)
+		return (count);
+
+	jobs = calloc(count, sizeof(job *));
+	badids = calloc(count, sizeof(char *));
+	if (jobs == NULL || badids == NULL) {
+		log_err(errno, __func__, "Out of memory");
+		free(jobs);
+		free(badids);
+		pbs_db_free_jobs(res);
+		return -1;
+	}
+
+	if (count >= PBS_RECOV_MT_MIN_JOBS) {
+		ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+		if (ncpus > PBS_RECOV_MAX_THREADS)
+			nthreads = PBS_RECOV_MAX_THREADS;
+		else if (ncpus > 1)
+			nthreads = ncpus;
+	}
+	per = (count + nthreads - 1) / nthreads;
+
+	for (i = 0; i < nthreads; i++) {
+		slices[i].res = res;
+		slices[i].jobs = jobs;
+		slices[i].badids = badids;
+		slices[i].start = i * per;
+		slices[i].end = (i + 1) * per < count ? (i + 1) * per : count;
+		slices[i].is_main = (i == 0);
+		started[i] = 0;
+	}
+	for (i = 1; i < nthreads; i++) {
+		if (pthread_create(&tids[i], NULL, recov_jobs_decode, &slices[i]) == 0)
+			started[i] = 1;
+		else
+			log_err(errno, __func__, "Failed to start job decode thread, decoding inline");
+	}
+	for (i = 0; i < nthreads; i++) {
+		if (started[i])
+			continue;
+		slices[i].is_main = 1;
+		recov_jobs_decode(&slices[i]);
+	}
+	for (i = 1; i < nthreads; i++) {
+		if (started[i])
+			pthread_join(tids[i], NULL);
+	}
+	pbs_db_free_jobs(res);
+
+	gettimeofday(&tv_end, NULL);
+	log_eventf(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_INFO, msg_daemonname,
+		"Decoded %d jobs in %.3f seconds using %d threads", count,
+		(tv_end.tv_sec - tv_start.tv_sec) + (tv_end.tv_usec - tv_start.tv_usec) / 1e6, nthreads);
+	tv_start = tv_end;
+
+	for (i = 0; i < count; i++) {
+		pj = jobs[i];
+		if (pj != NULL && recov_attr_db_actions(pj, job_attr_def, pj->ji_wattr, JOB_ATR_LAST) != 0) {
+			badids[i] = strdup(pj->ji_qs.ji_jobid);
+			job_free(pj);
+			pj = NULL;
+		}
+
+		if (pj == NULL) {
+			if ((server_init_type == RECOV_COLD) || (server_init_type == RECOV_CREATE)) {
+				/* remove the bad job from db */
+				memset(&dbjob, 0, sizeof(dbjob));
+				if (badids[i] != NULL)
+					snprintf(dbjob.ji_jobid, sizeof(dbjob.ji_jobid), "%s", badids[i]);
+				obj.pbs_db_obj_type = PBS_DB_JOB;
+				obj.pbs_db_un.pbs_db_job = &dbjob;
+				if (pbs_db_delete_obj(svr_db_conn, &obj) != 0)
+					log_errf(PBSE_SYSTEM, __func__, "job %s not purged", dbjob.ji_jobid);
+			}
+			log_errf(PBSE_SYSTEM, __func__, "Failed to recover job %s", badids[i] ? badids[i] : "");
+			free(badids[i]);
+			continue;
+		}
+
+		pbsd_init_job(pj, server_init_type);
+		numjobs++;
+
+		if ((numjobs % 20) == 0) {
+			/* periodically touch the file so the  */
+			/* world knows we are alive and active */
+			update_svrlive();
+		}
+	}
+	free(jobs);
+	free(badids);
+
+	gettimeofday(&tv_end, NULL);
+	log_eventf(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_INFO, msg_daemonname,
+		"Linked %d jobs in %.3f seconds", numjobs,
+		(tv_end.tv_sec - tv_start.tv_sec) + (tv_end.tv_usec - tv_start.tv_usec) / 1e6);
+
+	return (numjobs);
 }
 
 /**
@@ -313,6 +313,7 @@ initialize_pbsnode(struct pbsnode *pnode, char *pname, int ntype)
 	pnode->newobj = 1;
 	pnode->nd_lic_info = NULL;
 	pnode->nd_added_to_unlicensed_list = 0;
+	CLEAR_LINK(pnode->nd_dirtynodes);
 	pnode->nd_moms    = (struct mominfo **)calloc(1, sizeof(struct mominfo *));
 	if (pnode->nd_moms == NULL)
 		return (PBSE_SYSTEM);
@@ -516,6 +517,8 @@ void
 free_pnode(struct pbsnode *pnode)
 {
 	if (pnode) {
+		invalidate_exec_vnode_caches();
+		delete_link(&pnode->nd_dirtynodes);
 		(void)free(pnode->nd_name);
 		(void)free(pnode->nd_hostname);
 		(void)free(pnode->nd_moms);
@@ -581,6 +584,7 @@ effective_node_delete(struct pbsnode *pnode)
 				if (ipaddr)
 					delete_iplist_element(pbs_iplist, ipaddr);
 			}
+			pbs_iplist_gen++;
 			delete_svrmom_entry(pnode->nd_moms[0]);
 			pnode->nd_moms[0] = NULL; /* since we deleted the mom */
 		} else {
@@ -621,6 +625,11 @@ effective_node_delete(struct pbsnode *pnode)
  *	other members of the server's node pool that a new node was added
  *	manually via qmgr.
  *	The IS_CLUSTER_ADDRS message is only sent to the existing Moms.
+ *
+ *	When many nodes are created one after the other, the pending send
+ *	is pushed back by MCAST_WAIT_TM on each create, so the Moms get one
+ *	update at the end of the batch. It is never held back for more than
+ *	MCAST_ADDR_MAX_WAIT seconds after the first create of the batch.
  * @see
  * 		mgr_node_create
  *
@@ -631,24 +640,41 @@ setup_notification()
 {
 	int	i;
 	int	nmom;
-	static	time_t addr_send_tm = 0;
+	int	marked;
+	struct pbsnode *np;
+	struct work_task *ptask;
+	static	time_t addr_first_tm = 0;
 
 	for (i=0; i<svr_totnodes; i++) {
-		if (pbsndlist[i]->nd_state & INUSE_DELETED)
+		np = pbsndlist[i];
+		if (np->nd_state & INUSE_DELETED)
+			continue;
+
+		/* skip the nodes already marked by an earlier create */
+		marked = (np->nd_state & INUSE_DOWN) != 0;
+		for (nmom = 0; marked && nmom < np->nd_nummoms; ++nmom) {
+			if (!(((mom_svrinfo_t *)(np->nd_moms[nmom]->mi_data))->msr_state & INUSE_NEED_ADDRS))
+				marked = 0;
+		}
+		if (marked)
 			continue;
 
-		set_vnode_state(pbsndlist[i], INUSE_DOWN, Nd_State_Or);
-		pbsndlist[i]->nd_attr[(int)ND_ATR_state].at_flags |= ATR_SET_MOD_MCACHE;
-		for (nmom = 0; nmom < pbsndlist[i]->nd_nummoms; ++nmom) {
-			((mom_svrinfo_t *)(pbsndlist[i]->nd_moms[nmom]->mi_data))->msr_state |= INUSE_NEED_ADDRS;
+		set_vnode_state(np, INUSE_DOWN, Nd_State_Or);
+		np->nd_attr[(int)ND_ATR_state].at_flags |= ATR_SET_MOD_MCACHE;
+		for (nmom = 0; nmom < np->nd_nummoms; ++nmom) {
+			((mom_svrinfo_t *)(np->nd_moms[nmom]->mi_data))->msr_state |= INUSE_NEED_ADDRS;
 		}
 	}
 
-	/* send IS_CLUSTERADDR2 to happen in next 2 seconds */
-	if (addr_send_tm <= time_now) {
-		addr_send_tm = time_now + MCAST_WAIT_TM;
-		struct work_task *ptask = set_task(WORK_Timed, addr_send_tm, mcast_moms, NULL);
-		ptask->wt_aux = IS_CLUSTER_ADDRS;
+	/* send IS_CLUSTER_ADDRS once no node has been added for 2 seconds */
+	ptask = find_work_task(WORK_Timed, &addr_first_tm, mcast_moms);
+	if (ptask == NULL) {
+		addr_first_tm = time_now;
+		ptask = set_task(WORK_Timed, time_now + MCAST_WAIT_TM, mcast_moms, &addr_first_tm);
+		if (ptask)
+			ptask->wt_aux = IS_CLUSTER_ADDRS;
+	} else if (time_now + MCAST_WAIT_TM <= addr_first_tm + MCAST_ADDR_MAX_WAIT) {
+		ptask->wt_event = time_now + MCAST_WAIT_TM;
 	}
 }
 
@@ -793,6 +819,57 @@ save_nodes_db_inner(void)
 	return 0;
 }
 
+/**
+ * @brief
+ *		Static function to find the resource definition named by the
+ *		server's node_group_key attribute.
+ *
+ * @return	resource_def *
+ * @retval	NULL - node_group_key is not set or names no resource
+ */
+static resource_def *
+node_group_key_def(void)
+{
+	char *rname;
+
+	if (server.sv_attr[SVR_ATR_NodeGroupKey].at_flags & ATR_VFLAG_SET  &&
+		server.sv_attr[SVR_ATR_NodeGroupKey].at_val.at_str)
+		rname = server.sv_attr[SVR_ATR_NodeGroupKey].at_val.at_str;
+	else
+		return NULL;
+
+	return (find_resc_def(svr_resc_def, rname));
+}
+
+/**
+ * @brief
+ *		Static function to clear the ATR_VFLAG_MODIFY bit on the attributes
+ *		of a saved node and on its node_group_key resource.
+ *		The attribute bits of a node whose save is still queued are left
+ *		alone, they tell the queued save what to write.
+ *
+ * @param[in]	np - the node
+ * @param[in]	rscdef - the node_group_key resource, NULL if none
+ *
+ * @return	void
+ */
+static void
+clear_node_modify(struct pbsnode *np, resource_def *rscdef)
+{
+	int num;
+	resource *resc;
+
+	if (np->nd_dirtynodes.ll_next == &np->nd_dirtynodes) {
+		for (num = 0; num < ND_ATR_LAST; num++)
+			np->nd_attr[num].at_flags &= ~ATR_VFLAG_MODIFY;
+	}
+
+	if (rscdef != NULL) {
+		if ((resc = find_resc_entry(&np->nd_attr[ND_ATR_ResourceAvail], rscdef)))
+			resc->rs_value.at_flags &= ~ATR_VFLAG_MODIFY;
+	}
+}
+
 /**
  * @brief
  *		When called, this function will update
@@ -817,13 +894,10 @@ save_nodes_db(int changemodtime, void *p)
 	struct pbsnode  *np;
 	pbs_db_mominfo_time_t mom_tm = {0, 0};
 	pbs_db_obj_info_t obj;
-	int           num;
-	attribute    *pattr;
-	resource     *resc;
-	char         *rname;
 	resource_def *rscdef;
 	int	i;
 	mominfo_t    *pmom = (mominfo_t *) p;
+	mom_svrinfo_t *psvrm;
 	char *conn_db_err = NULL;
 
 	DBPRT(("%s: entered\n", __func__))
@@ -868,34 +942,20 @@ save_nodes_db(int changemodtime, void *p)
 	 * and on the node_group_key resource, for those nodes
 	 * that possess a node_group_key resource
 	 */
-
-	if (server.sv_attr[SVR_ATR_NodeGroupKey].at_flags & ATR_VFLAG_SET  &&
-		server.sv_attr[SVR_ATR_NodeGroupKey].at_val.at_str)
-		rname = server.sv_attr[SVR_ATR_NodeGroupKey].at_val.at_str;
-	else
-		rname = NULL;
-
-	if (rname)
-		rscdef = find_resc_def(svr_resc_def, rname);
-	else
-		rscdef = NULL;
-
-	for (i=0; i<svr_totnodes; i++) {
-		np = pbsndlist[i];
-		if (np->nd_state & INUSE_DELETED)
-			continue;
-
-		for (num=0; num<ND_ATR_LAST; num++) {
-
-			np->nd_attr[num].at_flags &= ~ATR_VFLAG_MODIFY;
-
-			if (num == ND_ATR_ResourceAvail)
-				if (rname != NULL && rscdef != NULL) {
-					pattr = &np->nd_attr[ND_ATR_ResourceAvail];
-					if ((resc = find_resc_entry(pattr, rscdef)))
-						resc->rs_value.at_flags &= ~ATR_VFLAG_MODIFY;
-				}
-
+	rscdef = node_group_key_def();
+	if (pmom) {
+		psvrm = (mom_svrinfo_t *) pmom->mi_data;
+		for (i = 0; i < psvrm->msr_numvnds; i++) {
+			np = psvrm->msr_children[i];
+			if (np != NULL && !(np->nd_state & INUSE_DELETED))
+				clear_node_modify(np, rscdef);
+		}
+	} else {
+		for (i=0; i<svr_totnodes; i++) {
+			np = pbsndlist[i];
+			if (np->nd_state & INUSE_DELETED)
+				continue;
+			clear_node_modify(np, rscdef);
 		}
 	}
 	return (0);
@@ -908,6 +968,29 @@ db_err:
 	return (-1);
 }
 
+/**
+ * @brief
+ *		Save a single vnode changed by the administrator, instead of
+ *		saving every node with save_nodes_db().
+ *
+ * @param[in]	np - the vnode to save
+ *
+ * @return	error code
+ * @retval	-1 - Failure
+ * @retval	 0 - Success
+ *
+ */
+int
+save_vnode_db(struct pbsnode *np)
+{
+	if (node_save_db(np) != 0) {
+		log_event(PBSEVENT_ADMIN, PBS_EVENTCLASS_SERVER, LOG_WARNING, "nodes", nodeerrtxt);
+		return (-1);
+	}
+	clear_node_modify(np, node_group_key_def());
+	return (0);
+}
+
 
 
 /**
@@ -1716,6 +1799,7 @@ decode_Mom_list(struct attribute *patr, char *name, char *rescn, char *val)
 	int			  ns;
 	int			  i = 0;
 	char			 *p;
+	char			 *savep;
 	char			  buf[PBS_MAXHOSTNAME+1];
 	static char		**str_arr = NULL;
 	static long int		  str_arr_len = 0;
@@ -1749,13 +1833,12 @@ decode_Mom_list(struct attribute *patr, char *name, char *rescn, char *val)
 		str_arr_len = (2 * ns) + 1;
 	}
 	/* Filling node list to a array, this has been done outside the
-	 * second for loop since, parse_comma_string() is being again called internally by
-	 * decode_arst() that alters the static variable in parse_comma_string().
+	 * second for loop since val is parsed in place.
 	 */
 	str_arr[0]=NULL;
-	p = parse_comma_string(val);
+	p = parse_comma_string(val, &savep);
 	for (i = 0; (str_arr[i] = p) != NULL; i++)
-		p = parse_comma_string(NULL);
+		p = parse_comma_string(NULL, &savep);
 
 	for (i = 0; (p = str_arr[i]) != NULL; i++) {
 		clear_attr(&new, &node_attr_def[(int)ND_ATR_Mom]);
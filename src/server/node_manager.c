@@ -270,10 +270,20 @@ tinsert2(const u_long key1, const u_long key2, mominfo_t *momp, struct tree **ro
 	return;
 }
 
+/* IS_CLUSTER_ADDRS body encoded from pbs_iplist, see send_ip_addrs_to_mom() */
+static char	*ip_addrs_enc = NULL;
+static size_t	ip_addrs_enc_len = 0;
+static int	ip_addrs_enc_binary = 0;
+static long	ip_addrs_enc_gen = -1;
+
 /**
  * @brief Send the IS_CLUSTER_ADDRS message to Mom so she has the
  *      latest list of IP addresses of the all the Moms in the complex.
  *
+ *	The encoded list is kept and put as is on the following sends until
+ *	pbs_iplist changes, so a hello storm does not encode it over again
+ *	for every reply.
+ *
  * @param[in] stream - the open stream to the Mom
  * @param[in] combine_msg - combine message in the caller
  *
@@ -286,6 +296,9 @@ send_ip_addrs_to_mom(int stream, int combine_msg)
 {
 	int		j;
 	int		ret;
+	size_t		start;
+	size_t		len;
+	char		*data;
 
 	DBPRT(("%s: entered\n", __func__))
 
@@ -296,6 +309,14 @@ send_ip_addrs_to_mom(int stream, int combine_msg)
 		if ((ret = is_compose(stream, IS_CLUSTER_ADDRS)) != DIS_SUCCESS)
 			return (ret);
 
+	if (ip_addrs_enc != NULL && ip_addrs_enc_gen == pbs_iplist_gen &&
+		ip_addrs_enc_binary == dis_is_binary(stream)) {
+		if (dis_puts(stream, ip_addrs_enc, ip_addrs_enc_len) != (int) ip_addrs_enc_len)
+			return DIS_PROTO;
+		goto done;
+	}
+
+	start = dis_write_len(stream);
 	if ((ret = diswui(stream, pbs_iplist->li_nrowsused)) != DIS_SUCCESS)
 		return ret;
 
@@ -315,6 +336,20 @@ send_ip_addrs_to_mom(int stream, int combine_msg)
 		if ((ret = diswul(stream, IPLIST_GET_HIGH(pbs_iplist, j))) != DIS_SUCCESS)
 			return (ret);
 	}
+
+	/* keep the encoded list for the next sends */
+	free(ip_addrs_enc);
+	ip_addrs_enc = NULL;
+	len = dis_write_len(stream) - start;
+	data = dis_write_data(stream, start);
+	if (data != NULL && len > 0 && (ip_addrs_enc = malloc(len)) != NULL) {
+		memcpy(ip_addrs_enc, data, len);
+		ip_addrs_enc_len = len;
+		ip_addrs_enc_binary = dis_is_binary(stream);
+		ip_addrs_enc_gen = pbs_iplist_gen;
+	}
+
+done:
 	if (!combine_msg)
 		return dis_flush(stream);
 	return 0;
@@ -1164,6 +1199,8 @@ shallow_vnode_dup(struct pbsnode *vnode)
 	for (i = 0; i < (int)ND_ATR_LAST; i++) {
 		node_attr_def[i].at_free(&vnode_dup->nd_attr[i]);
 		vnode_dup->nd_attr[i] = vnode->nd_attr[i];
+		/* the copy does not own the encoded caches or resource index */
+		vnode_dup->nd_attr[i].at_ext = NULL;
 	}
 	return vnode_dup;
 }
@@ -2021,7 +2058,8 @@ decode_stat_update(int stream, ruu *prused)
 /**
  * @brief
  *		Update job resource usage based on information sent from Mom.
- *		All updates include the lastest information on resource usage.
+ *		Updates carry only the resources_used values which changed
+ *		since the last update Mom sent on the current connection.
  * @par Functionality:
  *		An update from Mom also contains certain attributes which
  *		need to be recorded,  the most inportant of which is the job's
@@ -2211,11 +2249,13 @@ stat_update(int stream)
 				log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_JOB,
 					LOG_DEBUG, pjob->ji_qs.ji_jobid,
 					"update from Mom without session id");
-			} else {
+			} else if (sattrl != NULL) {
 				/* session id was set to same old value   */
 				/* so only need to save things to disk    */
 				/* if something other than the session id */
 				/* or resources_used was modified         */
+				/* (Mom sends only changed values, an     */
+				/* empty update leaves the job untouched) */
 
 				pjob->ji_wattr[(int)JOB_ATR_session_id].at_flags &= ~ATR_VFLAG_MODIFY;
 				job_save_db(pjob); /* job_save will save only if modified */
@@ -6351,16 +6391,16 @@ int
 set_nodes(void *pobj, int objtype, char *execvnod_in, char **execvnod_out, char **hoststr, char **hoststr2, int mk_new_host, int svr_init)
 {
 	int	      alloc_how = INUSE_JOB;
-	char         *chunk;
 	int	      setck;
-	char	     *execvncopy;
+	exec_vnode_cache *pevn;
+	exec_vnode_cache *pevntmp = NULL;
+	exec_vnode_chunk *pch;
 	int	      hasprn;	     /* set if chunk grouped in parenthesis */
 	int	      hostcpus;
 	int	      i;
-	char	     *last;
+	int	      k;
 	char 	     *execvnod = NULL;
 	int	      ndindex;
-	int           nelem;
 	mominfo_t    *parentmom;
 	mominfo_t    *parentmom_first = NULL;
 	char	     *peh = NULL;
@@ -6369,13 +6409,11 @@ set_nodes(void *pobj, int objtype, char *execvnod_in, char **execvnod_out, char
 	char	     *pc;
 	char         *pc2;
 	int	      share_job = VNS_UNSET;
-	char         *vname;
 	struct jobinfo *jp;
 	resc_resv *presv = NULL;
 	int 	   tc;		/* num of nodes being allocated  */
 	struct pbssubn *snp;
 	struct pbsnode *pnode;
-	struct key_value_pair *pkvp;
 	struct howl {
 		pbsnode     *hw_pnd;	/* ptr to node */
 		pbsnode	    *hw_natvn;	/* pointer to "natural" vnode	     */
@@ -6471,12 +6509,16 @@ set_nodes(void *pobj, int objtype, char *execvnod_in, char **execvnod_out, char
 	ndindex = 0;
 
 	/* parse the exec_vnode string into a string of chunks and */
-	/* then parse each chunk for the required resources        */
+	/* then parse each chunk for the required resources, a job */
+	/* keeps the parsed form for later use, see job_exec_vnode */
 
-	execvncopy = strdup(execvnod);
-	if (execvncopy == NULL) {
+	if (pjob != NULL)
+		pevn = job_exec_vnode(pjob, execvnod);
+	else
+		pevn = pevntmp = parse_exec_vnode(execvnod);
+	if (pevn == NULL) {
 		free(phowl);
-		return (PBSE_SYSTEM);
+		return (PBSE_BADATVAL);
 	}
 
 	if (mk_new_host == 0) {
@@ -6494,162 +6536,153 @@ set_nodes(void *pobj, int objtype, char *execvnod_in, char **execvnod_out, char
 
 	parentmom = NULL;	/* use for multi-mom vnodes		      */
 
-	chunk = parse_plus_spec_r(execvncopy, &last, &hasprn);
-
 	/* note: hasprn is set based on finding '(' or ')'
 	 *	> 0 = found '(' at start of substring
 	 *	= 0 = no parens or found both in one substring
 	 *	< 0 = found ')' at end of substring
 	 */
 
-	while (chunk) {
+	for (k = 0; k < pevn->evn_nchunk; k++) {
+		pch = &pevn->evn_chunk[k];
+		hasprn = pch->ec_hasprn;
 
-		if (parse_node_resc(chunk, &vname, &nelem, &pkvp) == 0) {
-			pnode = find_nodebyname(vname);
-			if (pnode == NULL) {
-				free(phowl);
-				free(execvncopy);
-				return (PBSE_UNKNODE);
-			}
+		pnode = pch->ec_pnode;
+		if (pnode == NULL) {
+			free(phowl);
+			free_exec_vnode(pevntmp);
+			return (PBSE_UNKNODE);
+		}
 
-			if ((pnode->nd_state & VNODE_UNAVAILABLE) && (svr_init == FALSE))
-				if ((objtype == RESC_RESV_OBJECT) && (presv->ri_qs.ri_resvID[0] != PBS_MNTNC_RESV_ID_CHAR) /*&& (presv->ri_qs.ri_state == RESV_UNCONFIRMED)*/)
-					set_resv_for_degrade(pnode, presv);
+		if ((pnode->nd_state & VNODE_UNAVAILABLE) && (svr_init == FALSE))
+			if ((objtype == RESC_RESV_OBJECT) && (presv->ri_qs.ri_resvID[0] != PBS_MNTNC_RESV_ID_CHAR) /*&& (presv->ri_qs.ri_state == RESV_UNCONFIRMED)*/)
+				set_resv_for_degrade(pnode, presv);
 
-			if (pjob != NULL) { /* only for jobs do we warn if a mom */
-				/* hook has not been sent */
-				for (i = 0; i < pnode->nd_nummoms; ++i) {
+		if (pjob != NULL) { /* only for jobs do we warn if a mom */
+			/* hook has not been sent */
+			for (i = 0; i < pnode->nd_nummoms; ++i) {
 
-					if ((pnode->nd_moms[i] != NULL) &&
-						(sync_mom_hookfiles_count(pnode->nd_moms[i]) > 0)) {
-						snprintf(log_buffer, sizeof(log_buffer),
-							"vnode %s's parent mom %s:%d has a pending copy hook or delete hook request", pnode->nd_name,  pnode->nd_moms[i]->mi_host,
-							pnode->nd_moms[i]->mi_port);
-						log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_NODE,
-							LOG_WARNING, pjob->ji_qs.ji_jobid, log_buffer);
-						break;
-					}
+				if ((pnode->nd_moms[i] != NULL) &&
+					(sync_mom_hookfiles_count(pnode->nd_moms[i]) > 0)) {
+					snprintf(log_buffer, sizeof(log_buffer),
+						"vnode %s's parent mom %s:%d has a pending copy hook or delete hook request", pnode->nd_name,  pnode->nd_moms[i]->mi_host,
+						pnode->nd_moms[i]->mi_port);
+					log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_NODE,
+						LOG_WARNING, pjob->ji_qs.ji_jobid, log_buffer);
+					break;
 				}
 			}
+		}
 
-			(phowl + ndindex)->hw_pnd   = pnode;
-			(phowl + ndindex)->hw_ncpus = 0;
-			(phowl + ndindex)->hw_chunk = setck;
-			(phowl + ndindex)->hw_index = -1;	/* will fill in later */
-			(phowl + ndindex)->hw_htcpu = 0;
-			if (setck == 1) {	/* start of new chunk on host */
-				if (mk_new_host) {
-
-					/* look up "natural" vnode name for either 'the Mom' */
-					/* or 'a Mom' for the real vnode.  This is used in   */
-					/* the exec_host string                              */
-					if (pnode->nd_nummoms > 1) {	/* multi-mom */
-						parentmom = which_parent_mom(pnode, parentmom);
-						if (parentmom == NULL) {
-							/* cannot find a Mom that works */
-							free(phowl);
-							free(execvncopy);
-							return (PBSE_SYSTEM);
-						}
-						/*
-						 * save the "first" allocated Mom for incr
-						 * the count of jobs on that Mom; used in
-						 * load-balancing across multi-Mom vnodes
-						 * [i.e. in a Cray]
-						 */
-						if (parentmom_first == NULL)
-							parentmom_first = parentmom;
-
-						/* record "native" vnode for the chosen Mom */
-						(phowl+ndindex)->hw_natvn = ((struct mom_svrinfo *)(parentmom->mi_data))->msr_children[0];
-						(phowl+ndindex)->hw_mom = parentmom;
-					} else {
-						/* single parent Mom, just use her */
-						(phowl+ndindex)->hw_natvn = ((mom_svrinfo_t *)(pnode->nd_moms[0]->mi_data))->msr_children[0];
-						(phowl+ndindex)->hw_mom = pnode->nd_moms[0];
-						if (parentmom_first == NULL)
-							parentmom_first = pnode->nd_moms[0];
-						/* if the first chunk goes to a single parent */
-						/* set parentmom in case the next chunk can   */
-						/* also go there;  otherwise keep the old     */
-						/* parentmom value.                           */
-						if (parentmom == NULL)
-							parentmom = parentmom_first;
-
-
+		(phowl + ndindex)->hw_pnd   = pnode;
+		(phowl + ndindex)->hw_ncpus = 0;
+		(phowl + ndindex)->hw_chunk = setck;
+		(phowl + ndindex)->hw_index = -1;	/* will fill in later */
+		(phowl + ndindex)->hw_htcpu = 0;
+		if (setck == 1) {	/* start of new chunk on host */
+			if (mk_new_host) {
+
+				/* look up "natural" vnode name for either 'the Mom' */
+				/* or 'a Mom' for the real vnode.  This is used in   */
+				/* the exec_host string                              */
+				if (pnode->nd_nummoms > 1) {	/* multi-mom */
+					parentmom = which_parent_mom(pnode, parentmom);
+					if (parentmom == NULL) {
+						/* cannot find a Mom that works */
+						free(phowl);
+						free_exec_vnode(pevntmp);
+						return (PBSE_SYSTEM);
 					}
-				} else if (objtype == JOB_OBJECT) {
 					/*
-					 * exec_host applies to job's only ...
-					 * Have an existing exec_host string which is being
-					 * kept.  Reuse it to obtain the "natural" vnode and
-					 * the "index" number which we will use in
-					 * set_old_job_index() later
+					 * save the "first" allocated Mom for incr
+					 * the count of jobs on that Mom; used in
+					 * load-balancing across multi-Mom vnodes
+					 * [i.e. in a Cray]
 					 */
-					while (*pehnxt && (*pehnxt != '/'))
-						pehnxt++;
-					*pehnxt = '\0';
-					(phowl+ndindex)->hw_natvn = find_nodebyname(peh);
-					if ((phowl+ndindex)->hw_natvn == NULL) {
-						free(phowl);
-						free(execvncopy);
-						return (PBSE_UNKNODE);
-					}
-					(phowl+ndindex)->hw_mom =  pnode->nd_moms[0];
-					*pehnxt = '/';
-					(phowl+ndindex)->hw_index = atoi(++pehnxt);
-					while (*pehnxt && (*pehnxt != '+'))
-						pehnxt++;
-					if (*pehnxt == '+')
-						peh = ++pehnxt;
-					else
-						peh = pehnxt;
 					if (parentmom_first == NULL)
-						parentmom_first = (phowl+ndindex)->hw_natvn->nd_moms[0];
-				}
-			}
+						parentmom_first = parentmom;
 
-			/* set setck to indicate if next vnode starts a new chunk */
-			/* stays the same if hasprn == 0			  */
-			if (hasprn > 0)
-				setck = 0;	/* continuation of multi-vnode chunk  */
-			else if (hasprn < 0)
-				setck = 1;	/* end of multi-vnode chunk,start new */
+					/* record "native" vnode for the chosen Mom */
+					(phowl+ndindex)->hw_natvn = ((struct mom_svrinfo *)(parentmom->mi_data))->msr_children[0];
+					(phowl+ndindex)->hw_mom = parentmom;
+				} else {
+					/* single parent Mom, just use her */
+					(phowl+ndindex)->hw_natvn = ((mom_svrinfo_t *)(pnode->nd_moms[0]->mi_data))->msr_children[0];
+					(phowl+ndindex)->hw_mom = pnode->nd_moms[0];
+					if (parentmom_first == NULL)
+						parentmom_first = pnode->nd_moms[0];
+					/* if the first chunk goes to a single parent */
+					/* set parentmom in case the next chunk can   */
+					/* also go there;  otherwise keep the old     */
+					/* parentmom value.                           */
+					if (parentmom == NULL)
+						parentmom = parentmom_first;
 
 
-			for (i = 0; i < nelem; i++) {
-				if (strcasecmp("ncpus", (pkvp + i)->kv_keyw) == 0)
-					(phowl+ndindex)->hw_ncpus = atoi((pkvp+i)->kv_val);
-				else {
-					if ((find_resc_def(svr_resc_def, (pkvp+i)->kv_keyw) == NULL) && (svr_init == FALSE)) {
-						free(phowl);
-						free(execvncopy);
-						resc_in_err = strdup((pkvp+i)->kv_keyw);
-						return (PBSE_UNKRESC);
-					}
 				}
+			} else if (objtype == JOB_OBJECT) {
+				/*
+				 * exec_host applies to job's only ...
+				 * Have an existing exec_host string which is being
+				 * kept.  Reuse it to obtain the "natural" vnode and
+				 * the "index" number which we will use in
+				 * set_old_job_index() later
+				 */
+				while (*pehnxt && (*pehnxt != '/'))
+					pehnxt++;
+				*pehnxt = '\0';
+				(phowl+ndindex)->hw_natvn = find_nodebyname(peh);
+				if ((phowl+ndindex)->hw_natvn == NULL) {
+					free(phowl);
+					free_exec_vnode(pevntmp);
+					return (PBSE_UNKNODE);
+				}
+				(phowl+ndindex)->hw_mom =  pnode->nd_moms[0];
+				*pehnxt = '/';
+				(phowl+ndindex)->hw_index = atoi(++pehnxt);
+				while (*pehnxt && (*pehnxt != '+'))
+					pehnxt++;
+				if (*pehnxt == '+')
+					peh = ++pehnxt;
+				else
+					peh = pehnxt;
+				if (parentmom_first == NULL)
+					parentmom_first = (phowl+ndindex)->hw_natvn->nd_moms[0];
 			}
+		}
 
-			hostcpus += (phowl + ndindex)->hw_ncpus;
+		/* set setck to indicate if next vnode starts a new chunk */
+		/* stays the same if hasprn == 0			  */
+		if (hasprn > 0)
+			setck = 0;	/* continuation of multi-vnode chunk  */
+		else if (hasprn < 0)
+			setck = 1;	/* end of multi-vnode chunk,start new */
 
-			if (setck == 1) {
-				(phowl+ndindex)->hw_htcpu = hostcpus;
-				hostcpus = 0;
+
+		for (i = 0; i < pch->ec_nresc; i++) {
+			if (strcasecmp("ncpus", pch->ec_resc[i].er_name) == 0)
+				(phowl+ndindex)->hw_ncpus = atoi(pch->ec_resc[i].er_val);
+			else {
+				if ((pch->ec_resc[i].er_def == NULL) && (svr_init == FALSE)) {
+					free(phowl);
+					resc_in_err = strdup(pch->ec_resc[i].er_name);
+					free_exec_vnode(pevntmp);
+					return (PBSE_UNKRESC);
+				}
 			}
+		}
 
-		} else {
-			/* Error */
-			free(phowl);
-			free(execvncopy);
-			return (PBSE_BADATVAL);
+		hostcpus += (phowl + ndindex)->hw_ncpus;
+
+		if (setck == 1) {
+			(phowl+ndindex)->hw_htcpu = hostcpus;
+			hostcpus = 0;
 		}
 
-		chunk = parse_plus_spec_r(last, &last, &hasprn);
 		ndindex++;
 	}
 
-	free(execvncopy);
-	execvncopy = NULL;
+	free_exec_vnode(pevntmp);
+	pevntmp = NULL;
 
 	/* now we have an array of the required nodes */
 
@@ -6965,13 +6998,9 @@ free_nodes(job *pjob)
 	struct pbsnode *pnode;
 	mom_svrinfo_t *psvrmom;
 	char *execvnod_in = NULL;
-	char *execvncopy;
-	char *chunk;
-	char *last;
-	int hasprn;
-	char *vname;
-	int nelem;
-	struct key_value_pair *pkvp;
+	exec_vnode_cache *pevn;
+	exec_vnode_cache *pevntmp = NULL;
+	int i;
 	char *execvnod = NULL;
 
 	/* decrement number of jobs on the Mom who is the first Mom */
@@ -7007,21 +7036,19 @@ free_nodes(job *pjob)
 	} else {
 		execvnod = execvnod_in;
 	}
-	execvncopy = strdup(execvnod);
-	if (execvncopy == NULL)
+	if (execvnod == get_jattr_str(pjob, JOB_ATR_exec_vnode))
+		pevn = job_exec_vnode(pjob, execvnod);
+	else
+		pevn = pevntmp = parse_exec_vnode(execvnod);
+	if (pevn == NULL)
 		return;
 
-	chunk = parse_plus_spec_r(execvncopy, &last, &hasprn);
-
-	while (chunk) {
-		if (parse_node_resc(chunk, &vname, &nelem, &pkvp) == 0) {
-			pnode = find_nodebyname(vname);
-			remove_job_index_from_mom(pjob, pnode);
-			deallocate_job_from_node(pjob, pnode);
-			chunk = parse_plus_spec_r(last, &last, &hasprn);
-		}
+	for (i = 0; i < pevn->evn_nchunk; i++) {
+		pnode = pevn->evn_chunk[i].ec_pnode;
+		remove_job_index_from_mom(pjob, pnode);
+		deallocate_job_from_node(pjob, pnode);
 	}
-	free(execvncopy);
+	free_exec_vnode(pevntmp);
 	pjob->ji_qs.ji_svrflags &= ~JOB_SVFLG_HasNodes;
 }
 
@@ -7159,15 +7186,173 @@ check_for_negative_resource(resource_def *prdef, resource *presc, char *noden)
 	}
 }
 
+/* bumped when vnodes or resource definitions come or go, see job_exec_vnode() */
+static long exec_vnode_gen = 1;
+
+/**
+ * @brief
+ * 		invalidate_exec_vnode_caches - make every parsed exec_vnode be
+ *		parsed again on its next use, the vnode and resource definition
+ *		pointers it holds may be stale.
+ *
+ * @return	void
+ */
+void
+invalidate_exec_vnode_caches(void)
+{
+	exec_vnode_gen++;
+}
+
+/**
+ * @brief
+ * 		free_exec_vnode - free a parsed exec_vnode
+ *
+ * @param[in]	pevn	- parsed exec_vnode, may be NULL
+ *
+ * @return	void
+ */
+void
+free_exec_vnode(exec_vnode_cache *pevn)
+{
+	int i;
+
+	if (pevn == NULL)
+		return;
+	for (i = 0; i < pevn->evn_nchunk; i++)
+		free(pevn->evn_chunk[i].ec_resc);
+	free(pevn->evn_chunk);
+	free(pevn->evn_buf);
+	free(pevn->evn_str);
+	free(pevn);
+}
+
+/**
+ * @brief
+ * 		parse_exec_vnode - parse an exec_vnode string into its chunks,
+ *		looking up each chunk's vnode and the definitions of the
+ *		resources assigned from it.
+ *
+ * @param[in]	execvnode	- exec_vnode string, it is not modified
+ *
+ * @return	exec_vnode_cache *
+ * @retval	!NULL	- parsed exec_vnode, free with free_exec_vnode()
+ * @retval	NULL	- parse error or out of memory
+ */
+exec_vnode_cache *
+parse_exec_vnode(char *execvnode)
+{
+	exec_vnode_cache *pevn;
+	exec_vnode_chunk *pch;
+	struct key_value_pair *pkvp = NULL;
+	char *chunk;
+	char *last;
+	char *vname;
+	int hasprn;
+	int nelem;
+	int nkvp = 0;
+	int nalloc = 0;
+	int j;
+
+	if (execvnode == NULL)
+		return NULL;
+	if ((pevn = calloc(1, sizeof(exec_vnode_cache))) == NULL) {
+		log_err(errno, __func__, MALLOC_ERR_MSG);
+		return NULL;
+	}
+	pevn->evn_gen = exec_vnode_gen;
+	if (((pevn->evn_str = strdup(execvnode)) == NULL) ||
+		((pevn->evn_buf = strdup(execvnode)) == NULL)) {
+		log_err(errno, __func__, MALLOC_ERR_MSG);
+		goto parse_exec_vnode_err;
+	}
+
+	for (chunk = parse_plus_spec_r(pevn->evn_buf, &last, &hasprn); chunk != NULL;
+		chunk = parse_plus_spec_r(last, &last, &hasprn)) {
+		vname = NULL;
+		if (parse_node_resc_r(chunk, &vname, &nelem, &nkvp, &pkvp) != 0)
+			goto parse_exec_vnode_err;
+		if (vname == NULL)
+			continue;	/* empty chunk */
+
+		if (pevn->evn_nchunk == nalloc) {
+			exec_vnode_chunk *tmp;
+
+			nalloc = nalloc ? nalloc * 2 : 8;
+			tmp = realloc(pevn->evn_chunk, nalloc * sizeof(exec_vnode_chunk));
+			if (tmp == NULL) {
+				log_err(errno, __func__, MALLOC_ERR_MSG);
+				goto parse_exec_vnode_err;
+			}
+			pevn->evn_chunk = tmp;
+		}
+		pch = &pevn->evn_chunk[pevn->evn_nchunk++];
+		pch->ec_vname = vname;
+		pch->ec_pnode = find_nodebyname(vname);
+		pch->ec_hasprn = hasprn;
+		pch->ec_nresc = 0;
+		pch->ec_resc = NULL;
+		if (nelem == 0)
+			continue;
+		if ((pch->ec_resc = malloc(nelem * sizeof(exec_vnode_resc))) == NULL) {
+			log_err(errno, __func__, MALLOC_ERR_MSG);
+			goto parse_exec_vnode_err;
+		}
+		for (j = 0; j < nelem; j++) {
+			pch->ec_resc[j].er_name = pkvp[j].kv_keyw;
+			pch->ec_resc[j].er_val = pkvp[j].kv_val;
+			pch->ec_resc[j].er_def = find_resc_def(svr_resc_def, pkvp[j].kv_keyw);
+		}
+		pch->ec_nresc = nelem;
+	}
+	free(pkvp);
+	return pevn;
+
+parse_exec_vnode_err:
+	free(pkvp);
+	free_exec_vnode(pevn);
+	return NULL;
+}
+
 /**
  * @brief
- * 		adjust the resources_assigned on a node.
+ * 		job_exec_vnode - return the job's parsed exec_vnode.  It is parsed
+ *		once and kept with the job until the exec_vnode string changes,
+ *		or vnodes or resource definitions are added or deleted.
+ *
+ * @param[in]	pjob	- job
+ * @param[in]	execvnode	- the job's exec_vnode string
+ *
+ * @return	exec_vnode_cache *
+ * @retval	!NULL	- parsed exec_vnode, owned by the job and valid until
+ *			  the next job_exec_vnode() call for it
+ * @retval	NULL	- parse error or out of memory
+ */
+exec_vnode_cache *
+job_exec_vnode(job *pjob, char *execvnode)
+{
+	exec_vnode_cache *pevn = pjob->ji_execvn;
+
+	if (execvnode == NULL)
+		return NULL;
+	if (pevn != NULL) {
+		if ((pevn->evn_gen == exec_vnode_gen) && (strcmp(pevn->evn_str, execvnode) == 0))
+			return pevn;
+		free_exec_vnode(pevn);
+	}
+	pjob->ji_execvn = parse_exec_vnode(execvnode);
+	return pjob->ji_execvn;
+}
+
+/**
+ * @brief
+ * 		adjust the resources_assigned on a vnode.
  *
  * @par
- *		Called with the node name, the node ordinal (0 for first node),
- *		the +/- operator, the resource name, and the resource value.
+ *		Called with the vnode, the node ordinal (0 for first node),
+ *		the +/- operator, the resource definition, and the resource value.
  *
- * @param[out]	noden	- node name
+ * @param[in]	pnode	- vnode, NULL if it does not exist
+ * @param[in]	noden	- vnode name, for logging
  * @param[in]	aflag	- node ordinal (0 for first node)
  * @param[in]	batch_op	- operator of type enum batch_op.
  * @param[in]	prdef	- resource structure which stores resource name
@@ -7179,9 +7364,8 @@ check_for_negative_resource(resource_def *prdef, resource *presc, char *noden)
  * @retval	!=0	- failure code
  */
 static int
-adj_resc_on_node(char *noden, int aflag, enum batch_op op, resource_def *prdef, char *val, int hop)
+adj_resc_on_vnode(pbsnode *pnode, char *noden, int aflag, enum batch_op op, resource_def *prdef, char *val, int hop)
 {
-	pbsnode		*pnode;
 	resource	*presc;
 	attribute	*pattr;
 	int		 rc;
@@ -7205,9 +7389,6 @@ adj_resc_on_node(char *noden, int aflag, enum batch_op op, resource_def *prdef,
 	if ((prdef->rs_flags & aflag) == 0)
 		return 0;
 
-	/* find the node */
-
-	pnode = find_nodebyname(noden);
 	if (pnode == NULL)
 		return PBSE_UNKNODE;
 
@@ -7225,7 +7406,7 @@ adj_resc_on_node(char *noden, int aflag, enum batch_op op, resource_def *prdef,
 		/* indirect reference to another vnode, recurse w/ that node */
 
 		noden = presc->rs_value.at_val.at_str + 1;
-		return (adj_resc_on_node(noden, aflag, op, prdef, val, ++hop));
+		return (adj_resc_on_vnode(find_nodebyname(noden), noden, aflag, op, prdef, val, ++hop));
 	}
 
 	/* decode the resource value and +/- it to the attribute */
@@ -7267,13 +7448,14 @@ void
 update_job_node_rassn(job *pjob, attribute *pexech, enum batch_op op)
 {
 	int	  asgn = ATR_DFLAG_ANASSN | ATR_DFLAG_FNASSN;
-	char     *chunk;
+	int	  i;
 	int       j;
-	int       nelem;
 	char	 *noden;
 	int	  rc;
 	resource_def	*prdef = NULL;
-	struct key_value_pair *pkvp;
+	exec_vnode_cache *pevn;
+	exec_vnode_cache *pevntmp = NULL;
+	exec_vnode_chunk *pch;
 	attribute	*queru = NULL;
 	attribute	*sysru = NULL;
 	resource	*pr = NULL;
@@ -7304,70 +7486,71 @@ update_job_node_rassn(job *pjob, attribute *pexech, enum batch_op op)
 			pc++;
 		}
 	}
-	chunk = parse_plus_spec(pexech->at_val.at_str, &rc);
-	if (rc != 0)
+	/* the job's own exec_vnode is parsed once and kept with the job */
+	if ((pjob != NULL) && (pexech == &pjob->ji_wattr[(int) JOB_ATR_exec_vnode]))
+		pevn = job_exec_vnode(pjob, pexech->at_val.at_str);
+	else
+		pevn = pevntmp = parse_exec_vnode(pexech->at_val.at_str);
+	if (pevn == NULL)
 		return;
-	while (chunk) {
-		if (parse_node_resc(chunk, &noden, &nelem, &pkvp) == 0) {
-			for (j=0; j<nelem; ++j) {
-				prdef = find_resc_def(svr_resc_def, pkvp[j].kv_keyw);
-				if (prdef == NULL)
-					return;
 
-				/* skip all non-consumable resources (e.g. aoe) */
-				if ((prdef->rs_flags & asgn) == 0) {
-					continue;
-				}
+	for (i = 0; i < pevn->evn_nchunk; i++) {
+		pch = &pevn->evn_chunk[i];
+		noden = pch->ec_vname;
+		for (j = 0; j < pch->ec_nresc; ++j) {
+			prdef = pch->ec_resc[j].er_def;
+			if (prdef == NULL)
+				goto update_job_node_rassn_exit;
 
-				if ((rc = adj_resc_on_node(noden, asgn, op, prdef, pkvp[j].kv_val, 0)) != 0)
-					return;
-				/* update system attribute of resources assigned */
+			/* skip all non-consumable resources (e.g. aoe) */
+			if ((prdef->rs_flags & asgn) == 0) {
+				continue;
+			}
 
-				if (sysru || queru) {
-					if ((rc = prdef->rs_decode(&tmpattr, ATTR_rescassn, pkvp[j].kv_keyw,
-											pkvp[j].kv_val)) != 0)
-						return;
-				}
+			if ((rc = adj_resc_on_vnode(pch->ec_pnode, noden, asgn, op, prdef, pch->ec_resc[j].er_val, 0)) != 0)
+				goto update_job_node_rassn_exit;
+			/* update system attribute of resources assigned */
 
-				if (sysru) {
-					pr = find_resc_entry(sysru, prdef);
-					if (pr == NULL) {
-						pr = add_resource_entry(sysru, prdef);
-						if (pr == NULL)
-							return;
-					}
-					prdef->rs_set(&pr->rs_value, &tmpattr, op);
-					if (op == DECR) {
-						check_for_negative_resource(prdef, pr, NULL);
-					}
-					sysru->at_flags |= ATR_SET_MOD_MCACHE;
+			if (sysru || queru) {
+				if ((rc = prdef->rs_decode(&tmpattr, ATTR_rescassn, pch->ec_resc[j].er_name,
+										pch->ec_resc[j].er_val)) != 0)
+					goto update_job_node_rassn_exit;
+			}
+
+			if (sysru) {
+				pr = find_resc_entry(sysru, prdef);
+				if (pr == NULL) {
+					pr = add_resource_entry(sysru, prdef);
+					if (pr == NULL)
+						goto update_job_node_rassn_exit;
+				}
+				prdef->rs_set(&pr->rs_value, &tmpattr, op);
+				if (op == DECR) {
+					check_for_negative_resource(prdef, pr, NULL);
 				}
+				sysru->at_flags |= ATR_SET_MOD_MCACHE;
+			}
 
-				/* update queue attribute of resources assigned */
+			/* update queue attribute of resources assigned */
 
-				if (queru) {
-					pr = find_resc_entry(queru, prdef);
-					if (pr == NULL) {
-						pr = add_resource_entry(queru, prdef);
-						if (pr == NULL)
-							return;
-					}
-					prdef->rs_set(&pr->rs_value, &tmpattr, op);
-					if (op == DECR) {
-						check_for_negative_resource(prdef, pr, NULL);
-					}
-					queru->at_flags |= ATR_SET_MOD_MCACHE;
+			if (queru) {
+				pr = find_resc_entry(queru, prdef);
+				if (pr == NULL) {
+					pr = add_resource_entry(queru, prdef);
+					if (pr == NULL)
+						goto update_job_node_rassn_exit;
 				}
-
+				prdef->rs_set(&pr->rs_value, &tmpattr, op);
+				if (op == DECR) {
+					check_for_negative_resource(prdef, pr, NULL);
+				}
+				queru->at_flags |= ATR_SET_MOD_MCACHE;
 			}
-		} else {
-			return;
+
 		}
 		asgn = ATR_DFLAG_ANASSN;
-		chunk = parse_plus_spec(NULL, &rc);
-		if (rc != 0)
-			return;
 	}
+	free_exec_vnode(pevntmp);
 
 	if (sysru || queru) {
 		/* set pseudo-resource "nodect" to the number of chunks */
@@ -7406,6 +7589,9 @@ update_job_node_rassn(job *pjob, attribute *pexech, enum batch_op op)
 		}
 	}
 	return;
+
+update_job_node_rassn_exit:
+	free_exec_vnode(pevntmp);
 }
 
 /**
@@ -83,6 +83,9 @@
 #include "libutil.h"
 #include "pbs_db.h"
 
+extern pbs_list_head svr_dirty_nodes;
+extern long svr_node_saves_coalesced;
+
 struct pbsnode *recov_node_cb(pbs_db_obj_info_t *dbobj, int *refreshed);
 struct pbsnode *pbsd_init_node(pbs_db_node_info_t *dbnode, int type);
 
@@ -311,7 +314,34 @@ node_to_db(struct pbsnode *pnode, pbs_db_node_info_t *pdbnd)
 
 /**
  * @brief
- *	Save a node to the database. When we save a node to the database, delete
+ *	Save node to database, or queue it for the next periodic node flush
+ *	done by flush_db_saves() when saves are being deferred. New nodes are
+ *	always saved at once so that id clashes are reported to the caller.
+ *
+ * @param[in]	pnode - The node to save
+ *
+ * @return      Error code
+ * @retval	 0 - Success (or queued)
+ * @retval	-1 - Failure
+ *
+ */
+int
+node_save_db(struct pbsnode *pnode)
+{
+	if (pnode->newobj || !db_saves_deferred())
+		return (node_save_db_now(pnode));
+
+	if (pnode->nd_dirtynodes.ll_next == &pnode->nd_dirtynodes)
+		append_link(&svr_dirty_nodes, &pnode->nd_dirtynodes, pnode);
+	else
+		svr_node_saves_coalesced++;
+
+	return 0;
+}
+
+/**
+ * @brief
+ *	Write a node to the database now. When we save a node to the database, delete
  *	the old node information and write the node afresh. This ensures that
  *	any deleted attributes of the node are removed, and only the new ones are
  *	updated to the database.
@@ -324,7 +354,7 @@ node_to_db(struct pbsnode *pnode, pbs_db_node_info_t *pdbnd)
  *
  */
 int
-node_save_db(struct pbsnode *pnode)
+node_save_db_now(struct pbsnode *pnode)
 {
 	pbs_db_node_info_t dbnode = {{0}};
 	pbs_db_obj_info_t obj;
@@ -333,6 +363,8 @@ node_save_db(struct pbsnode *pnode)
 	int savetype;
 	int rc = -1;
 
+	delete_link(&pnode->nd_dirtynodes);
+
 	if ((savetype = node_to_db(pnode, &dbnode))  == -1)
 		goto done;
 
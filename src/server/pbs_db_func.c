@@ -112,7 +112,19 @@
 static int db_oper_failed_times = 0;
 static int last_rc = -1; /* we need to reset db_oper_failed_times for each state change of the db */
 static int conn_db_state = 0;
+static pid_t db_saves_pid = 0; /* process that defers saves, 0 if none */
+pbs_list_head svr_dirty_jobs;	/* jobs with a save pending */
+pbs_list_head svr_dirty_resvs;	/* reservations with a save pending */
+pbs_list_head svr_dirty_nodes;	/* nodes with a save pending */
+long svr_node_saves_coalesced;	/* node saves folded into an already queued one */
+static long node_saves_written;	/* queued node saves written out */
+static time_t node_flush_due;	/* when queued node saves are next written */
+static int node_flush_urgent;	/* write queued node saves at the next flush */
+static char (*dead_jobs)[PBS_MAXSVRJOBID + 1];	/* ids of purged jobs to delete */
+static int dead_jobs_ct;	/* number of ids queued in dead_jobs */
+static int dead_jobs_sz;	/* number of ids dead_jobs has room for */
 extern int pbs_failover_active;
+extern char *msg_err_purgejob_db;
 extern int server_init_type;
 extern int stalone;	/* is program running not as a service ? */
 char conn_db_host[PBS_MAXSERVERNAME+1];	/* db host where connection is made */
@@ -591,3 +603,240 @@ free_db_attr_list(pbs_db_attr_list_t *attr_list)
 		attr_list->attr_count = 0;
 	}
 }
+
+/**
+ * @brief
+ *	Start deferring saves of existing jobs, reservations and nodes.
+ *	From here on job_save_db(), resv_save_db() and node_save_db() only
+ *	queue the object; flush_db_saves() writes the queued objects out.
+ *
+ * @par MT-safe: No
+ *
+ */
+void
+defer_db_saves(void)
+{
+	CLEAR_HEAD(svr_dirty_jobs);
+	CLEAR_HEAD(svr_dirty_resvs);
+	CLEAR_HEAD(svr_dirty_nodes);
+	db_saves_pid = getpid();
+	node_flush_due = time(NULL) + SVR_NODE_SAVE_FLUSH_TM;
+}
+
+/**
+ * @brief
+ *	Have the next flush_db_saves() write the queued node saves, instead
+ *	of waiting for the periodic node flush. Used for changes made by an
+ *	administrator, which are reported as done only once they are stored.
+ *
+ * @par MT-safe: No
+ *
+ */
+void
+urgent_node_saves(void)
+{
+	node_flush_urgent = 1;
+}
+
+/**
+ * @brief
+ *	Tell whether saves are currently being deferred by this process.
+ *	A child forked off the server never defers, so anything it saves
+ *	goes straight to the database.
+ *
+ * @return	int
+ * @retval	1 - saves are deferred
+ * @retval	0 - saves are written at once
+ *
+ */
+int
+db_saves_deferred(void)
+{
+	return (db_saves_pid != 0 && db_saves_pid == getpid());
+}
+
+/**
+ * @brief
+ *	Queue a purged job for deletion from the database by the next
+ *	flush_db_saves(), so deleting many jobs costs one transaction rather
+ *	than one per job.
+ *
+ * @param[in]	jobid - id of the purged job
+ *
+ * @return	int
+ * @retval	0 - queued
+ * @retval	-1 - saves are not deferred or no memory, delete it now
+ *
+ * @par MT-safe: No
+ *
+ */
+int
+defer_job_delete(char *jobid)
+{
+	char (*tmp)[PBS_MAXSVRJOBID + 1];
+	int sz;
+
+	if (!db_saves_deferred())
+		return -1;
+
+	if (dead_jobs_ct == dead_jobs_sz) {
+		sz = (dead_jobs_sz == 0) ? 64 : dead_jobs_sz * 2;
+		tmp = realloc(dead_jobs, sz * sizeof(*dead_jobs));
+		if (tmp == NULL)
+			return -1;
+		dead_jobs = tmp;
+		dead_jobs_sz = sz;
+	}
+	snprintf(dead_jobs[dead_jobs_ct++], PBS_MAXSVRJOBID + 1, "%s", jobid);
+	return 0;
+}
+
+/**
+ * @brief
+ *	Tell whether a job id is queued for deletion. A new job reusing the
+ *	id must not be inserted before the old row is gone.
+ *
+ * @param[in]	jobid - job id to look for
+ *
+ * @return	int
+ * @retval	1 - the id is queued for deletion
+ * @retval	0 - it is not
+ *
+ */
+int
+job_delete_pending(char *jobid)
+{
+	int i;
+
+	for (i = 0; i < dead_jobs_ct; i++) {
+		if (strcmp(dead_jobs[i], jobid) == 0)
+			return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ *	Delete the jobs queued by defer_job_delete() from the database,
+ *	within the transaction of the caller.
+ *
+ * @par
+ *	A failed delete aborts the transaction and so every save queued with
+ *	it, so it is handled as a failed save is: the server panics rather
+ *	than carry on with state that is not on disk.
+ *
+ * @return	void
+ *
+ */
+static void
+flush_job_deletes(void)
+{
+	pbs_db_obj_info_t obj;
+	pbs_db_job_info_t dbjob;
+	char *conn_db_err = NULL;
+	int i;
+
+	obj.pbs_db_obj_type = PBS_DB_JOB;
+	obj.pbs_db_un.pbs_db_job = &dbjob;
+	for (i = 0; i < dead_jobs_ct; i++) {
+		strcpy(dbjob.ji_jobid, dead_jobs[i]);
+		if (pbs_db_delete_obj(svr_db_conn, &obj) == -1) {
+			pbs_db_get_errmsg(PBS_DB_ERR, &conn_db_err);
+			log_errf(PBSE_INTERNAL, __func__, "%s, job %s %s", msg_err_purgejob_db,
+				dead_jobs[i], conn_db_err ? conn_db_err : "");
+			free(conn_db_err);
+			panic_stop_db();
+		}
+	}
+	dead_jobs_ct = 0;
+}
+
+/**
+ * @brief
+ *	Write out every job and reservation queued since the last flush
+ *	and delete the purged jobs in a single database transaction, along
+ *	with the queued nodes when they are due.
+ *
+ * @par Functionality:
+ *	Called once per main loop iteration, before any reply to a request
+ *	that may change state (client, scheduler or MoM) and before a job is
+ *	sent to a MoM, so nobody sees an acknowledgement for a change that
+ *	is not yet on disk. In a forked child the queued entries belong to the
+ *	parent, they are dropped without being written.
+ *
+ *	Node state changes driven by Moms come in storms (a rack losing
+ *	power, a switch flapping) and are reported again by the Moms after
+ *	a restart, so queued nodes are only written every
+ *	SVR_NODE_SAVE_FLUSH_TM seconds, unless urgent_node_saves() was
+ *	called. Saves of a node already queued are counted as coalesced.
+ *
+ * @return	void
+ *
+ * @par MT-safe: No
+ *
+ */
+void
+flush_db_saves(void)
+{
+	job *pjob;
+	resc_resv *presv;
+	struct pbsnode *pnode;
+	int trx;
+	int do_nodes;
+	int nnodes = 0;
+	time_t now;
+
+	if (db_saves_pid == 0)
+		return;
+
+	now = time(NULL);
+	do_nodes = 0;
+	if (GET_NEXT(svr_dirty_nodes) != NULL) {
+		if (node_flush_urgent || now >= node_flush_due || db_saves_pid != getpid())
+			do_nodes = 1;
+	}
+	if (GET_NEXT(svr_dirty_jobs) == NULL && GET_NEXT(svr_dirty_resvs) == NULL &&
+		dead_jobs_ct == 0 && !do_nodes)
+		return;
+
+	if (db_saves_pid != getpid()) {
+		dead_jobs_ct = 0;
+		while ((pjob = (job *) GET_NEXT(svr_dirty_jobs)) != NULL)
+			delete_link(&pjob->ji_dirtyjobs);
+		while ((presv = (resc_resv *) GET_NEXT(svr_dirty_resvs)) != NULL)
+			delete_link(&presv->ri_dirtyresvs);
+		while ((pnode = (struct pbsnode *) GET_NEXT(svr_dirty_nodes)) != NULL)
+			delete_link(&pnode->nd_dirtynodes);
+		return;
+	}
+
+	trx = (pbs_db_begin_trx(svr_db_conn) == 0);
+
+	flush_job_deletes();
+
+	/* each *_save_db_now() unlinks the object it writes */
+	while ((pjob = (job *) GET_NEXT(svr_dirty_jobs)) != NULL)
+		job_save_db_now(pjob);
+	while ((presv = (resc_resv *) GET_NEXT(svr_dirty_resvs)) != NULL)
+		resv_save_db_now(presv);
+	if (do_nodes) {
+		while ((pnode = (struct pbsnode *) GET_NEXT(svr_dirty_nodes)) != NULL) {
+			node_save_db_now(pnode);
+			nnodes++;
+		}
+		node_flush_urgent = 0;
+		node_flush_due = now + SVR_NODE_SAVE_FLUSH_TM;
+	}
+
+	if (trx && pbs_db_end_trx(svr_db_conn, PBS_DB_COMMIT) != 0) {
+		log_err(-1, __func__, "Failed to commit deferred saves");
+		panic_stop_db();
+	}
+
+	if (nnodes > 0) {
+		node_saves_written += nnodes;
+		log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SERVER, LOG_DEBUG, __func__,
+			"wrote %d nodes; node saves written %ld, coalesced %ld",
+			nnodes, node_saves_written, svr_node_saves_coalesced);
+	}
+}
@@ -166,7 +166,6 @@ extern void offline_all_provisioning_vnodes(void);
 extern void stop_db();
 extern job *job_recov_db_spl(pbs_db_job_info_t *dbjob, job *pjob);
 extern pbs_sched *sched_alloc(char *sched_name);
-extern job *recov_job_cb(pbs_db_obj_info_t *, int *);
 extern resc_resv *recov_resv_cb(pbs_db_obj_info_t *, int *);
 extern pbs_queue *recov_queue_cb(pbs_db_obj_info_t *, int *);
 extern pbs_sched *recov_sched_cb(pbs_db_obj_info_t *, int *);
@@ -183,6 +182,7 @@ static int   pbsd_init_reque(job *job, int change_state);
 static void  resume_net_move(struct work_task *);
 static void  stop_me(int);
 static int   Rmv_if_resv_not_possible(job *);
+static void  log_init_phase(char *, struct timeval *);
 static int   attach_queue_to_reservation(resc_resv *);
 static void  call_log_license(struct work_task *);
 /* private data */
@@ -325,7 +325,6 @@ pbsd_init(int type)
 	struct sigaction oact;
 
 	struct tm	*ptm;
-	pbs_db_job_info_t	dbjob = {{0}};
 	pbs_db_resv_info_t	dbresv = {{0}};
 	pbs_db_que_info_t	dbque = {{0}};
 	pbs_db_sched_info_t	dbsched = {{0}};
@@ -333,6 +332,8 @@ pbsd_init(int type)
 	void	*conn = (void *) svr_db_conn;
 	char *buf = NULL;
 	int buf_len = 0;
+	struct timeval tv_init;		/* start of the recovery */
+	struct timeval tv_phase;	/* start of the current recovery phase */
 
 #ifdef  RLIMIT_CORE
 	int      char_in_cname = 0;
@@ -526,6 +527,9 @@ pbsd_init(int type)
 
 	init_server_attrs();
 
+	gettimeofday(&tv_init, NULL);
+	tv_phase = tv_init;
+
 	/* 5. If not a "create" initialization, recover server db */
 	/*    and sched db					  */
 	rc = svr_recov_db();
@@ -595,6 +599,8 @@ pbsd_init(int type)
 		sched_save_db(dflt_scheduler);
 	}
 
+	log_init_phase("server and schedulers", &tv_phase);
+
 	/* 4. Check License information */
 
 	reset_license_counters(&license_counts);
@@ -686,6 +692,7 @@ pbsd_init(int type)
 		}
 		return (-1);
 	}
+	log_init_phase("queues", &tv_phase);
 
 	/* Open and read in node list if one exists */
 	if ((rc = setup_nodes()) == -1) {
@@ -694,6 +701,7 @@ pbsd_init(int type)
 		return (-1);
 	}
 	mark_which_queues_have_nodes();
+	log_init_phase("nodes", &tv_phase);
 
 	/* at this point, we know all the resource types have been defined,        */
 	/* build the resource summation table for validating the Select directives */
@@ -724,6 +732,7 @@ pbsd_init(int type)
 		}
 		return (-1);
 	}
+	log_init_phase("reservations", &tv_phase);
 
 	/*
 	 * 9. If not "create" or "clean" recovery, recover the jobs.
@@ -734,13 +743,15 @@ pbsd_init(int type)
 		log_err(-1, __func__, "Creating jobs index failed!");
 		return (-1);
 	}
+	if (init_job_indexes() != 0) {
+		log_err(-1, __func__, "Creating job owners index failed!");
+		return (-1);
+	}
 
 	server.sv_qs.sv_numjobs = 0;
 
-	/* get jobs from DB */
-	obj.pbs_db_obj_type = PBS_DB_JOB;
-	obj.pbs_db_un.pbs_db_job = &dbjob;
-	rc = pbs_db_search(conn, &obj, NULL, (query_cb_t)&recov_job_cb);
+	/* get jobs from DB, decoding them on several threads */
+	rc = recov_jobs_db();
 	if (rc == -1) {
 		pbs_db_get_errmsg(PBS_DB_ERR, &conn_db_err);
 		if (conn_db_err != NULL) {
@@ -748,11 +759,12 @@ pbsd_init(int type)
 			free(conn_db_err);
 		}
 		return (-1);
-	} else if (rc == 1) {
+	} else if (rc == 0) {
 		if ((type != RECOV_CREATE) && (type != RECOV_COLD))
 			log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER,
 				LOG_DEBUG, msg_daemonname, msg_init_nojobs);
 	}
+	log_init_phase("jobs", &tv_phase);
 
 	log_eventf(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_NOTICE, msg_daemonname, msg_init_exptjobs, server.sv_qs.sv_numjobs);
 
@@ -1154,9 +1166,34 @@ pbsd_init(int type)
 
 	(void)set_task(WORK_Immed, time_now, memory_debug_log, NULL);
 
+	log_init_phase("hooks and remaining state", &tv_phase);
+	log_init_phase("all server state", &tv_init);
+
 	return (0);
 }
 
+/**
+ * @brief
+ *		Log how long a phase of the server recovery took and start
+ *		timing the next one.
+ *
+ * @param[in]		phase - what was recovered
+ * @param[in,out]	since - start of the phase, reset to now
+ *
+ * @return	void
+ */
+static void
+log_init_phase(char *phase, struct timeval *since)
+{
+	struct timeval now;
+
+	gettimeofday(&now, NULL);
+	log_eventf(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_INFO, msg_daemonname,
+		"Recovered %s in %.3f seconds", phase,
+		(now.tv_sec - since->tv_sec) + (now.tv_usec - since->tv_usec) / 1e6);
+	*since = now;
+}
+
 /**
  * @brief
  * 		reassign_resc - for a recovered running job, reassign the resources and
@@ -1459,6 +1496,7 @@ pbsd_init_job(job *pjob, int type)
 			case JOB_SUBSTATE_TERMINATED:
 				if (pbsd_init_reque(pjob, KEEP_STATE) == -1)
 					return -1;
+				set_histjob_freeze_task(pjob);
 				break;
 
 			case JOB_SUBSTATE_RERUN:
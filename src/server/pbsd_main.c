@@ -86,6 +86,7 @@
 #include "credential.h"
 #include "batch_request.h"
 #include "pbs_idx.h"
+#include "avltree.h"
 #include "pbs_nodes.h"
 #include "svrfunc.h"
 #include <libutil.h>
@@ -661,6 +662,12 @@ main(int argc, char **argv)
 	/* set standard umask */
 	umask(022);
 
+	/*
+	 * The job decode threads of recov_jobs_db() look up the attribute
+	 * indexes, size the avl trees for every thread before any is made
+	 */
+	avl_set_maxthreads(PBS_SVR_MAX_THREADS);
+
 	/* set single threaded mode */
 	pbs_client_thread_set_single_threaded_mode();
 	/* disable attribute verification */
@@ -1323,7 +1330,10 @@ main(int argc, char **argv)
 	 *		back to an inactive state.
 	 * If state includes SV_STATE_PRIMDLY, stay in loop; this will be
 	 * cleared when Secondary Server responds to a request.
+	 * Saves of existing objects are queued while in the loop and written
+	 * out together once per iteration by flush_db_saves().
 	 */
+	defer_db_saves();
 	while ((*state != SV_STATE_DOWN) && (*state != SV_STATE_SECIDLE)) {
 
 		/*
@@ -1344,6 +1354,10 @@ main(int argc, char **argv)
 		/* first process any task whose time delay has expired */
 		waittime = next_task();
 
+		/* carry on with large qdel requests, don't wait if more is left */
+		if (resume_deletejob_lists())
+			waittime = 0;
+
 		if (*state == SV_STATE_RUN) {	/* In normal Run State */
 
 			if (first_run) {
@@ -1415,6 +1429,9 @@ main(int argc, char **argv)
 		if (reap_child_flag)
 			reap_child();
 
+		/* write out whatever was saved since the last pass */
+		flush_db_saves();
+
 		/* wait for a request and process it */
 		if (wait_request(waittime, priority_context) != 0) {
 			log_err(-1, msg_daemonname, "wait_requst failed");
@@ -1445,6 +1462,9 @@ main(int argc, char **argv)
 	}
 	DBPRT(("Server out of main loop, state is %ld\n", *state))
 
+	urgent_node_saves();
+	flush_db_saves();
+
 	/* set the current seq id to the last id before final save */
 	server.sv_qs.sv_lastid = server.sv_qs.sv_jobidnumber;
 	svr_save_db(&server);	/* final recording of server */
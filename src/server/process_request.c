@@ -58,6 +58,9 @@
  *	process_request()
  *	set_to_non_blocking()
  *	clear_non_blocking()
+ *	post_snapshot_child()
+ *	snapshot_may_thaw()
+ *	serve_from_snapshot()
  *	dispatch_request()
  *	close_client()
  *	alloc_br()
@@ -110,6 +113,7 @@
 #include <libutil.h>
 #include "pbs_sched.h"
 #include "auth.h"
+#include "work_task.h"
 
 /* global data items */
 
@@ -129,6 +133,9 @@ extern char  *msg_auth_request;
 
 extern int    is_local_root(char *, char *);
 extern void   req_stat_hook(struct batch_request *);
+#ifndef PBS_MOM
+extern void  *svr_db_conn;
+#endif
 
 /* Private functions local to this file */
 
@@ -136,6 +143,9 @@ static void freebr_manage(struct rq_manage *);
 static void freebr_cpyfile(struct rq_cpyfile *);
 static void freebr_cpyfile_cred(struct rq_cpyfile_cred *);
 static void close_quejob(int sfds);
+#ifndef PBS_MOM
+static int snapshot_children = 0;	/* children serving status requests */
+#endif
 
 /**
  * @brief
@@ -764,6 +774,168 @@ clear_non_blocking(conn_t *conn)
 		conn->cn_sockflgs = 0;
 	}
 }
+
+/**
+ * @brief
+ *		Work task run when a child serving a status request has exited.
+ *
+ * @param[in]	ptask	- the WORK_Deferred_Child task of the child
+ */
+static void
+post_snapshot_child(struct work_task *ptask)
+{
+	if (snapshot_children > 0)
+		snapshot_children--;
+}
+
+/**
+ * @brief
+ *		Check whether serving a request over the history may thaw frozen
+ *		jobs, see job_thaw(); that reads the database over the server's
+ *		connection, which a child must not use.
+ *
+ * @param[in]	request	- a status or select request
+ *
+ * @return	int
+ * @retval	1	- some frozen job may be thawed
+ * @retval	0	- frozen jobs are served as they are
+ */
+static int
+snapshot_may_thaw(struct batch_request *request)
+{
+	svrattrl *pal;
+	int index;
+
+	if (request->rq_extend == NULL || strchr(request->rq_extend, 'x') == NULL)
+		return 0;
+	/* the subjobs of a finished Array Job are statused from its attributes */
+	if (strchr(request->rq_extend, 't') || strchr(request->rq_extend, 'T'))
+		return 1;
+	if (request->rq_type == PBS_BATCH_StatusJob)
+		return 0;
+
+	pal = (svrattrl *)GET_NEXT(request->rq_ind.rq_select.rq_selattr);
+	for (; pal != NULL; pal = (svrattrl *)GET_NEXT(pal->al_link)) {
+		index = find_attr(job_attr_idx, job_attr_def, pal->al_name);
+		if (index < 0)
+			continue;	/* rejected before any job is looked at */
+		if (index != JOB_ATR_userlst && !is_frozen_kept_jattr(index))
+			return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ *		Serve a read-only request over many jobs or nodes from a forked
+ *		child, which sees a copy-on-write snapshot of the server, so the
+ *		main loop can go on with other requests while the reply is built
+ *		and sent.
+ *
+ * @par
+ *		This stands for a pool of reader threads.  Jobs, nodes, their
+ *		attributes and the caches hung off them are changed from all
+ *		over the server without any locking, and a status request
+ *		itself writes to them (eligible time, status caches, history
+ *		jobs being thawed), so readers in threads would need every one
+ *		of those writers made safe for concurrent readers.  fork() gives
+ *		each reader a consistent snapshot for the price of the page
+ *		table copy, the kernel reclaims it when the child exits, and the
+ *		main loop reaps the child through WORK_Deferred_Child.  The
+ *		request is only handed off when it covers enough objects for
+ *		building the reply to outweigh the fork().
+ *
+ * @par
+ *		Only requests from remote, unencrypted TCP clients which are not
+ *		a scheduler are handed to a child; an encrypted channel carries
+ *		state which the child can not give back, and the scheduler's
+ *		requests have side effects on the server (see req_selectjobs()).
+ *		Neither are requests which may thaw a frozen history job.  The
+ *		child writes the whole reply before it exits; the client does
+ *		not send its next request on the connection before that.
+ *
+ * @param[in]	sfds	- socket connection
+ * @param[in]	request	- the request
+ * @param[in]	func	- the request handler
+ * @param[in]	nonblock - set the socket non-blocking while handling
+ *
+ * @return	int
+ * @retval	1	- the request was handed to a child and freed
+ * @retval	0	- serve the request here
+ */
+static int
+serve_from_snapshot(int sfds, struct batch_request *request, void (*func)(struct batch_request *), int nonblock)
+{
+	conn_t *conn;
+	pid_t pid;
+	int nobjs;
+	char *id;
+
+	if (request->prot != PROT_TCP || sfds == PBS_LOCAL_CONNECTION)
+		return 0;
+	if (snapshot_children >= PBS_SNAPSHOT_MAX_CHILDREN)
+		return 0;
+
+	switch (request->rq_type) {
+		case PBS_BATCH_StatusJob:
+			id = request->rq_ind.rq_status.rq_id;
+			if (isdigit((int) *id))
+				return 0;	/* named jobs */
+			nobjs = server.sv_qs.sv_numjobs;
+			break;
+		case PBS_BATCH_StatusNode:
+			id = request->rq_ind.rq_status.rq_id;
+			if (*id != '\0' && *id != '@')
+				return 0;	/* a named node */
+			nobjs = svr_totnodes;
+			break;
+		case PBS_BATCH_SelectJobs:
+		case PBS_BATCH_SelStat:
+			nobjs = server.sv_qs.sv_numjobs;
+			break;
+		default:
+			return 0;
+	}
+	if (nobjs < PBS_SNAPSHOT_MIN_OBJS)
+		return 0;
+
+	if (find_sched_from_sock(sfds, CONN_SCHED_ANY) != NULL ||
+		transport_chan_is_encrypted(sfds) || conn_queued_len(sfds) > 0)
+		return 0;
+	if (request->rq_type != PBS_BATCH_StatusNode && snapshot_may_thaw(request))
+		return 0;
+
+	pid = fork();
+	if (pid == -1) {
+		log_err(errno, __func__, "fork failed, serving request in server");
+		return 0;
+	}
+
+	if (pid != 0) {		/* The parent (main server) */
+		if (set_task(WORK_Deferred_Child, (long) pid, post_snapshot_child, NULL) == NULL)
+			log_err(errno, __func__, msg_err_malloc);
+		else
+			snapshot_children++;
+		free_br(request);
+		return 1;
+	}
+
+	/* the child, leaves the other connections alone */
+	tpp_terminate();
+	daemon_protect(0, PBS_DAEMON_PROTECT_OFF);
+	svr_db_conn = NULL;
+
+	conn = get_conn(sfds);
+	if (nonblock && set_to_non_blocking(conn) == -1) {
+		req_reject(PBSE_SYSTEM, 0, request);
+		exit(1);
+	}
+	func(request);
+	if (nonblock)
+		clear_non_blocking(get_conn(sfds));
+	(void) conn_flush_queued(sfds, PBS_DIS_TCP_TIMEOUT_REPLY);
+	exit(0);
+}
 #endif	/* !PBS_MOM */
 
 /**
@@ -973,6 +1145,8 @@ dispatch_request(int sfds, struct batch_request *request)
 
 		case PBS_BATCH_SelectJobs:
 		case PBS_BATCH_SelStat:
+			if (serve_from_snapshot(sfds, request, req_selectjobs, 0))
+				break;
 			req_selectjobs(request);
 			break;
 
@@ -996,6 +1170,8 @@ dispatch_request(int sfds, struct batch_request *request)
 #ifndef PBS_MOM		/* Server Only Functions */
 
 		case PBS_BATCH_StatusJob:
+			if (serve_from_snapshot(sfds, request, req_stat_job, 1))
+				break;
 			if (set_to_non_blocking(conn) == -1) {
 				req_reject(PBSE_SYSTEM, 0, request);
 				close_client(sfds);
@@ -1016,6 +1192,8 @@ dispatch_request(int sfds, struct batch_request *request)
 			break;
 
 		case PBS_BATCH_StatusNode:
+			if (serve_from_snapshot(sfds, request, req_stat_node, 1))
+				break;
 			if (set_to_non_blocking(conn) == -1) {
 				req_reject(PBSE_SYSTEM, 0, request);
 				close_client(sfds);
@@ -96,6 +96,43 @@ extern volatile int reply_timedout; /* global to notify DIS routines reply took
 #endif
 #define ERR_MSG_SIZE 256
 
+#ifndef PBS_MOM
+/**
+ * @brief
+ * 		Tell whether a request of this type only reads server state, so
+ *		its reply does not have to wait for the queued saves
+ *
+ * @param[in]	rq_type - the batch request type
+ *
+ * @return	int
+ * @retval	1 - the request changes nothing that is saved
+ * @retval	0 - the request may have changed saved state
+ */
+static int
+is_readonly_request(int rq_type)
+{
+	switch (rq_type) {
+		case PBS_BATCH_Connect:
+		case PBS_BATCH_Authenticate:
+		case PBS_BATCH_Disconnect:
+		case PBS_BATCH_LocateJob:
+		case PBS_BATCH_SelectJobs:
+		case PBS_BATCH_SelStat:
+		case PBS_BATCH_StatusJob:
+		case PBS_BATCH_StatusQue:
+		case PBS_BATCH_StatusSvr:
+		case PBS_BATCH_StatusNode:
+		case PBS_BATCH_StatusResv:
+		case PBS_BATCH_StatusSched:
+		case PBS_BATCH_StatusRsc:
+		case PBS_BATCH_StatusHook:
+			return 1;
+		default:
+			return 0;
+	}
+}
+#endif	/* PBS_MOM */
+
 
 /**
  * @brief
@@ -196,14 +233,40 @@ dis_reply_write(int sfds, struct batch_request *preq)
 {
 	int rc;
 	struct batch_reply *preply = &preq->rq_reply;
-#ifndef WIN32
+#if !defined(WIN32) && defined(PBS_MOM)
 	struct sigaction act, oact;
 	time_t  old_tcp_timeout = pbs_tcp_timeout ;
 #endif
+#if !defined(WIN32) && !defined(PBS_MOM)
+	int (*old_send)(int, void *, int);
+#endif
 
 	if (preq->prot == PROT_TPP) {
 		rc = encode_DIS_replyTPP(sfds, preq->tppcmd_msgid, preply);
+		if (rc == 0)
+			rc = dis_flush(sfds);
 	} else {
+#if !defined(WIN32) && !defined(PBS_MOM)
+		/*
+		 * The server never waits on a client to read its reply.  What the
+		 * socket won't take right away is queued on the connection and
+		 * written out from wait_request() when the socket is writable.
+		 * A client which falls too far behind is not read from until it
+		 * catches up, see conn_update_poll_events().
+		 */
+		pbs_tcp_errno = 0;
+		DIS_tcp_funcs();		/* setup for DIS over tcp */
+		old_send = pfn_transport_send;
+		pfn_transport_send = conn_send_queued;
+
+		rc = encode_DIS_reply(sfds, preply);
+		if (rc == 0)
+			rc = dis_flush(sfds);
+
+		pfn_transport_send = old_send;
+		if (rc != 0 && pbs_tcp_errno == 0)
+			pbs_tcp_errno = errno;
+#else
 #ifndef WIN32
 		reply_timedout = 0;
 		/* set alarm to interrupt poll() etc. while flushing out data */
@@ -223,20 +286,18 @@ dis_reply_write(int sfds, struct batch_request *preq)
 		DIS_tcp_funcs();		/* setup for DIS over tcp */
 
 		rc = encode_DIS_reply(sfds, preply);
-	}
-
-	if (rc == 0) {
-		rc = dis_flush(sfds);
-	}
+		if (rc == 0)
+			rc = dis_flush(sfds);
 
 #ifndef WIN32
-	reply_timedout = 0; /* Resetting the value for next tcp connection */
-	if (preq->prot == PROT_TCP) {
+		reply_timedout = 0; /* Resetting the value for next tcp connection */
 		alarm(0);
 		(void)sigaction(SIGALRM, &oact, NULL);  /* reset handler for SIGALRM */
-	}
-	pbs_tcp_timeout = old_tcp_timeout;
+		pbs_tcp_timeout = old_tcp_timeout;
 #endif
+#endif
+	}
+
 	if (rc) {
 		char hn[PBS_MAXHOSTNAME+1];
 
@@ -367,6 +428,16 @@ reply_send(struct batch_request *request)
 		/*
 		 * Otherwise, the reply is to be sent to a remote client
 		 */
+#ifndef PBS_MOM
+		/*
+		 * No client, scheduler or MoM may be told of a change that is
+		 * still only queued for the database: a MoM drops an obit once
+		 * it is acked, and a job the scheduler ran must not come back
+		 * as queued after a crash.
+		 */
+		if (!is_readonly_request(request->rq_type))
+			flush_db_saves();
+#endif
 		if (rc == PBSE_NONE) {
 			rc = dis_reply_write(sfds, request);
 		}
@@ -460,6 +531,9 @@ reply_free(struct batch_reply *prep)
 		while (pstat) {
 			pstatx = (struct brp_status *)GET_NEXT(pstat->brp_stlink);
 			free_attrlist(&pstat->brp_attr);
+#ifndef PBS_MOM
+			release_status_blob(pstat->brp_blob);
+#endif
 			(void)free(pstat);
 			pstat = pstatx;
 		}
@@ -48,6 +48,8 @@
  *	check_deletehistoryjob()
  *	issue_delete()
  *	req_deletejob()
+ *	resume_deletejob_lists()
+ *	deletejob_list()
  *	req_deletejob2()
  *	req_deleteReservation()
  *	post_delete_route()
@@ -108,6 +110,8 @@ static void post_delete_route(struct work_task *);
 static void post_delete_mom1(struct work_task *);
 static void post_deljobfromresv_req(struct work_task *);
 static void req_deletejob2(struct batch_request *preq, job *pjob);
+static int deletejob_list(struct batch_request *preq, char **jobids, int count, int first, int subfirst, int del_parent, int freeids);
+static int deletejob_array(struct batch_request *preq, char *jid, int first, int *del_parent, int forcedel, int delhist, int *budget);
 int update_deletejob_stat(char *jid, struct batch_request *preq, int errcode);
 
 /* Private Data Items */
@@ -118,6 +122,19 @@ static char *sigtj =  SIG_TermJob;
 static char *acct_fmt = "requestor=%s@%s";
 static int qdel_mail = 1; /* true: sending mail */
 
+/* rest of a Delete Job or Delete Job List request, set aside by deletejob_list() */
+struct deljob_pending {
+	pbs_list_link dp_link;
+	struct batch_request *dp_preq;	/* the request */
+	char **dp_jobids;		/* job ids of the request */
+	int dp_count;			/* number of job ids */
+	int dp_freeids;			/* dp_jobids was split from a Delete Job request, free it when done */
+	int dp_next;			/* index of the next job id to delete */
+	int dp_subjob;			/* next subjob of the array job at dp_next, -1 if not started */
+	int dp_del_parent;		/* no subjob of that array job had to be deleted by MoM */
+};
+static pbs_list_head deljob_pending = {&deljob_pending, &deljob_pending, NULL};
+
 
 /**
  * @brief
@@ -372,21 +389,9 @@ int update_deletejob_stat(char *jid, struct batch_request *preq, int errcode)
 void
 req_deletejob(struct batch_request *preq)
 {
-	int forcedel = 0;
-	int i;
-	char jid[PBS_MAXSVRJOBID + 1];
-	int jt; /* job type */
-	char *pc;
-	job *pjob;
-	job *parent;
-	char *range;
-	char sjst; /* subjob state */
-	int rc = 0;
-	int delhist = 0;
-	int err = PBSE_NONE;
 	char **jobids;
 	int count;
-	int j;
+	int freeids = 0;
 	struct batch_reply *preply = &preq->rq_reply;
 	preply->brp_un.brp_deletejoblist.brp_delstatc = NULL;
 	preply->brp_count = 0;
@@ -398,12 +403,111 @@ req_deletejob(struct batch_request *preq)
 	} else {
 		jobids = break_comma_list(preq->rq_ind.rq_delete.rq_objname);
 		count = 1;
+		freeids = 1;
 	}
 
 	preply->brp_un.brp_deletejoblist.tot_jobs = count;
 	preply->brp_un.brp_deletejoblist.tot_arr_jobs = 0;
 	preply->brp_un.brp_deletejoblist.tot_rpys = 0;
 
+	if (deletejob_list(preq, jobids, count, 0, -1, 1, freeids) == 0 && freeids)
+		free_string_array(jobids);
+}
+
+/**
+ * @brief
+ * 		resume_deletejob_lists - carry on with the Delete Job requests
+ *		that deletejob_list() set aside, one chunk of each per call.
+ *		Called once per pass of the server main loop.
+ *
+ * @return	int
+ * @retval	1	- some requests still have jobs left to delete
+ * @retval	0	- nothing left
+ */
+
+int
+resume_deletejob_lists(void)
+{
+	struct deljob_pending *pdp;
+	struct deljob_pending *last;
+	struct batch_request *preq;
+	char **jobids;
+	int count;
+	int freeids;
+	int next;
+	int subjob;
+	int del_parent;
+	int done = 0;
+
+	/* requests set aside again while resuming wait for the next pass */
+	last = (struct deljob_pending *)GET_PRIOR(deljob_pending);
+	while (!done && (pdp = (struct deljob_pending *)GET_NEXT(deljob_pending)) != NULL) {
+		done = (pdp == last);
+		preq = pdp->dp_preq;
+		jobids = pdp->dp_jobids;
+		count = pdp->dp_count;
+		freeids = pdp->dp_freeids;
+		next = pdp->dp_next;
+		subjob = pdp->dp_subjob;
+		del_parent = pdp->dp_del_parent;
+		delete_link(&pdp->dp_link);
+		free(pdp);
+		if (deletejob_list(preq, jobids, count, next, subjob, del_parent, freeids) == 0 && freeids)
+			free_string_array(jobids);
+	}
+	return (GET_NEXT(deljob_pending) != NULL);
+}
+
+/**
+ * @brief
+ * 		deletejob_list - delete the jobs of a Delete Job request, starting
+ *		with the given entry of its list of job ids.
+ *
+ *		A Delete Job List request may name many thousands of jobs, or an
+ *		array job with as many subjobs. After SVR_DELJOB_CHUNK jobs and
+ *		subjobs the rest of the work is set aside for
+ *		resume_deletejob_lists(), so other clients are served in between.
+ *		Between job ids, the request is only set aside when no subjob
+ *		deletes of it are outstanding.  Within an array job, the array's
+ *		own reference on the request keeps it from being replied to.  The
+ *		reply is sent once every job has been handled.
+ *
+ * @param[in]	preq	- Job Request
+ * @param[in]	jobids	- job ids to delete
+ * @param[in]	count	- number of job ids
+ * @param[in]	first	- index of the first job id to handle
+ * @param[in]	subfirst - if not -1, the job id at first is an array job
+ *			   which was set aside at this subjob index
+ * @param[in]	del_parent - carried over for the array job being resumed,
+ *			     see deletejob_array()
+ * @param[in]	freeids	- jobids belongs to the caller rather than to the
+ *			  request, kept with the request if it is set aside
+ *
+ * @return	int
+ * @retval	1	- the request was set aside, jobids is still in use
+ * @retval	0	- every job id was handled, the caller may free jobids
+ */
+
+static int
+deletejob_list(struct batch_request *preq, char **jobids, int count, int first, int subfirst, int del_parent, int freeids)
+{
+	int forcedel = 0;
+	int i;
+	char jid[PBS_MAXSVRJOBID + 1];
+	int jt; /* job type */
+	char *pc;
+	job *pjob;
+	job *parent;
+	char *range;
+	char sjst; /* subjob state */
+	int rc = 0;
+	int delhist = 0;
+	int err = PBSE_NONE;
+	int j;
+	int budget = SVR_DELJOB_CHUNK;
+	struct deljob_pending *pdp;
+	struct batch_reply *preply = &preq->rq_reply;
+
 	if (preq->rq_extend && strstr(preq->rq_extend, DELETEHISTORY))
 		delhist = 1;
 	if (preq->rq_extend && strstr(preq->rq_extend, FORCE))
@@ -416,7 +520,18 @@ req_deletejob(struct batch_request *preq)
 	else
 		qdel_mail = 1;
 
-	for (j = 0; j < count; j++) {
+	for (j = first; j < count; j++) {
+		if (subfirst != -1) {
+			/* carry on with the subjobs of an array job that was set aside */
+			snprintf(jid, sizeof(jid), "%s", jobids[j]);
+			subfirst = deletejob_array(preq, jid, subfirst, &del_parent, forcedel, delhist, &budget);
+			if (subfirst != -1)
+				goto set_aside;
+			continue;
+		}
+		if ((budget <= 0) && (preq->rq_refct == 0))
+			goto set_aside;
+		budget--;
 		snprintf(jid, sizeof(jid), "%s", jobids[j]);
 		parent = chk_job_request(jid, preq, &jt, &err);
 		if (parent == NULL) {
@@ -427,7 +542,7 @@ req_deletejob(struct batch_request *preq)
 			if (preply->brp_un.brp_deletejoblist.tot_rpys == preply->brp_un.brp_deletejoblist.tot_jobs) {
 				if (preq->rq_type == PBS_BATCH_DeleteJobList)
 					req_reject(err, 0, preq);  /* note, req_reject is not called for delete job request 2 */
-				return;
+				return 0;
 			} else
 				continue;
 		}
@@ -458,7 +573,7 @@ req_deletejob(struct batch_request *preq)
 				update_deletejob_stat(jid, preq, PBSE_IVALREQ);
 				if (preply->brp_un.brp_deletejoblist.tot_rpys == preply->brp_un.brp_deletejoblist.tot_jobs) {
 					req_reject(PBSE_IVALREQ, 0, preq);
-					return;
+					return 0;
 				} else
 					continue;
 			}
@@ -471,14 +586,14 @@ req_deletejob(struct batch_request *preq)
 				update_deletejob_stat(jid, preq, PBSE_BADSTATE);
 				if (preply->brp_un.brp_deletejoblist.tot_rpys == preply->brp_un.brp_deletejoblist.tot_jobs) {
 					req_reject(PBSE_BADSTATE, 0, preq);
-					return;
+					return 0;
 				} else
 					continue;
 			} else if (sjst == JOB_STATE_LTR_EXPIRED) {
 				update_deletejob_stat(jid, preq, PBSE_NOHISTARRAYSUBJOB);
 				if (preply->brp_un.brp_deletejoblist.tot_rpys == preply->brp_un.brp_deletejoblist.tot_jobs) {
 					req_reject(PBSE_NOHISTARRAYSUBJOB, 0, preq);
-					return;
+					return 0;
 				} else
 					continue;
 			} else if (pjob != NULL) {
@@ -501,7 +616,6 @@ req_deletejob(struct batch_request *preq)
 			continue;
 
 		} else if (jt == IS_ARRAY_ArrayJob) {
-			int del_parent = 1;
 			/*
 			 * For array jobs the history is stored at the parent array level and also at the subjob level .
 			 * If the request is to delete the history of an array job then set  ji_deletehistory to 1 for
@@ -510,67 +624,15 @@ req_deletejob(struct batch_request *preq)
 			 */
 			if (delhist)
 				parent->ji_deletehistory = 1;
-			/* The Array Job itself ... */
-			/* for each subjob that is running, delete it via req_deletejob2 */
 
+			/* held until every subjob has been looked at, see deletejob_array() */
 			++preq->rq_refct;
 			preply->brp_un.brp_deletejoblist.tot_arr_jobs++;
 
-			/* keep the array from being removed while we are looking at it */
-			parent->ji_ajinfo->tkm_flags |= TKMFLG_NO_DELETE;
-			for (i = parent->ji_ajinfo->tkm_start; i <= parent->ji_ajinfo->tkm_end; i += parent->ji_ajinfo->tkm_step) {
-				pjob = get_subjob_and_state(parent, i, &sjst, NULL);
-				if (sjst == JOB_STATE_LTR_UNKNOWN)
-					continue;
-				if ((sjst == JOB_STATE_LTR_EXITING) && !forcedel)
-					continue;
-				if (pjob) {
-					if (delhist)
-						pjob->ji_deletehistory = 1;
-					if (check_job_state(pjob, JOB_STATE_LTR_EXPIRED)) {
-						log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_JOB, LOG_INFO,
-							   pjob->ji_qs.ji_jobid,
-							   msg_job_history_delete, preq->rq_user,
-							   preq->rq_host);
-						job_purge(pjob);
-					} else {
-						dup_br_for_subjob(preq, pjob, req_deletejob2);
-						del_parent = 0;
-					}
-				} else {
-					/* Queued, Waiting, Held, just set to expired */
-					if (sjst != JOB_STATE_LTR_EXPIRED) {
-						update_sj_parent(parent, NULL, create_subjob_id(parent->ji_qs.ji_jobid, i), sjst, JOB_STATE_LTR_EXPIRED);
-						decr_single_subjob_usage(parent);
-					}
-				}
-			}
-			parent->ji_ajinfo->tkm_flags &= ~TKMFLG_NO_DELETE;
-
-
-			/* if deleting running subjobs, then just return;            */
-			/* parent will be deleted when last running subjob(s) ends   */
-			/* and reply will be sent to client when last delete is done */
-			/* If not deleteing running subjobs, delete2 to del parent   */
-
-			if (--preq->rq_refct == 0) {
-				if ((parent = find_job(jid)) != NULL) {
-					req_deletejob2(preq, parent);
-					del_parent = 0;
-				} else {
-					preply->brp_un.brp_deletejoblist.tot_rpys++;
-					if (preply->brp_un.brp_deletejoblist.tot_rpys == preply->brp_un.brp_deletejoblist.tot_jobs)
-						reply_send(preq);
-				}
-			} else
-				acct_del_write(jid, parent, preq, 0);
-
-
-			if (del_parent == 1) {
-				if ((parent = find_job(jid)) != NULL)
-					req_deletejob2(preq, parent);
-			}
-
+			del_parent = 1;
+			subfirst = deletejob_array(preq, jid, parent->ji_ajinfo->tkm_start, &del_parent, forcedel, delhist, &budget);
+			if (subfirst != -1)
+				goto set_aside;
 			continue;
 		}
 		/* what's left to handle is a range of subjobs, foreach subjob 	*/
@@ -581,7 +643,7 @@ req_deletejob(struct batch_request *preq)
 			update_deletejob_stat(jid, preq, PBSE_IVALREQ);
 			if (preply->brp_un.brp_deletejoblist.tot_rpys == preply->brp_un.brp_deletejoblist.tot_jobs) {
 				req_reject(PBSE_IVALREQ, 0, preq);
-				return;
+				return 0;
 			} else
 				continue;
 		}
@@ -657,7 +719,128 @@ req_deletejob(struct batch_request *preq)
 		}
 		continue;
 	}
+	return 0;
+
+set_aside:
+	pdp = malloc(sizeof(struct deljob_pending));
+	if (pdp == NULL) {
+		/* no memory to remember where we were, finish in this pass */
+		if (subfirst != -1) {
+			while (subfirst != -1) {
+				budget = SVR_DELJOB_CHUNK;
+				subfirst = deletejob_array(preq, jid, subfirst, &del_parent, forcedel, delhist, &budget);
+			}
+			j++;
+		}
+		return (deletejob_list(preq, jobids, count, j, -1, 1, freeids));
+	}
+	CLEAR_LINK(pdp->dp_link);
+	pdp->dp_preq = preq;
+	pdp->dp_jobids = jobids;
+	pdp->dp_count = count;
+	pdp->dp_freeids = freeids;
+	pdp->dp_next = j;
+	pdp->dp_subjob = subfirst;
+	pdp->dp_del_parent = del_parent;
+	append_link(&deljob_pending, &pdp->dp_link, pdp);
+	return 1;
+}
+
+/**
+ * @brief
+ * 		deletejob_array - delete the subjobs of an array job named in a
+ *		Delete Job request, then the array job itself.
+ *
+ *		The caller holds a reference on the request for the array job, so
+ *		it is not replied to while subjobs are still to be looked at.  When
+ *		the budget of the pass runs out the index of the next subjob is
+ *		returned and the reference is kept; the caller sets the request
+ *		aside and calls again with that index later.  The array job is
+ *		looked up again on each call, as it may have finished meanwhile.
+ *
+ * @param[in]	preq	- Job Request
+ * @param[in]	jid	- id of the array job
+ * @param[in]	first	- index of the first subjob to handle
+ * @param[in,out] del_parent - cleared when a subjob has to be deleted by MoM,
+ *			       the array job is then deleted when the last one ends
+ * @param[in]	forcedel - delete exiting subjobs too
+ * @param[in]	delhist	- also purge the history of the subjobs
+ * @param[in,out] budget - jobs left to handle in this pass
+ *
+ * @return	int
+ * @retval	-1	- the array job has been dealt with
+ * @retval	>=0	- index of the next subjob, the budget ran out
+ */
+static int
+deletejob_array(struct batch_request *preq, char *jid, int first, int *del_parent, int forcedel, int delhist, int *budget)
+{
+	int i;
+	char sjst; /* subjob state */
+	job *pjob;
+	job *parent;
+	struct batch_reply *preply = &preq->rq_reply;
+
+	if ((parent = find_job(jid)) != NULL && parent->ji_ajinfo != NULL) {
+		/* keep the array from being removed while we are looking at it */
+		parent->ji_ajinfo->tkm_flags |= TKMFLG_NO_DELETE;
+		for (i = first; i <= parent->ji_ajinfo->tkm_end; i += parent->ji_ajinfo->tkm_step) {
+			if (*budget <= 0) {
+				parent->ji_ajinfo->tkm_flags &= ~TKMFLG_NO_DELETE;
+				return i;
+			}
+			(*budget)--;
+			pjob = get_subjob_and_state(parent, i, &sjst, NULL);
+			if (sjst == JOB_STATE_LTR_UNKNOWN)
+				continue;
+			if ((sjst == JOB_STATE_LTR_EXITING) && !forcedel)
+				continue;
+			if (pjob) {
+				if (delhist)
+					pjob->ji_deletehistory = 1;
+				if (check_job_state(pjob, JOB_STATE_LTR_EXPIRED)) {
+					log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_JOB, LOG_INFO,
+						   pjob->ji_qs.ji_jobid,
+						   msg_job_history_delete, preq->rq_user,
+						   preq->rq_host);
+					job_purge(pjob);
+				} else {
+					dup_br_for_subjob(preq, pjob, req_deletejob2);
+					*del_parent = 0;
+				}
+			} else {
+				/* Queued, Waiting, Held, just set to expired */
+				if (sjst != JOB_STATE_LTR_EXPIRED) {
+					update_sj_parent(parent, NULL, create_subjob_id(parent->ji_qs.ji_jobid, i), sjst, JOB_STATE_LTR_EXPIRED);
+					decr_single_subjob_usage(parent);
+				}
+			}
+		}
+		parent->ji_ajinfo->tkm_flags &= ~TKMFLG_NO_DELETE;
+	}
+
+	/* if deleting running subjobs, then just return;            */
+	/* parent will be deleted when last running subjob(s) ends   */
+	/* and reply will be sent to client when last delete is done */
+	/* If not deleteing running subjobs, delete2 to del parent   */
+
+	if (--preq->rq_refct == 0) {
+		if ((parent = find_job(jid)) != NULL) {
+			req_deletejob2(preq, parent);
+			*del_parent = 0;
+		} else {
+			preply->brp_un.brp_deletejoblist.tot_rpys++;
+			if (preply->brp_un.brp_deletejoblist.tot_rpys == preply->brp_un.brp_deletejoblist.tot_jobs)
+				reply_send(preq);
+		}
+	} else if ((parent = find_job(jid)) != NULL)
+		acct_del_write(jid, parent, preq, 0);
+
+	if (*del_parent == 1) {
+		if ((parent = find_job(jid)) != NULL)
+			req_deletejob2(preq, parent);
+	}
 
+	return -1;
 }
 /**
  * @brief
@@ -57,11 +57,13 @@
 #include "batch_request.h"
 #include "pbs_share.h"
 #include "log.h"
+#include "dis.h"
 
 /**
  * @brief
  * 		req_connect - process a Connection Request
- * 		Almost does nothing.
+ * 		Almost does nothing, besides switching the connection to the
+ * 		binary encoding of DIS when the client asks for it.
  *
  * @param[in]	preq	- Connection Request
  */
@@ -69,7 +71,8 @@
 void
 req_connect(struct batch_request *preq)
 {
-	conn_t *conn = get_conn(preq->rq_conn);
+	int sock = preq->rq_conn;
+	conn_t *conn = get_conn(sock);
 
 	if (!conn) {
 		req_reject(PBSE_SYSTEM, 0, preq);
@@ -79,6 +82,15 @@ req_connect(struct batch_request *preq)
 	if (preq->rq_extend != NULL) {
 		if (strcmp(preq->rq_extend, QSUB_DAEMON) == 0)
 			conn->cn_authen |= PBS_NET_CONN_FROM_QSUB_DAEMON;
+		else if (strcmp(preq->rq_extend, PBS_DIS_BINARY_EXTEND) == 0) {
+			/* the reply still goes out in Data-is-Strings */
+			preq->rq_reply.brp_code = PBSE_NONE;
+			preq->rq_reply.brp_auxcode = PBS_DIS_BINARY;
+			preq->rq_reply.brp_choice = BATCH_REPLY_CHOICE_NULL;
+			if (reply_send(preq) == 0)
+				dis_set_binary(sock, 1);
+			return;
+		}
 	}
 
 	reply_ack(preq);
@@ -95,6 +95,7 @@
 #define PERM_OPorMGR (ATR_DFLAG_MGWR | ATR_DFLAG_MGRD | ATR_DFLAG_OPRD | ATR_DFLAG_OPWR)
 
 pntPBS_IP_LIST pbs_iplist = NULL;
+long pbs_iplist_gen = 0;	/* bumped on each change to pbs_iplist */
 
 void *node_idx = NULL;
 static void *hostaddr_idx = NULL;
@@ -1036,6 +1037,7 @@ mgr_unset_attr(attribute *pattr, void *pidx, attribute_def *pdef, int limit, svr
 					prsdef->rs_free(&presc->rs_value);
 				}
 				delete_link(&presc->rs_link);
+				free_resc_index(pattr + index);
 				free(presc);
 				presc = NULL;
 			}
@@ -2169,7 +2171,13 @@ mgr_node_set(struct batch_request *preq)
 
 	warnmsg = warn_msg_build(WARN_ngrp, warn_nodes, warn_idx);
 
-	save_nodes_db(0, NULL);
+	/* only write out the vnodes that were touched */
+	if (preq->rq_ind.rq_manager.rq_objtype == MGR_OBJ_HOST)
+		save_nodes_db(0, pmom);
+	else if (numnodes == 1)
+		save_vnode_db(pnode);
+	else
+		save_nodes_db(0, NULL);
 
 	if (numnodes > 1) {          /*modification was for multiple vnodes  */
 
@@ -2474,7 +2482,13 @@ mgr_node_unset(struct batch_request *preq)
 
 	warnmsg = warn_msg_build(WARN_ngrp, warn_nodes, warn_idx);
 
-	save_nodes_db(0, NULL);
+	/* only write out the vnodes that were touched */
+	if (preq->rq_ind.rq_manager.rq_objtype == MGR_OBJ_HOST)
+		save_nodes_db(0, pmom);
+	else if (numnodes == 1)
+		save_vnode_db(pnode);
+	else
+		save_nodes_db(0, NULL);
 
 	if (numnodes > 1) {          /*modification was for all nodes  */
 
@@ -2803,6 +2817,7 @@ create_pbs_node2(char *objname, svrattrl *plist, int perms, int *bad, struct pbs
 			free(pname);
 			return (PBSE_SYSTEM);
 		}
+		invalidate_exec_vnode_caches();	/* parsed exec_vnodes may name it */
 	} else if (nodup == TRUE) {
 		/* duplicating/modifying vnode by qmgr is not allowed */
 		/* as what qmgr creates is the natural vnode          */
@@ -3001,6 +3016,7 @@ create_pbs_node2(char *objname, svrattrl *plist, int perms, int *bad, struct pbs
 			}
 
 		}
+		pbs_iplist_gen++;
 
 		/* cross link the vnode (pnode) and its Mom (pmom) */
 
@@ -3466,7 +3482,7 @@ struct batch_request *preq;
 	setup_notification();	    /*set mechanism for notifying */
 	/*other nodes of new member   */
 
-	save_nodes_db(1, NULL);
+	save_nodes_db(1, mymom);    /* only the new node's Mom changed */
 
 	reply_ack(preq);	    /*create completely successful*/
 }
@@ -3553,6 +3569,7 @@ check_resource_set_on_jobs_or_resvs(struct batch_request *preq, resource_def *pr
 	job *pj;
 	resc_resv *pr;
 	char *rmatch;
+	char *selstr;
 	int rlen;
 	attribute *pattr;
 	resource *presc;
@@ -3560,19 +3577,31 @@ check_resource_set_on_jobs_or_resvs(struct batch_request *preq, resource_def *pr
 	/* Reject if resource is on a job and the type or flag are being modified */
 
 	for (pj = (job *)GET_NEXT(svr_alljobs); pj != NULL; pj = (job *)GET_NEXT(pj->ji_alljobs)) {
-		pattr = &pj->ji_wattr[JOB_ATR_resource];
-		presc = get_resource(pattr, prdef);
-		if ((presc != NULL) && (mod == 1)) {
-			reply_text(preq, PBSE_RESCBUSY, "Resource busy on job");
-			return 1;
+		if (pj->ji_frozen != NULL) {
+			/* answered from what a frozen history job shows, without reading it back */
+			if (mod != 1)
+				continue;
+			if (get_frozen_jattr_value(pj->ji_frozen, JOB_ATR_resource, prdef->rs_name) != NULL) {
+				reply_text(preq, PBSE_RESCBUSY, "Resource busy on job");
+				return 1;
+			}
+			selstr = get_frozen_jattr_value(pj->ji_frozen, JOB_ATR_SchedSelect, NULL);
+		} else {
+			pattr = &pj->ji_wattr[JOB_ATR_resource];
+			presc = get_resource(pattr, prdef);
+			if ((presc != NULL) && (mod == 1)) {
+				reply_text(preq, PBSE_RESCBUSY, "Resource busy on job");
+				return 1;
+			}
+			pattr = &pj->ji_wattr[JOB_ATR_SchedSelect];
+			selstr = is_attr_set(pattr) ? pattr->at_val.at_str : NULL;
 		}
-		pattr = &pj->ji_wattr[JOB_ATR_SchedSelect];
-		if (is_attr_set(pattr)) {
-			rmatch = strstr(pattr->at_val.at_str, prdef->rs_name);
+		if (selstr != NULL) {
+			rmatch = strstr(selstr, prdef->rs_name);
 			if (rmatch != NULL) {
 				rlen = strlen(prdef->rs_name);
 				if (((mod == 1) && (*(rmatch+rlen) == '=')) &&
-				    ((rmatch == pattr->at_val.at_str) || *(rmatch-1) == ':')) {
+				    ((rmatch == selstr) || *(rmatch-1) == ':')) {
 					reply_text(preq, PBSE_RESCBUSY, "Resource busy on job");
 					return 1;
 				}
@@ -3707,6 +3736,7 @@ mgr_resource_create(struct batch_request *preq)
 		req_reject(PBSE_BADATVAL, 0, preq);
 		return;
 	}
+	invalidate_exec_vnode_caches();
 
 	log_eventf(PBSEVENT_ADMIN, PBS_EVENTCLASS_RESC, LOG_INFO, resc, msg_manager, msg_man_cre, preq->rq_user, preq->rq_host);
 	plist = (svrattrl *) GET_NEXT(preq->rq_ind.rq_manager.rq_attr);
@@ -3908,6 +3938,7 @@ mgr_resource_delete(struct batch_request *preq)
 			break;
 		}
 	}
+	invalidate_exec_vnode_caches();
 
 	log_eventf(PBSEVENT_ADMIN, PBS_EVENTCLASS_RESC, LOG_INFO, resc, msg_manager, msg_man_del, preq->rq_user, preq->rq_host);
 
@@ -4306,6 +4337,7 @@ mgr_resource_unset(struct batch_request *preq)
 					if (server.sv_attr[i].at_flags & ATR_VFLAG_SET) {
 						presc->rs_defin->rs_free(&presc->rs_value);
 						delete_link(&presc->rs_link);
+						free_resc_index(&server.sv_attr[i]);
 						free(presc);
 						presc = (resource *)GET_NEXT(server.sv_attr[i].at_val.at_list);
 						if (presc == NULL)
@@ -4336,6 +4368,7 @@ mgr_resource_unset(struct batch_request *preq)
 			presc = get_resource(q_attr, prdef);
 			presc->rs_defin->rs_free(&presc->rs_value);
 			delete_link(&presc->rs_link);
+			free_resc_index(q_attr);
 			free(presc);
 			presc = (resource *)GET_NEXT(q_attr->at_val.at_list);
 			if (presc == NULL)
@@ -4411,6 +4444,9 @@ req_manager(struct batch_request *preq)
 
 	++preq->rq_refct;
 
+	/* nodes changed by the administrator are stored before the reply */
+	urgent_node_saves();
+
 	if (preq->prot == PROT_TCP) {
 		if (preq->rq_conn != PBS_LOCAL_CONNECTION) {
 			conn = get_conn(preq->rq_conn);
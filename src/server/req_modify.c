@@ -608,6 +608,7 @@ modify_job_attr(job *pjob, svrattrl *plist, int perm, int *bad)
 				(pre_copy[i].at_type == ATR_TYPE_RESC)) {
 				list_move(&pre_copy[i].at_val.at_list,
 					  &pattr[i].at_val.at_list);
+				free_resc_index(&pre_copy[i]);
 			} else {
 				pattr[i] = pre_copy[i];
 			}
@@ -662,6 +663,7 @@ modify_job_attr(job *pjob, svrattrl *plist, int perm, int *bad)
 					    (newattr[i].at_type == ATR_TYPE_RESC)) {
 						list_move(&newattr[i].at_val.at_list,
 							  &pattr[i].at_val.at_list);
+						free_resc_index(&newattr[i]);
 					} else {
 						pattr[i] = newattr[i];
 					}
@@ -1377,6 +1379,7 @@ modify_resv_attr(resc_resv *presv, svrattrl *plist, int perm, int *bad)
 			resv_attr_def[i].at_free(pattr+i);
 			if ((newattr[i].at_type == ATR_TYPE_LIST) || (newattr[i].at_type == ATR_TYPE_RESC)) {
 				list_move(&newattr[i].at_val.at_list, &(pattr+i)->at_val.at_list);
+				free_resc_index(&newattr[i]);
 			} else {
 				*(pattr+i) = newattr[i];
 			}
@@ -1156,6 +1156,8 @@ req_quejob(struct batch_request *preq)
 			pjob = (job *)GET_NEXT(pjob->ji_alljobs)) {
 			if (pjob == pj)
 				continue;
+			if (is_history_state(get_job_state(pjob)))
+				continue;
 			if (!is_jattr_set(pjob, JOB_ATR_block))
 				continue;
 
@@ -1674,11 +1676,8 @@ req_commit_now(struct batch_request *preq,  job *pj)
 	int newsub;
 	pbs_queue *pque;
 	int rc;
-	pbs_db_jobscr_info_t jobscr;
-	pbs_db_obj_info_t obj;
 	long time_msec;
 	struct timeval tval;
-	void *conn = (void *) svr_db_conn;
 	char *runjob_extend = NULL;
 	struct batch_request *preq_runjob = NULL;
 #endif
@@ -1782,12 +1781,7 @@ req_commit_now(struct batch_request *preq,  job *pj)
 	}
 
 	if (pj->ji_script) {
-		strcpy(jobscr.ji_jobid, pj->ji_qs.ji_jobid);
-		jobscr.script = pj->ji_script;
-		obj.pbs_db_obj_type = PBS_DB_JOBSCR;
-		obj.pbs_db_un.pbs_db_jobscr = &jobscr;
-
-		if (pbs_db_save_obj(conn, &obj, OBJ_SAVE_NEW) != 0) {
+		if (svr_save_jobscript(pj) != 0) {
 			job_purge(pj);
 			req_reject(PBSE_SYSTEM, 0, preq);
 			return;
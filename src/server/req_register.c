@@ -46,6 +46,7 @@
  * Included functions are:
  * 	post_run_depend()
  * 	req_register()
+ * 	release_dep()
  * 	post_doq()
  * 	alter_unreg()
  * 	depend_on_que()
@@ -57,6 +58,7 @@
  * 	make_depend()
  * 	register_dep()
  * 	unregister_dep()
+ * 	build_dependjob_idx()
  * 	find_dependjob()
  * 	make_dependjob()
  * 	send_depend_req()
@@ -98,6 +100,7 @@
 #include "pbs_nodes.h"
 #include "svrfunc.h"
 #include "net_connect.h"
+#include "pbs_idx.h"
 
 
 
@@ -112,11 +115,12 @@ static int register_dep(attribute *, struct batch_request *, int, int *);
 static int unregister_dep(attribute *, struct batch_request *);
 static struct depend *make_depend(int type, attribute *pattr);
 static struct depend_job *make_dependjob(struct depend *, char *jobid, char *host);
-static void   del_depend_job(struct depend_job *pdj);
+static void   del_depend_job(struct depend *pdep, struct depend_job *pdj);
 static int    build_depend(attribute *, char *);
 static void   clear_depend(struct depend *, int type, int exists);
 static void   del_depend(struct depend *);
 static void update_depend(job *, char *, char *, int, int);
+static int release_dep(job *, int, char *);
 
 /* External Global Data Items */
 
@@ -204,7 +208,7 @@ static void update_depend(job *pjob, char *d_jobid, char *d_svr, int op, int typ
 		dpj = find_dependjob(dp, d_jobid);
 		if (dpj == NULL)
 			return;
-		del_depend_job(dpj);
+		del_depend_job(dp, dpj);
 		if (GET_NEXT(dp->dp_jobs) == 0)
 			/* no more dependencies of this type */
 			del_depend(dp);
@@ -435,38 +439,8 @@ req_register(struct batch_request *preq)
 
 					/* predecessor sent release-reduce "on", */
 					/* see if this job can now run 		 */
-					type ^= (JOB_DEPEND_TYPE_BEFORESTART -
-						JOB_DEPEND_TYPE_AFTERSTART);
-					if ((pdep = find_depend(type, pattr)) != NULL) {
-						pdj = find_dependjob(pdep,
-							preq->rq_ind.rq_register.rq_child);
-						if (pdj) {
-							del_depend_job(pdj);
-							pattr->at_flags |= ATR_MOD_MCACHE;
-							(void)sprintf(log_buffer, msg_registerrel,
-								preq->rq_ind.rq_register.rq_child);
-							log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB,
-								LOG_INFO,
-								pjob->ji_qs.ji_jobid, log_buffer);
-
-							if (GET_NEXT(pdep->dp_jobs) == 0) {
-								/* no more dependencies of this type */
-								del_depend(pdep);
-								set_depend_hold(pjob, pattr);
-							}
-							break;
-						}
-#ifdef NAS /* localmod 109 */
-						sprintf(log_buffer, "Dep.rls. job not found: %d/%s", type, preq->rq_ind.rq_register.rq_child);
-					} else {
-						sprintf(log_buffer, "Dep.rls. type not found: %d", type);
-#endif /* localmod 109 */
-					}
-#ifdef NAS /* localmod 109 */
-					log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_JOB, LOG_INFO,
-						preq->rq_ind.rq_register.rq_parent, log_buffer);
-#endif /* localmod 109 */
-					rc = PBSE_IVALREQ;
+					rc = release_dep(pjob, type,
+						preq->rq_ind.rq_register.rq_child);
 					break;
 				case JOB_DEPEND_TYPE_RUNONE:
 					pdep = find_depend(JOB_DEPEND_TYPE_RUNONE, pattr);
@@ -533,6 +507,59 @@ req_register(struct batch_request *preq)
 	return;
 }
 
+/**
+ * @brief
+ * 		release_dep - a job this job runs after has released it, remove
+ *		that job from the matching "after" dependency and, if it was the
+ *		last one, see if this job can now run.
+ *
+ * @param[in,out]	pjob	-	the dependent job being released
+ * @param[in]	type	-	"before" dependency type as seen by the releasing job
+ * @param[in]	jobid	-	job id of the releasing job
+ *
+ * @return	error code
+ * @retval	0	: success
+ * @retval	PBSE_IVALREQ	: pjob has no such dependency
+ */
+
+static int
+release_dep(job *pjob, int type, char *jobid)
+{
+	attribute	  *pattr;
+	struct depend	  *pdep;
+	struct depend_job *pdj;
+
+	pattr = &pjob->ji_wattr[(int)JOB_ATR_depend];
+	type ^= (JOB_DEPEND_TYPE_BEFORESTART - JOB_DEPEND_TYPE_AFTERSTART);
+	if ((pdep = find_depend(type, pattr)) != NULL) {
+		pdj = find_dependjob(pdep, jobid);
+		if (pdj) {
+			del_depend_job(pdep, pdj);
+			pattr->at_flags |= ATR_MOD_MCACHE;
+			(void)sprintf(log_buffer, msg_registerrel, jobid);
+			log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, LOG_INFO,
+				pjob->ji_qs.ji_jobid, log_buffer);
+
+			if (GET_NEXT(pdep->dp_jobs) == 0) {
+				/* no more dependencies of this type */
+				del_depend(pdep);
+				set_depend_hold(pjob, pattr);
+			}
+			return (0);
+		}
+#ifdef NAS /* localmod 109 */
+		sprintf(log_buffer, "Dep.rls. job not found: %d/%s", type, jobid);
+	} else {
+		sprintf(log_buffer, "Dep.rls. type not found: %d", type);
+#endif /* localmod 109 */
+	}
+#ifdef NAS /* localmod 109 */
+	log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_JOB, LOG_INFO,
+		pjob->ji_qs.ji_jobid, log_buffer);
+#endif /* localmod 109 */
+	return (PBSE_IVALREQ);
+}
+
 /**
  * @brief
  * 		post_doq (que not dog) - post request/reply processing for depend_on_que
@@ -812,7 +839,7 @@ post_doe(struct work_task *pwt)
 		if (pdep != NULL) {
 			pdj  = find_dependjob(pdep, preq->rq_ind.rq_register.rq_parent);
 			if (pdj != NULL)
-				del_depend_job(pdj);
+				del_depend_job(pdep, pdj);
 			if (GET_NEXT(pdep->dp_jobs) == 0) {
 				/* no more dependencies of this type */
 				del_depend(pdep);
@@ -846,7 +873,7 @@ post_runone(struct work_task *pwt)
 		if (pdep != NULL) {
 			pdj  = find_dependjob(pdep, preq->rq_ind.rq_register.rq_parent);
 			if (pdj != NULL)
-				del_depend_job(pdj);
+				del_depend_job(pdep, pdj);
 			if (GET_NEXT(pdep->dp_jobs) == 0) {
 				/* no more dependencies of this type */
 				del_depend(pdep);
@@ -921,11 +948,12 @@ int depend_runone_remove_dependency(job *pjob)
 		     pdj != NULL; pdj = (struct depend_job *)GET_NEXT(pdj->dc_link)) {
 			d_pjob = find_job(pdj->dc_child);
 			if (d_pjob) {
+				struct depend *temp_pdep;
 				struct depend_job *temp_pdj = NULL;
-				temp_pdj = find_dependjob(find_depend(JOB_DEPEND_TYPE_RUNONE, &d_pjob->ji_wattr[(int)JOB_ATR_depend]),
-					                  pjob->ji_qs.ji_jobid);
+				temp_pdep = find_depend(JOB_DEPEND_TYPE_RUNONE, &d_pjob->ji_wattr[(int)JOB_ATR_depend]);
+				temp_pdj = find_dependjob(temp_pdep, pjob->ji_qs.ji_jobid);
 				if (temp_pdj) {
-					del_depend_job(temp_pdj);
+					del_depend_job(temp_pdep, temp_pdj);
 					d_pjob->ji_wattr[(int)JOB_ATR_depend].at_flags |= ATR_MOD_MCACHE;
 				}
 			}
@@ -1034,11 +1062,18 @@ depend_on_term(job *pjob)
 	attribute     *pattr;
 	struct depend *pdep;
 	struct depend_job *pparent;
+	job	      *pdepjob;
 	int	       rc;
 	int	       type;
+	char	       local_svr[PBS_MAXSERVERNAME+1];
+	char	      *pc;
 
 	pattr = &pjob->ji_wattr[(int)JOB_ATR_depend];
 
+	/* dependents registered from this server carry this as their dc_svr */
+	snprintf(local_svr, sizeof(local_svr), "%s%s", pbs_server_name,
+		((pc = strchr(server_name, (int)':')) != NULL) ? pc : "");
+
 	pdep = (struct depend *)GET_NEXT(pattr->at_val.at_list);
 	while (pdep) {
 		op = -1;
@@ -1100,11 +1135,26 @@ depend_on_term(job *pjob)
 
 			pparent = (struct depend_job *)GET_NEXT(pdep->dp_jobs);
 			while (pparent) {
-				/* "release" the job to execute */
-				rc = send_depend_req(pjob, pparent, type, op,
-					SYNC_SCHED_HINT_NULL, release_req);
-				if (rc)
-					return rc;
+				/*
+				 * Release dependents owned by this server in place
+				 * rather than sending each a Register request to
+				 * ourself; their saves go out in one transaction
+				 * with the rest of this pass, see job_save_db().
+				 */
+				if ((op == JOB_DEPEND_OP_RELEASE) &&
+					(type != JOB_DEPEND_TYPE_RUNONE) &&
+					(strcmp(pparent->dc_svr, local_svr) == 0) &&
+					((pdepjob = find_job(pparent->dc_child)) != NULL) &&
+					!check_job_state(pdepjob, JOB_STATE_LTR_MOVED)) {
+					if (release_dep(pdepjob, type, pjob->ji_qs.ji_jobid) == 0)
+						job_save_db(pdepjob);
+				} else {
+					/* "release" the job to execute */
+					rc = send_depend_req(pjob, pparent, type, op,
+						SYNC_SCHED_HINT_NULL, release_req);
+					if (rc)
+						return rc;
+				}
 				pparent = (struct depend_job *)GET_NEXT(pparent->dc_link);
 			}
 		}
@@ -1303,13 +1353,42 @@ unregister_dep(attribute *pattr, struct batch_request *preq)
 		((pdjb = find_dependjob(pdp, preq->rq_ind.rq_register.rq_child)) == NULL))
 			return (PBSE_IVALREQ);
 
-	del_depend_job(pdjb);
+	del_depend_job(pdp, pdjb);
 	return (0);
 }
 
+/**
+ * @brief
+ * 		build_dependjob_idx - index the depend_job list of a dependency
+ *		by child job id.  If the list names the same child twice, no
+ *		index is kept and the list is walked instead.
+ *
+ * @param[in,out]	pdep	-	dependency whose list is indexed
+ */
+
+static void
+build_dependjob_idx(struct depend *pdep)
+{
+	struct depend_job *pdj;
+
+	if ((pdep->dp_idx = pbs_idx_create(0, 0)) == NULL)
+		return;
+	for (pdj = (struct depend_job *)GET_NEXT(pdep->dp_jobs); pdj;
+		pdj = (struct depend_job *)GET_NEXT(pdj->dc_link)) {
+		if (pbs_idx_insert(pdep->dp_idx, pdj->dc_child, pdj) != PBS_IDX_RET_OK) {
+			pbs_idx_destroy(pdep->dp_idx);
+			pdep->dp_idx = NULL;
+			return;
+		}
+	}
+}
+
 /**
  * @brief
  * 		find_dependjob - find a child dependent job with a certain job id
+ *		A parent with many dependents (e.g. thousands of jobs submitted
+ *		with afterok on it) is looked up on every register and release,
+ *		so once the list reaches DEPEND_IDX_MIN entries it is indexed.
  *
  * @param[in]	pdep	-	dependent jobs
  * @param[in]	name	-	job id to be matched
@@ -1321,18 +1400,32 @@ unregister_dep(attribute *pattr, struct batch_request *preq)
 struct depend_job *find_dependjob(struct depend *pdep, char *name)
 {
 	struct depend_job *pdj;
+	struct depend_job *found = NULL;
+	void *key = name;
+	int ct = 0;
 
 	if ((pdep == NULL) || (name == NULL))
 		return NULL;
 
+	if (pdep->dp_idx != NULL) {
+		if (pbs_idx_find(pdep->dp_idx, &key, (void **)&found, NULL) != PBS_IDX_RET_OK)
+			return NULL;
+		return (found);
+	}
+
 	pdj = (struct depend_job *)GET_NEXT(pdep->dp_jobs);
 	while (pdj) {
-		if (!strcmp(name, pdj->dc_child))
-			break;
-
+		if ((found == NULL) && !strcmp(name, pdj->dc_child)) {
+			found = pdj;
+			if (ct >= DEPEND_IDX_MIN)
+				break;
+		}
+		ct++;
 		pdj = (struct depend_job *)GET_NEXT(pdj->dc_link);
 	}
-	return (pdj);
+	if (ct >= DEPEND_IDX_MIN)
+		build_dependjob_idx(pdep);
+	return (found);
 }
 
 /**
@@ -1359,6 +1452,11 @@ static struct depend_job *make_dependjob(struct depend *pdep, char *jobid, char
 		(void)strcpy(pdj->dc_child, jobid);
 		(void)strcpy(pdj->dc_svr, host);
 		append_link(&pdep->dp_jobs, &pdj->dc_link, pdj);
+		if ((pdep->dp_idx != NULL) &&
+			(pbs_idx_insert(pdep->dp_idx, pdj->dc_child, pdj) != PBS_IDX_RET_OK)) {
+			pbs_idx_destroy(pdep->dp_idx);
+			pdep->dp_idx = NULL;
+		}
 	}
 	return (pdj);
 }
@@ -1488,6 +1586,7 @@ decode_depend(struct attribute *patr, char *name, char *rescn, char *val)
 {
 	int		 rc;
 	char		*valwd;
+	char		*savep;
 
 	if ((val == NULL) || (*val == 0)) {
 		free_depend(patr);
@@ -1499,13 +1598,13 @@ decode_depend(struct attribute *patr, char *name, char *rescn, char *val)
 	 * for each sub-string (terminated by comma or new-line),
 	 * add a depend or depend_child structure.
 	 */
-	valwd = parse_comma_string(val);
+	valwd = parse_comma_string(val, &savep);
 	while (valwd) {
 		if ((rc=build_depend(patr, valwd)) != 0) {
 			free_depend(patr);
 			return (rc);
 		}
-		valwd = parse_comma_string(NULL);
+		valwd = parse_comma_string(NULL, &savep);
 	}
 
 	patr->at_flags |= ATR_SET_MOD_MCACHE;
@@ -1771,11 +1870,12 @@ free_depend(struct attribute *attr)
 			delete_link(&pdjb->dc_link);
 			(void)free(pdjb);
 		}
+		pbs_idx_destroy(pdp->dp_idx);
 		delete_link(&pdp->dp_link);
 		(void)free(pdp);
 	}
 	/* free any data cached for stats */
-	if (attr->at_user_encoded != NULL || attr->at_priv_encoded != NULL) {
+	if (attr->at_ext != NULL) {
 		free_svrcache(attr);
 	}
 	mark_attr_not_set(attr);
@@ -1923,6 +2023,11 @@ build_depend(attribute *pattr, char *value)
 				}
 
 				append_link(&pd->dp_jobs, &pdjb->dc_link, pdjb);
+				if ((pd->dp_idx != NULL) &&
+					(pbs_idx_insert(pd->dp_idx, pdjb->dc_child, pdjb) != PBS_IDX_RET_OK)) {
+					pbs_idx_destroy(pd->dp_idx);
+					pd->dp_idx = NULL;
+				}
 			} else {
 				return (PBSE_SYSTEM);
 			}
@@ -1951,13 +2056,16 @@ clear_depend(struct depend *pd, int type, int exist)
 	struct depend_job *pdj;
 
 	if (exist) {
+		pbs_idx_destroy(pd->dp_idx);
+		pd->dp_idx = NULL;
 		while ((pdj = (struct depend_job *)
 			GET_NEXT(pd->dp_jobs)) != NULL) {
-			del_depend_job(pdj);
+			del_depend_job(pd, pdj);
 		}
 	} else {
 		CLEAR_HEAD(pd->dp_jobs);
 		CLEAR_LINK(pd->dp_link);
+		pd->dp_idx = NULL;
 	}
 	pd->dp_type = type;
 	pd->dp_numexp = 0;
@@ -1978,8 +2086,10 @@ del_depend(struct depend *pd)
 {
 	struct depend_job *pdj;
 
+	pbs_idx_destroy(pd->dp_idx);
+	pd->dp_idx = NULL;
 	while ((pdj = (struct depend_job *)GET_NEXT(pd->dp_jobs)) != NULL) {
-		del_depend_job(pdj);
+		del_depend_job(pd, pdj);
 	}
 	delete_link(&pd->dp_link);
 	(void)free(pd);
@@ -1989,12 +2099,16 @@ del_depend(struct depend *pd)
  * @brief
  * 		del_depend_job - delete a single depend_job structure
  *
+ *  @param[in,out]	pdep	-	dependency set holding pdj
  *  @param[in,out]	pdj	-	a single depend_job structure
  */
 
 static void
-del_depend_job(struct depend_job *pdj)
+del_depend_job(struct depend *pdep, struct depend_job *pdj)
 {
+	/* an index is never kept while a child is listed twice */
+	if (pdep->dp_idx != NULL)
+		pbs_idx_delete(pdep->dp_idx, pdj->dc_child);
 	delete_link(&pdj->dc_link);
 	(void)free(pdj);
 }
@@ -89,6 +89,7 @@ static void free_sellist(struct select_list *pslist);
 static int  sel_attr(attribute *, struct select_list *);
 static int  select_job(job *, struct select_list *, int, int);
 static int  select_subjob(char, struct select_list *);
+static int  select_from_index(struct select_list *, pbs_queue *, int, job ***);
 
 
 /**
@@ -297,6 +298,74 @@ add_select_array_entries(job *pjob, int dosub, char *statelist,
 	return ct;
 }
 
+/**
+ * @brief
+ * 	Use the most selective secondary job index (state or owner) to find
+ * 	the candidate jobs for a selection
+ *
+ *	The candidates are a superset of the jobs to select, each one is
+ *	still checked with select_job().  No index is used when subjobs are
+ *	selected, since then the state of an Array Job is not compared, or
+ *	when walking the job list is no more work.
+ *
+ * @param[in]	psel	-	select list built by build_selist()
+ * @param[in]	pque	-	queue being selected from, or NULL
+ * @param[in]	dosubjobs	-	subjob selection flag of the request
+ * @param[out]	pjobs	-	malloc'ed array of candidate jobs in list order
+ *
+ * @return	int
+ * @retval	>=0	: number of candidate jobs in *pjobs
+ * @retval	-1	: no index used, walk the job list
+ */
+static int
+select_from_index(struct select_list *psel, pbs_queue *pque, int dosubjobs, job ***pjobs)
+{
+	char states[PBS_NUMJOBSTATE * 2 + 2];
+	char best_states[PBS_NUMJOBSTATE * 2 + 2];
+	struct array_strings *best_users = NULL;
+	int best;
+	int count;
+	char *pc;
+
+	*pjobs = NULL;
+	if (dosubjobs)
+		return -1;
+
+	best = pque ? pque->qu_numjobs : server.sv_qs.sv_numjobs;
+	best_states[0] = '\0';
+
+	for (; psel; psel = psel->sl_next) {
+		if (psel->sl_atindx == JOB_ATR_state && psel->sl_op == EQ) {
+			pc = psel->sl_attr.at_val.at_str;
+			if (pc == NULL || strlen(pc) > PBS_NUMJOBSTATE * 2)
+				continue;
+			strcpy(states, pc);
+			/* a suspended job is a running job, see select_job() */
+			if (*pc == JOB_STATE_LTR_SUSPENDED)
+				strcat(states, "R");
+			count = count_jobs_by_state(states, pque);
+			if (count < best) {
+				best = count;
+				strcpy(best_states, states);
+				best_users = NULL;
+			}
+		} else if (psel->sl_atindx == JOB_ATR_userlst) {
+			count = count_jobs_by_owner(psel->sl_attr.at_val.at_arst);
+			if (count >= 0 && count < best) {
+				best = count;
+				best_users = psel->sl_attr.at_val.at_arst;
+				best_states[0] = '\0';
+			}
+		}
+	}
+
+	if (best_users)
+		return find_jobs_by_owner(best_users, pque, pjobs);
+	if (best_states[0] != '\0')
+		return find_jobs_by_state(best_states, pque, pjobs);
+	return -1;
+}
+
 /**
  * @brief
  * 	Service both the Select Job Request and the (special for the scheduler)
@@ -328,6 +397,9 @@ req_selectjobs(struct batch_request *preq)
 	int rc;
 	struct select_list *selistp;
 	pbs_sched *psched;
+	job **pjobs = NULL;
+	int njobs;
+	int ix = 0;
 
 	if (preq->rq_extend != NULL) {
 		/*
@@ -388,7 +460,10 @@ req_selectjobs(struct batch_request *preq)
 	preply->brp_count = 0;
 
 	/* now start checking for jobs that match the selection criteria */
-	if (pque)
+	njobs = select_from_index(selistp, pque, dosubjobs, &pjobs);
+	if (njobs >= 0)
+		pjob = (njobs > 0) ? pjobs[0] : NULL;
+	else if (pque)
 		pjob = (job *) GET_NEXT(pque->qu_jobs);
 	else
 		pjob = (job *) GET_NEXT(svr_alljobs);
@@ -428,8 +503,11 @@ req_selectjobs(struct batch_request *preq)
 							if (pstate == 0 || chk_job_statenum(sjst, pstate)) {
 								if (preply->brp_count >= MAX_JOBS_PER_REPLY) {
 									rc = reply_send_status_part(preq);
-									if (rc != PBSE_NONE)
+									if (rc != PBSE_NONE) {
+										free(pjobs);
+										free_sellist(selistp);
 										return;
+									}
 									preply->brp_count = 0;
 								}
 								rc = status_subjob(pjob, preq, plist, i, &preply->brp_un.brp_status, &bad, 0);
@@ -446,17 +524,23 @@ req_selectjobs(struct batch_request *preq)
 				}
 			}
 		}
-		if (pque)
+		if (njobs >= 0)
+			pjob = (++ix < njobs) ? pjobs[ix] : NULL;
+		else if (pque)
 			pjob = (job *) GET_NEXT(pjob->ji_jobque);
 		else
 			pjob = (job *) GET_NEXT(pjob->ji_alljobs);
 		if (preq->rq_type != PBS_BATCH_SelectJobs && preply->brp_count >= MAX_JOBS_PER_REPLY && pjob) {
 			rc = reply_send_status_part(preq);
-			if (rc != PBSE_NONE)
+			if (rc != PBSE_NONE) {
+				free(pjobs);
+				free_sellist(selistp);
 				return;
+			}
 		}
 	}
 out:
+	free(pjobs);
 	free_sellist(selistp);
 	if (rc)
 		req_reject(rc, 0, preq);
@@ -511,7 +595,7 @@ select_job(job *pjob, struct select_list *psel, int dosubjobs, int dohistjobs)
 				return (0);
 
 		} else if (!dosubjobs || (psel->sl_atindx != JOB_ATR_state)) {
-			if (!sel_attr(&pjob->ji_wattr[psel->sl_atindx], psel)) {
+			if (!sel_attr(get_jattr(pjob, psel->sl_atindx), psel)) {
 				/* Make sure we haven't incorrectly dismissed a suspended job */
 				if (psel->sl_atindx == JOB_ATR_state && psel->sl_attr.at_val.at_str[0] == 'S') {
 					if (check_job_state(pjob, JOB_STATE_LTR_RUNNING) &&
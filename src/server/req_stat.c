@@ -230,7 +230,7 @@ stat_a_jobidname(struct batch_request *preq, char *name, int dohistjobs, int dos
 		return rc; /* no job still needs to be stat-ed */
 
 	} else if ((i == IS_ARRAY_NO) || (i == IS_ARRAY_ArrayJob)) {
-		pjob = find_job(name);
+		pjob = find_job_nothaw(name);
 		if (pjob == NULL)
 			return PBSE_UNKJOBID;
 		else if (!dohistjobs && (rc = svr_chk_histjob(pjob)) != PBSE_NONE)
@@ -304,6 +304,14 @@ req_stat_job(struct batch_request *preq)
 	int rc = 0;
 	int type = 0;
 	char *pnxtjid = NULL;
+	job **pjobs = NULL;
+	int njobs;
+	int nhist;
+	int ix = 0;
+	static char hist_states[] = {JOB_STATE_LTR_MOVED, JOB_STATE_LTR_FINISHED, '\0'};
+	static char live_states[] = {JOB_STATE_LTR_TRANSIT, JOB_STATE_LTR_QUEUED,
+		JOB_STATE_LTR_HELD, JOB_STATE_LTR_WAITING, JOB_STATE_LTR_RUNNING,
+		JOB_STATE_LTR_EXITING, JOB_STATE_LTR_EXPIRED, JOB_STATE_LTR_BEGUN, '\0'};
 
 	/* check for any extended flag in the batch request. 't' for
 	 * the sub jobs. If 'x' is there, then check if the server is
@@ -389,20 +397,41 @@ req_stat_job(struct batch_request *preq)
 		return;
 
 	} else {
-		pjob = (job *) GET_NEXT(type == 2 ? pque->qu_jobs : svr_alljobs);
+		/*
+		 * If history jobs are not wanted and make up most of the jobs,
+		 * take the other jobs from the state index instead of skipping
+		 * over the history jobs one by one.
+		 */
+		njobs = -1;
+		if (!dohistjobs) {
+			nhist = count_jobs_by_state(hist_states, pque);
+			if (nhist > (type == 2 ? pque->qu_numjobs : server.sv_qs.sv_numjobs) / 2)
+				njobs = find_jobs_by_state(live_states, pque, &pjobs);
+		}
+		if (njobs >= 0)
+			pjob = (njobs > 0) ? pjobs[0] : NULL;
+		else
+			pjob = (job *) GET_NEXT(type == 2 ? pque->qu_jobs : svr_alljobs);
 		while (pjob) {
 			rc = do_stat_of_a_job(preq, pjob, dohistjobs, dosubjobs);
 			if (rc != PBSE_NONE) {
+				free(pjobs);
 				req_reject(rc, bad, preq);
 				return;
 			}
-			pjob = (job *) GET_NEXT(type == 2 ? pjob->ji_jobque : pjob->ji_alljobs);
+			if (njobs >= 0)
+				pjob = (++ix < njobs) ? pjobs[ix] : NULL;
+			else
+				pjob = (job *) GET_NEXT(type == 2 ? pjob->ji_jobque : pjob->ji_alljobs);
 			if (preply->brp_count >= MAX_JOBS_PER_REPLY && pjob) {
 				rc = reply_send_status_part(preq);
-				if (rc != PBSE_NONE)
+				if (rc != PBSE_NONE) {
+					free(pjobs);
 					return;
+				}
 			}
 		}
+		free(pjobs);
 	}
 
 	if (rc && rc != PBSE_PERM)
@@ -526,6 +555,7 @@ status_que(pbs_queue *pque, struct batch_request *preq, pbs_list_head *pstathd)
 	strcpy(pstat->brp_objname, pque->qu_qs.qu_name);
 	CLEAR_LINK(pstat->brp_stlink);
 	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_blob = NULL;
 	append_link(pstathd, &pstat->brp_stlink, pstat);
 	preq->rq_reply.brp_count++;
 
@@ -680,6 +710,7 @@ status_node(struct pbsnode *pnode, struct batch_request *preq, pbs_list_head *ps
 	strcpy(pstat->brp_objname, pnode->nd_name);
 	CLEAR_LINK(pstat->brp_stlink);
 	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_blob = NULL;
 
 	/*add this new brp_status structure to the list hanging off*/
 	/*the request's reply substructure                         */
@@ -792,6 +823,7 @@ req_stat_svr(struct batch_request *preq)
 	strcpy(pstat->brp_objname, server_name);
 	pstat->brp_objtype = MGR_OBJ_SERVER;
 	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_blob = NULL;
 	append_link(&preply->brp_un.brp_status, &pstat->brp_stlink, pstat);
 	preply->brp_count++;
 
@@ -886,6 +918,7 @@ status_sched(pbs_sched *psched, struct batch_request *preq, pbs_list_head *pstat
 
 	CLEAR_LINK(pstat->brp_stlink);
 	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_blob = NULL;
 	append_link(pstathd, &pstat->brp_stlink, pstat);
 	preq->rq_reply.brp_count++;
 
@@ -1107,6 +1140,7 @@ status_resv(resc_resv *presv, struct batch_request *preq, pbs_list_head *pstathd
 	strcpy(pstat->brp_objname, presv->ri_qs.ri_resvID);
 	CLEAR_LINK(pstat->brp_stlink);
 	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_blob = NULL;
 	append_link(pstathd, &pstat->brp_stlink, pstat);
 	preq->rq_reply.brp_count++;
 
@@ -1115,8 +1149,8 @@ status_resv(resc_resv *presv, struct batch_request *preq, pbs_list_head *pstathd
 	bad = 0;	/*global: record ordinal position where got error*/
 	pal = (svrattrl *) GET_NEXT(preq->rq_ind.rq_status.rq_attr);
 
-	if (status_attrib(pal, resv_attr_idx, resv_attr_def, presv->ri_wattr,
-		RESV_ATR_LAST, preq->rq_perm, &pstat->brp_attr, &bad) == 0)
+	if (status_attrib_cached(presv->ri_stcache, preq, pal, resv_attr_idx, resv_attr_def,
+		presv->ri_wattr, RESV_ATR_LAST, pstat, &bad) == 0)
 		return (0);
 	else
 		return (PBSE_NOATTR);
@@ -1160,6 +1194,7 @@ status_resc(struct resource_def *prd, struct batch_request *preq, pbs_list_head
 	strcpy(pstat->brp_objname, prd->rs_name);
 	CLEAR_LINK(pstat->brp_stlink);
 	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_blob = NULL;
 
 	/* add attributes to the status reply */
 	if (private) {
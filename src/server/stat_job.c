@@ -48,6 +48,9 @@
  * Included funtions are:
  *	svrcached()
  *	status_attrib()
+ *	release_status_blob()
+ *	free_status_cache()
+ *	status_attrib_cached()
  *	status_job()
  *	status_subjob()
  *
@@ -72,6 +75,7 @@
 #include "svrfunc.h"
 #include "pbs_ifl.h"
 #include "ifl_internal.h"
+#include "dis.h"
 
 
 /* Global Data Items: */
@@ -82,6 +86,27 @@ extern struct server server;
 extern char	     statechars[];
 extern time_t time_now;
 
+/*
+ * Whole object status cache: the DIS encoding of the full attribute list
+ * of an object for one view (user or privileged).  The cached svrattrl
+ * of each attribute that went into the encoding is pinned by a reference,
+ * so it can not be freed and its address reused while the cache exists;
+ * the cache is valid as long as every attribute still has the same cached
+ * svrattrl and none is marked ATR_VFLAG_MODCACHE.
+ */
+struct status_pin {
+	int sp_index;		/* attribute index */
+	svrattrl *sp_encoded;	/* its cached svrattrl, NULL if set but empty */
+};
+
+struct status_cache {
+	struct status_blob sc_blob;	/* must be first, shared with replies */
+	int sc_priv;			/* privilege the cache was built for */
+	int sc_hidden;			/* value of show_hidden_attribs */
+	int sc_npins;
+	struct status_pin *sc_pins;
+};
+
 /**
  * @brief
  * 		svrcached - either link in (to phead) a cached svrattrl struct which is
@@ -106,6 +131,7 @@ svrcached(attribute *pat, pbs_list_head *phead, attribute_def *pdef)
 	svrattrl *working = NULL;
 	svrattrl *wcopy;
 	svrattrl *encoded;
+	int rc;
 
 	if (pdef == NULL)
 		return;
@@ -120,9 +146,9 @@ svrcached(attribute *pat, pbs_list_head *phead, attribute_def *pdef)
 		encoded = NULL;
 	} else {
 		if (resc_access_perm & PRIV_READ)
-			encoded = pat->at_priv_encoded;
+			encoded = get_attr_priv_encoded(pat);
 		else
-			encoded = pat->at_user_encoded;
+			encoded = get_attr_usr_encoded(pat);
 	}
 
 	if ((encoded == NULL) || (pat->at_flags & ATR_VFLAG_MODCACHE)) {
@@ -131,9 +157,11 @@ svrcached(attribute *pat, pbs_list_head *phead, attribute_def *pdef)
 			(void)pdef->at_encode(pat, phead, pdef->at_name,
 				NULL, ATR_ENCODE_CLIENT, &working);
 			if (resc_access_perm & PRIV_READ)
-				pat->at_priv_encoded = working;
+				rc = set_attr_priv_encoded(pat, working);
 			else
-				pat->at_user_encoded = working;
+				rc = set_attr_usr_encoded(pat, working);
+			if (rc != 0)
+				return;		/* not cached, the reply owns it */
 
 			pat->at_flags &= ~ATR_VFLAG_MODCACHE;
 			while (working) {
@@ -228,6 +256,392 @@ status_attrib(svrattrl *pal, void *pidx, attribute_def *padef, attribute *pattr,
 	return (0);
 }
 
+/**
+ * @brief
+ * 		unpin_svrcache - drop a status cache reference on a cached svrattrl,
+ *		freeing it as free_svrcache() would if it was the last one
+ *
+ * @param[in]	working	-	cached svrattrl, head of the sister chain
+ */
+static void
+unpin_svrcache(svrattrl *working)
+{
+	svrattrl *sister;
+
+	if (working == NULL || --working->al_refct > 0)
+		return;
+	while (working) {
+		sister = working->al_sister;
+		delete_link(&working->al_link);
+		free(working);
+		working = sister;
+	}
+}
+
+/**
+ * @brief
+ * 		release_status_blob - drop a reference on a status blob, freeing
+ *		the status cache holding it when it was the last one
+ *
+ * @param[in]	blob	-	blob of a status cache
+ */
+void
+release_status_blob(struct status_blob *blob)
+{
+	struct status_cache *pc = (struct status_cache *)blob;
+	int i;
+
+	if (blob == NULL || --blob->sb_refct > 0)
+		return;
+
+	for (i = 0; i < pc->sc_npins; i++)
+		unpin_svrcache(pc->sc_pins[i].sp_encoded);
+	free(pc->sc_pins);
+	free(blob->sb_data);
+	free(pc);
+}
+
+/**
+ * @brief
+ * 		free_status_cache - release the status caches of an object
+ *
+ * @param[in,out]	cache	-	the object's caches, one per view and encoding
+ */
+void
+free_status_cache(struct status_cache **cache)
+{
+	int i;
+
+	for (i = 0; i < PBS_STCACHE_VIEWS; i++) {
+		if (cache[i] != NULL) {
+			release_status_blob(&cache[i]->sc_blob);
+			cache[i] = NULL;
+		}
+	}
+}
+
+/**
+ * @brief
+ * 		attrib_hidden - true if svrcached() would skip the attribute
+ */
+static int
+attrib_hidden(attribute_def *pdef)
+{
+	return ((pdef->at_flags & ATR_DFLAG_HIDDEN) &&
+		(server.sv_attr[(int)SVR_ATR_show_hidden_attribs].at_val.at_long == 0));
+}
+
+/**
+ * @brief
+ * 		status_cache_valid - check that the attributes of an object would
+ *		encode to what the status cache holds
+ *
+ * @param[in]	pc	-	status cache
+ * @param[in]	padef	-	attribute definitions
+ * @param[in]	pattr	-	attributes of the object
+ * @param[in]	limit	-	number of attributes
+ * @param[in]	priv	-	user-client privilege, as in status_attrib()
+ *
+ * @return	int
+ * @retval	1	: cache can be used
+ * @retval	0	: cache is out of date
+ */
+static int
+status_cache_valid(struct status_cache *pc, attribute_def *padef, attribute *pattr, int limit, int priv)
+{
+	int index;
+	int ip = 0;
+	struct status_pin *pin;
+	svrattrl *encoded;
+	attribute *pat;
+
+	if (pc->sc_blob.sb_data == NULL || pc->sc_priv != priv ||
+		pc->sc_hidden != server.sv_attr[(int)SVR_ATR_show_hidden_attribs].at_val.at_long)
+		return 0;
+
+	for (index = 0; index < limit; index++) {
+		if (((padef + index)->at_flags & priv) == 0 || attrib_hidden(padef + index))
+			continue;
+		pat = pattr + index;
+		pin = NULL;
+		if (ip < pc->sc_npins && pc->sc_pins[ip].sp_index == index)
+			pin = &pc->sc_pins[ip++];
+
+		if (pat->at_flags & ATR_VFLAG_MODCACHE) {
+			/* set values will be encoded again, unset ones give nothing */
+			if (is_attr_set(pat) || pin != NULL)
+				return 0;
+			continue;
+		}
+		encoded = (priv & PRIV_READ) ? get_attr_priv_encoded(pat) : get_attr_usr_encoded(pat);
+		if (encoded != NULL || is_attr_set(pat)) {
+			if (pin == NULL || pin->sp_encoded != encoded)
+				return 0;
+		} else if (pin != NULL)
+			return 0;
+	}
+	return (ip == pc->sc_npins);
+}
+
+/**
+ * @brief
+ * 		status_cache_build - create a status cache for the attribute
+ *		list just built by status_attrib(), pinning the cached svrattrl
+ *		of each attribute.  The encoding itself is saved when the reply
+ *		is encoded, see encode_DIS_reply().
+ *
+ * @param[in]	padef	-	attribute definitions
+ * @param[in]	pattr	-	attributes of the object
+ * @param[in]	limit	-	number of attributes
+ * @param[in]	priv	-	user-client privilege, as in status_attrib()
+ *
+ * @return	struct status_cache *
+ * @retval	new cache, with one reference for the object
+ * @retval	NULL	: out of memory
+ */
+static struct status_cache *
+status_cache_build(attribute_def *padef, attribute *pattr, int limit, int priv)
+{
+	struct status_cache *pc;
+	int index;
+	svrattrl *encoded;
+	attribute *pat;
+
+	pc = calloc(1, sizeof(struct status_cache));
+	if (pc == NULL)
+		return NULL;
+	pc->sc_pins = malloc(limit * sizeof(struct status_pin));
+	if (pc->sc_pins == NULL) {
+		free(pc);
+		return NULL;
+	}
+	pc->sc_blob.sb_refct = 1;
+	pc->sc_priv = priv;
+	pc->sc_hidden = server.sv_attr[(int)SVR_ATR_show_hidden_attribs].at_val.at_long;
+
+	for (index = 0; index < limit; index++) {
+		if (((padef + index)->at_flags & priv) == 0 || attrib_hidden(padef + index))
+			continue;
+		pat = pattr + index;
+		if (pat->at_flags & ATR_VFLAG_MODCACHE)
+			continue;	/* unset, not encoded by svrcached() */
+		encoded = (priv & PRIV_READ) ? get_attr_priv_encoded(pat) : get_attr_usr_encoded(pat);
+		if (encoded == NULL && !is_attr_set(pat))
+			continue;
+		pc->sc_pins[pc->sc_npins].sp_index = index;
+		pc->sc_pins[pc->sc_npins].sp_encoded = encoded;
+		pc->sc_npins++;
+		if (encoded != NULL)
+			encoded->al_refct++;
+	}
+	return pc;
+}
+
+/**
+ * @brief
+ * 		status_attrib_cached - status_attrib() for an object which keeps
+ *		status caches
+ *
+ * @par
+ *		When all attributes are asked for by a remote client, a valid
+ *		cache is attached to the status entry and its encoding is copied
+ *		into the reply in one piece; otherwise the attribute list is built
+ *		as usual and a new cache is attached, to be filled when the reply
+ *		is encoded.  Each view is cached apart for the string and the
+ *		binary encoding of DIS, since a cache is spliced into replies as
+ *		encoded bytes.
+ *
+ * @param[in,out]	cache	-	the object's caches, one per view and encoding
+ * @param[in]		preq	-	status request
+ * @param[in]		pal	-	specific attributes to status
+ * @param[in]		pidx	-	search index of the attribute array
+ * @param[in]		padef	-	attribute definitions
+ * @param[in]		pattr	-	attributes of the object
+ * @param[in]		limit	-	number of attributes
+ * @param[in,out]	pstat	-	status entry of the object
+ * @param[out]		bad	-	RETURN: index of first bad attribute
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	-1	: on error (bad attribute)
+ */
+int
+status_attrib_cached(struct status_cache **cache, struct batch_request *preq, svrattrl *pal, void *pidx,
+	attribute_def *padef, attribute *pattr, int limit, struct brp_status *pstat, int *bad)
+{
+	int priv = preq->rq_perm & (ATR_DFLAG_RDACC | ATR_DFLAG_SvWR);
+	int view;
+	struct status_cache *pc;
+
+	if (pal != NULL || preq->rq_conn == PBS_LOCAL_CONNECTION)
+		return status_attrib(pal, pidx, padef, pattr, limit, preq->rq_perm, &pstat->brp_attr, bad);
+
+	view = ((priv & PRIV_READ) ? 2 : 0) + (dis_is_binary(preq->rq_conn) ? 1 : 0);
+	pc = cache[view];
+
+	if (pc != NULL && status_cache_valid(pc, padef, pattr, limit, priv)) {
+		pc->sc_blob.sb_refct++;
+		pstat->brp_blob = &pc->sc_blob;
+		return 0;
+	}
+
+	if (status_attrib(pal, pidx, padef, pattr, limit, preq->rq_perm, &pstat->brp_attr, bad) != 0)
+		return -1;
+
+	if (pc != NULL) {
+		cache[view] = NULL;
+		release_status_blob(&pc->sc_blob);
+	}
+	if ((pc = status_cache_build(padef, pattr, limit, priv)) != NULL) {
+		cache[view] = pc;
+		pc->sc_blob.sb_refct++;
+		pstat->brp_blob = &pc->sc_blob;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ * 		new_job_status - allocate the status entry of a job and append
+ *		it to the reply
+ *
+ * @param[in]		pjob	-	job to status
+ * @param[in,out]	preq	-	request structure
+ * @param[in,out]	pstathd	-	RETURN: head of list to append status to
+ * @param[in]		dosubjobs -	flag to expand a Array job to include all subjobs
+ *
+ * @return	struct brp_status *
+ * @retval	new status entry
+ * @retval	NULL	: out of memory
+ */
+static struct brp_status *
+new_job_status(job *pjob, struct batch_request *preq, pbs_list_head *pstathd, int dosubjobs)
+{
+	struct brp_status *pstat;
+
+	pstat = (struct brp_status *)malloc(sizeof(struct brp_status));
+	if (pstat == NULL)
+		return NULL;
+	CLEAR_LINK(pstat->brp_stlink);
+	if ((pjob->ji_qs.ji_svrflags & JOB_SVFLG_ArrayJob) != 0 && dosubjobs)
+		pstat->brp_objtype = MGR_OBJ_JOBARRAY_PARENT;
+	else if ((pjob->ji_qs.ji_svrflags & JOB_SVFLG_SubJob) != 0 && dosubjobs)
+		pstat->brp_objtype = MGR_OBJ_SUBJOB;
+	else
+		pstat->brp_objtype = MGR_OBJ_JOB;
+	(void)strcpy(pstat->brp_objname, pjob->ji_qs.ji_jobid);
+	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_blob = NULL;
+	append_link(pstathd, &pstat->brp_stlink, pstat);
+	preq->rq_reply.brp_count++;
+	return pstat;
+}
+
+/**
+ * @brief
+ * 		status_frozen_attr - add to a status reply the values a frozen
+ *		history job kept of one or all of its attributes, leaving out
+ *		what status_attrib() would for the requester
+ *
+ * @param[in]		pfz	-	frozen job
+ * @param[in]		index	-	attribute index, -1 for all
+ * @param[in]		priv	-	user-client privilege, as in status_attrib()
+ * @param[in,out]	phead	-	RETURN: list to append the values to
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	-1	: out of memory
+ */
+static int
+status_frozen_attr(struct frozen_job *pfz, int index, int priv, pbs_list_head *phead)
+{
+	struct frozen_value fv;
+	attribute_def *pdef;
+	svrattrl *pal;
+	char *p = pfz->fz_status;
+	char *end = p + pfz->fz_statuslen;
+	char *name;
+	char *resc;
+	char *value;
+
+	while (p < end) {
+		memcpy(&fv, p, sizeof(fv));
+		name = p + sizeof(fv);
+		resc = name + strlen(name) + 1;
+		value = resc + strlen(resc) + 1;
+		p = value + strlen(value) + 1;
+
+		if (index != -1 && fv.fv_index != index) {
+			if (fv.fv_index > index)
+				break;	/* values are in attribute index order */
+			continue;
+		}
+		pdef = &job_attr_def[fv.fv_index];
+		if ((pdef->at_flags & priv) == 0 || attrib_hidden(pdef))
+			continue;
+		if (*resc != '\0' && (fv.fv_rflags & priv) == 0)
+			continue;
+		/* as status_job() hides them when eligible_time_enable is off */
+		if ((fv.fv_index == JOB_ATR_eligible_time || fv.fv_index == JOB_ATR_accrue_type) &&
+			server.sv_attr[(int)SVR_ATR_EligibleTimeEnable].at_val.at_long == 0)
+			continue;
+
+		pal = attrlist_create(name, *resc != '\0' ? resc : NULL, strlen(value));
+		if (pal == NULL)
+			return -1;
+		strcpy(pal->al_value, value);
+		pal->al_flags = fv.fv_flags;
+		pal->al_op = fv.fv_op;
+		append_link(phead, &pal->al_link, pal);
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ * 		status_frozen_job - status_job() for a frozen history job, served
+ *		from the encoded values job_freeze() kept, without thawing it
+ *
+ * @param[in]		pjob	-	frozen job
+ * @param[in]		preq	-	request structure
+ * @param[in]		pal	-	specific attributes to status
+ * @param[in,out]	pstathd	-	RETURN: head of list to append status to
+ * @param[out]		bad	-	RETURN: index of first bad attribute
+ * @param[in]		dosubjobs -	flag to expand a Array job to include all subjobs
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	PBSE_SYSTEM	: memory allocation error
+ * @retval	PBSE_NOATTR	: attribute error
+ */
+static int
+status_frozen_job(job *pjob, struct batch_request *preq, svrattrl *pal, pbs_list_head *pstathd, int *bad, int dosubjobs)
+{
+	struct brp_status *pstat;
+	int priv = preq->rq_perm & (ATR_DFLAG_RDACC | ATR_DFLAG_SvWR);
+	int index;
+	int nth = 0;
+
+	if ((pstat = new_job_status(pjob, preq, pstathd, dosubjobs)) == NULL)
+		return (PBSE_SYSTEM);
+
+	*bad = 0;
+	if (pal == NULL)
+		return (status_frozen_attr(pjob->ji_frozen, -1, priv, &pstat->brp_attr) ? PBSE_SYSTEM : 0);
+
+	for (; pal != NULL; pal = (svrattrl *)GET_NEXT(pal->al_link)) {
+		++nth;
+		index = find_attr(job_attr_idx, job_attr_def, pal->al_name);
+		if (index < 0) {
+			*bad = nth;
+			return (PBSE_NOATTR);
+		}
+		if (status_frozen_attr(pjob->ji_frozen, index, priv, &pstat->brp_attr))
+			return (PBSE_SYSTEM);
+	}
+	return (0);
+}
+
 /**
  * @brief
  * 		status_job - Build the status reply for a single job, regular or Array,
@@ -262,6 +676,9 @@ status_job(job *pjob, struct batch_request *preq, svrattrl *pal, pbs_list_head *
 		if (svr_authorize_jobreq(preq, pjob))
 			return (PBSE_PERM);
 
+	if (pjob->ji_frozen != NULL)
+		return (status_frozen_job(pjob, preq, pal, pstathd, bad, dosubjobs));
+
 	/* calc eligible time on the fly and return, don't save. */
 	if (server.sv_attr[SVR_ATR_EligibleTimeEnable].at_val.at_long == TRUE) {
 		if (get_jattr_long(pjob, JOB_ATR_accrue_type) == JOB_ELIGIBLE) {
@@ -289,20 +706,8 @@ status_job(job *pjob, struct batch_request *preq, svrattrl *pal, pbs_list_head *
 
 	/* allocate reply structure and fill in header portion */
 
-	pstat = (struct brp_status *)malloc(sizeof(struct brp_status));
-	if (pstat == NULL)
+	if ((pstat = new_job_status(pjob, preq, pstathd, dosubjobs)) == NULL)
 		return (PBSE_SYSTEM);
-	CLEAR_LINK(pstat->brp_stlink);
-	if ((pjob->ji_qs.ji_svrflags & JOB_SVFLG_ArrayJob) != 0 && dosubjobs)
-		pstat->brp_objtype = MGR_OBJ_JOBARRAY_PARENT;
-	else if ((pjob->ji_qs.ji_svrflags & JOB_SVFLG_SubJob) != 0 && dosubjobs)
-		pstat->brp_objtype = MGR_OBJ_SUBJOB;
-	else
-		pstat->brp_objtype = MGR_OBJ_JOB;
-	(void)strcpy(pstat->brp_objname, pjob->ji_qs.ji_jobid);
-	CLEAR_HEAD(pstat->brp_attr);
-	append_link(pstathd, &pstat->brp_stlink, pstat);
-	preq->rq_reply.brp_count++;
 
 	/* Temporarily set suspend/user suspend states for the stat */
 	if (check_job_state(pjob, JOB_STATE_LTR_RUNNING)) {
@@ -318,7 +723,14 @@ status_job(job *pjob, struct batch_request *preq, svrattrl *pal, pbs_list_head *
 	/* add attributes to the status reply */
 
 	*bad = 0;
-	if (status_attrib(pal, job_attr_idx, job_attr_def, pjob->ji_wattr, JOB_ATR_LAST, preq->rq_perm, &pstat->brp_attr, bad))
+	if (revert_state_r ||
+		(server.sv_attr[SVR_ATR_EligibleTimeEnable].at_val.at_long == TRUE &&
+		get_jattr_long(pjob, JOB_ATR_accrue_type) == JOB_ELIGIBLE)) {
+		/* values made up for this status only, not worth caching */
+		free_status_cache(pjob->ji_stcache);
+		if (status_attrib(pal, job_attr_idx, job_attr_def, pjob->ji_wattr, JOB_ATR_LAST, preq->rq_perm, &pstat->brp_attr, bad))
+			return (PBSE_NOATTR);
+	} else if (status_attrib_cached(pjob->ji_stcache, preq, pal, job_attr_idx, job_attr_def, pjob->ji_wattr, JOB_ATR_LAST, pstat, bad))
 		return (PBSE_NOATTR);
 
 	/* reset eligible time, it was calctd on the fly, real calctn only when accrue_type changes */
@@ -395,6 +807,13 @@ status_subjob(job *pjob, struct batch_request *preq, svrattrl *pal, int subj, pb
 	if (sjst == JOB_STATE_LTR_UNKNOWN)
 		return PBSE_UNKJOBID;
 
+	/* the parent's attributes are statused, not what it kept frozen */
+	if (pjob->ji_frozen != NULL) {
+		(void)job_thaw(pjob);
+		if (pjob->ji_frozen != NULL)
+			return PBSE_SYSTEM;
+	}
+
 	/* otherwise we fake it with info from the parent      */
 	/* allocate reply structure and fill in header portion */
 
@@ -416,6 +835,7 @@ status_subjob(job *pjob, struct batch_request *preq, svrattrl *pal, int subj, pb
 		pstat->brp_objtype = MGR_OBJ_JOB;
 	(void)strcpy(pstat->brp_objname, objname);
 	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_blob = NULL;
 	append_link(pstathd, &pstat->brp_stlink, pstat);
 	preq->rq_reply.brp_count++;
 
@@ -144,8 +144,8 @@ svr_renew_creds(struct work_task *pwt)
 		/* save the next job */
 		nxpjob = (job *)GET_NEXT(pjob->ji_alljobs);
 
-		if ((is_jattr_set(pjob, JOB_ATR_cred_id)) &&
-			check_job_state(pjob, JOB_STATE_LTR_RUNNING)) {
+		if (check_job_state(pjob, JOB_STATE_LTR_RUNNING) &&
+			(is_jattr_set(pjob, JOB_ATR_cred_id))) {
 
 			if ((is_jattr_set(pjob, JOB_ATR_cred_validity)) &&
 				(get_jattr_long(pjob,  JOB_ATR_cred_validity) - svr_cred_renew_period <= time_now)) {
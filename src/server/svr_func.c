@@ -62,6 +62,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <signal.h>
+#include <openssl/sha.h>
 #include "server_limits.h"
 #include "list_link.h"
 #include "log.h"
@@ -6598,9 +6599,140 @@ extern char *msg_script_open;
 extern char *msg_script_write;
 extern char *path_spool;
 
+/*
+ * Scripts recently saved or loaded, by content hash.  Jobs submitted from
+ * the same script share one copy in the datastore, and the copy kept here
+ * saves loading it again for each of them when they are sent to a MoM.
+ */
+#define SCRIPT_CACHE_SLOTS	32
+#define SCRIPT_CACHE_MAXSZ	(1024 * 1024)	/* larger scripts are not kept */
+
+static struct script_cache_ent {
+	char		sce_hash[PBS_DB_SCRHASH_LEN + 1];
+	char		*sce_script;
+	size_t		sce_len;
+	unsigned long	sce_used;	/* for replacing the least recently used */
+} script_cache[SCRIPT_CACHE_SLOTS];
+static unsigned long script_cache_clock;
+
+/*
+ * @brief
+ *  	Compute the key under which a job script is stored, the SHA-256
+ *  	of its content in hex
+ *
+ * @param[in]  script - the job script
+ * @param[out] hash - buffer of at least PBS_DB_SCRHASH_LEN + 1 chars
+ *
+ * @return void
+ */
+static void
+script_hash(char *script, char *hash)
+{
+	unsigned char md[SHA256_DIGEST_LENGTH];
+	int i;
+
+	SHA256((const unsigned char *) script, strlen(script), md);
+	for (i = 0; i < SHA256_DIGEST_LENGTH; i++)
+		sprintf(hash + i * 2, "%02x", md[i]);
+}
+
+/*
+ * @brief
+ *  	Find a script in the script cache
+ *
+ * @param[in] hash - key of the script
+ *
+ * @return cache entry
+ * @retval NULL - script is not cached
+ */
+static struct script_cache_ent *
+script_cache_find(char *hash)
+{
+	int i;
+
+	for (i = 0; i < SCRIPT_CACHE_SLOTS; i++) {
+		if (script_cache[i].sce_script != NULL &&
+		    strcmp(script_cache[i].sce_hash, hash) == 0) {
+			script_cache[i].sce_used = ++script_cache_clock;
+			return &script_cache[i];
+		}
+	}
+	return NULL;
+}
+
 /*
  * @brief
- *  	Loads the job-script associated to the job from the database.
+ *  	Add a script to the script cache, replacing the least recently
+ *  	used one if the cache is full
+ *
+ * @param[in] hash - key of the script
+ * @param[in] script - the script, copied into the cache
+ *
+ * @return void
+ */
+static void
+script_cache_add(char *hash, char *script)
+{
+	struct script_cache_ent *pe;
+	size_t len;
+	int i;
+
+	len = strlen(script);
+	if (len > SCRIPT_CACHE_MAXSZ || script_cache_find(hash) != NULL)
+		return;
+
+	pe = &script_cache[0];
+	for (i = 1; i < SCRIPT_CACHE_SLOTS && pe->sce_script != NULL; i++) {
+		if (script_cache[i].sce_script == NULL ||
+		    script_cache[i].sce_used < pe->sce_used)
+			pe = &script_cache[i];
+	}
+	free(pe->sce_script);
+	if ((pe->sce_script = malloc(len + 1)) == NULL)
+		return;
+	memcpy(pe->sce_script, script, len + 1);
+	pe->sce_len = len;
+	snprintf(pe->sce_hash, sizeof(pe->sce_hash), "%s", hash);
+	pe->sce_used = ++script_cache_clock;
+}
+
+/*
+ * @brief
+ *  	Saves the job-script of a new job (pj->ji_script) to the database.
+ *  	A script already stored for another job is not stored again, the
+ *  	job refers to the stored copy.
+ *
+ * @param[in] pj - Job pointer, with the script in pj->ji_script
+ *
+ * @return Error code
+ * @retval 0  - Success
+ * @retval !0 - Failed to save job script
+ *
+ */
+int
+svr_save_jobscript(job *pj)
+{
+	pbs_db_jobscr_info_t jobscr;
+	pbs_db_obj_info_t obj;
+
+	strcpy(jobscr.ji_jobid, pj->ji_qs.ji_jobid);
+	script_hash(pj->ji_script, jobscr.sc_hash);
+	jobscr.sc_hashonly = 0;
+	jobscr.script = pj->ji_script;
+	obj.pbs_db_obj_type = PBS_DB_JOBSCR;
+	obj.pbs_db_un.pbs_db_jobscr = &jobscr;
+
+	if (pbs_db_save_obj(svr_db_conn, &obj, OBJ_SAVE_NEW) != 0)
+		return 1;
+
+	script_cache_add(jobscr.sc_hash, pj->ji_script);
+	return 0;
+}
+
+/*
+ * @brief
+ *  	Loads the job-script associated to the job from the script cache,
+ *  	or else from the database.
  *  	It populates the ji_script field of the job as well as returns
  *      a pointer to the script
  *
@@ -6617,6 +6749,7 @@ svr_load_jobscript(job *pj)
 	void *conn = (void *) svr_db_conn;
 	pbs_db_jobscr_info_t jobscr;
 	pbs_db_obj_info_t obj;
+	struct script_cache_ent *pe;
 
 	if (pj->ji_script) {
 		free(pj->ji_script);
@@ -6628,6 +6761,8 @@ svr_load_jobscript(job *pj)
 	} else {
 		strcpy(jobscr.ji_jobid, pj->ji_qs.ji_jobid);
 	}
+	jobscr.sc_hash[0] = '\0';
+	jobscr.sc_hashonly = 1;
 	jobscr.script = NULL;
 	obj.pbs_db_obj_type = PBS_DB_JOBSCR;
 	obj.pbs_db_un.pbs_db_jobscr = &jobscr;
@@ -6640,6 +6775,22 @@ svr_load_jobscript(job *pj)
 		return NULL;
 	}
 
+	if ((pe = script_cache_find(jobscr.sc_hash)) != NULL) {
+		if ((jobscr.script = malloc(pe->sce_len + 1)) != NULL)
+			memcpy(jobscr.script, pe->sce_script, pe->sce_len + 1);
+	} else {
+		jobscr.sc_hashonly = 0;
+		if (pbs_db_load_obj(conn, &obj) != 0) {
+			snprintf(log_buffer, sizeof(log_buffer),
+				"Failed to load job script for job %s from PBS datastore",
+				pj->ji_qs.ji_jobid);
+			log_err(-1, __func__, log_buffer);
+			return NULL;
+		}
+		if (jobscr.script != NULL)
+			script_cache_add(jobscr.sc_hash, jobscr.script);
+	}
+
 	if (jobscr.script == NULL) {
 		snprintf(log_buffer, sizeof(log_buffer),
 			"Out of memory loading script for job %s from PBS datastore",
@@ -61,6 +61,7 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/poll.h>
+#include <sys/mman.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include "pbs_ifl.h"
@@ -83,6 +84,7 @@
 #include "log.h"
 #include "acct.h"
 #include "pbs_idx.h"
+#include "pbs_heap.h"
 #include "pbs_nodes.h"
 #include "svrfunc.h"
 #include "sched_cmds.h"
@@ -100,6 +102,27 @@
 
 char statechars[] = "TQHWREXBMF";
 
+/*
+ * Secondary job indexes, used by select and status requests to avoid
+ * walking every job in the server: server jobs linked by state, and
+ * server jobs linked by the user name part of their owner.
+ */
+pbs_list_head svr_jobs_by_state[PBS_NUMJOBSTATE];
+
+struct owner_jobs {
+	pbs_list_head oj_jobs;		/* jobs of this owner, via ji_ownerjobs */
+	int oj_njobs;			/* number of jobs on oj_jobs */
+	char oj_name[PBS_MAXUSER + 1];	/* user name, the index key */
+};
+static void *owners_idx = NULL;
+
+/*
+ * History jobs ordered by their history timestamp.  The job history
+ * duration is the same for every job, so the top of the heap is always
+ * the next job due to be purged.
+ */
+void *svr_history_heap = NULL;
+
 /* Private Functions */
 
 static void default_std(job *, int key, char * to);
@@ -112,6 +135,8 @@ static void handle_qmgr_reply_to_startORenable(struct work_task *);
 static void delete_occurrence_jobs(resc_resv *presv);
 static void Time4occurrenceFinish(resc_resv *);
 static void running_jobs_count(struct work_task *);
+static void link_job_indexes(job *);
+static void unlink_job_indexes(job *);
 
 /* Global Data Items: */
 extern char *msg_noloopbackif;
@@ -128,6 +153,7 @@ extern char   server_host[];
 extern pbs_list_head svr_queues;
 extern int    comp_resc_lt;
 extern int    comp_resc_gt;
+extern int    resc_access_perm;
 extern time_t time_now;
 extern char  *resc_in_err;
 
@@ -190,6 +216,424 @@ tickle_for_reply(void)
 	(void)set_task(WORK_Timed, time_now + 10, 0, NULL);
 }
 
+/**
+ * @brief
+ * 		init_job_indexes - initialize the secondary job indexes
+ *		(jobs by state and jobs by owner)
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	-1	: failed to create the owners index
+ */
+int
+init_job_indexes(void)
+{
+	int i;
+
+	for (i = 0; i < PBS_NUMJOBSTATE; i++)
+		CLEAR_HEAD(svr_jobs_by_state[i]);
+
+	if (owners_idx == NULL) {
+		if ((owners_idx = pbs_idx_create(0, 0)) == NULL)
+			return -1;
+	}
+	if (svr_history_heap == NULL) {
+		if ((svr_history_heap = pbs_heap_create()) == NULL)
+			return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ * 		is_history_state - check whether a job state is one kept as job
+ *		history (moved, finished or expired)
+ *
+ * @param[in]	state	-	job state letter
+ *
+ * @return	int
+ * @retval	1	: history state
+ * @retval	0	: not a history state
+ */
+int
+is_history_state(char state)
+{
+	return (state == JOB_STATE_LTR_MOVED ||
+		state == JOB_STATE_LTR_FINISHED ||
+		state == JOB_STATE_LTR_EXPIRED);
+}
+
+/**
+ * @brief
+ * 		link_history_heap - add a history job to the history expiry heap,
+ *		keyed by its history timestamp.  A job without a timestamp yet
+ *		goes to the top so the next sweep sets one.
+ *
+ * @param[in]	pjob	-	history job
+ */
+static void
+link_history_heap(job *pjob)
+{
+	long key = 0;
+
+	if (svr_history_heap == NULL || IN_HEAP(pjob->ji_histheap))
+		return;
+	if (is_jattr_set(pjob, JOB_ATR_history_timestamp))
+		key = get_jattr_long(pjob, JOB_ATR_history_timestamp);
+	if (pbs_heap_insert(svr_history_heap, &pjob->ji_histheap, key, pjob) != 0)
+		log_joberr(PBSE_SYSTEM, __func__, "Failed to add job to history heap", pjob->ji_qs.ji_jobid);
+}
+
+/**
+ * @brief
+ * 		get_owner_key - copy the user name part of a job owner
+ *		(user@host) or of a user list entry into buf
+ *
+ * @param[in]	owner	-	owner string
+ * @param[out]	buf	-	buffer of size PBS_MAXUSER + 1
+ */
+static void
+get_owner_key(const char *owner, char *buf)
+{
+	int i;
+
+	for (i = 0; i < PBS_MAXUSER && owner[i] != '\0' && owner[i] != '@'; i++)
+		buf[i] = owner[i];
+	buf[i] = '\0';
+}
+
+/**
+ * @brief
+ * 		link_job_indexes - add a job which was just linked into the
+ *		server's job list to the state and owner indexes
+ *
+ * @param[in]	pjob	-	job to index
+ */
+static void
+link_job_indexes(job *pjob)
+{
+	int state_num;
+	char *owner;
+	char key[PBS_MAXUSER + 1];
+	void *pkey;
+	struct owner_jobs *poj = NULL;
+
+	state_num = get_job_state_num(pjob);
+	if (state_num != -1 && pjob->ji_statejobs.ll_next == &pjob->ji_statejobs)
+		append_link(&svr_jobs_by_state[state_num], &pjob->ji_statejobs, pjob);
+	if (is_history_state(get_job_state(pjob)))
+		link_history_heap(pjob);
+
+	if (owners_idx == NULL || pjob->ji_ownerjobs.ll_next != &pjob->ji_ownerjobs)
+		return;
+	if ((owner = get_jattr_str(pjob, JOB_ATR_job_owner)) == NULL)
+		return;
+
+	get_owner_key(owner, key);
+	pkey = key;
+	if (pbs_idx_find(owners_idx, &pkey, (void **)&poj, NULL) != PBS_IDX_RET_OK) {
+		poj = malloc(sizeof(struct owner_jobs));
+		if (poj == NULL) {
+			log_err(errno, __func__, "no memory");
+			return;
+		}
+		CLEAR_HEAD(poj->oj_jobs);
+		poj->oj_njobs = 0;
+		strcpy(poj->oj_name, key);
+		if (pbs_idx_insert(owners_idx, poj->oj_name, poj) != PBS_IDX_RET_OK) {
+			log_joberr(PBSE_INTERNAL, __func__, "Failed add job owner in index", pjob->ji_qs.ji_jobid);
+			free(poj);
+			return;
+		}
+	}
+	append_link(&poj->oj_jobs, &pjob->ji_ownerjobs, pjob);
+	poj->oj_njobs++;
+}
+
+/**
+ * @brief
+ * 		unlink_job_indexes - remove a job from the state and owner indexes
+ *
+ * @param[in]	pjob	-	job being removed from the server's job list
+ */
+static void
+unlink_job_indexes(job *pjob)
+{
+	char *owner;
+	char key[PBS_MAXUSER + 1];
+	void *pkey;
+	struct owner_jobs *poj = NULL;
+
+	delete_link(&pjob->ji_statejobs);
+	if (IN_HEAP(pjob->ji_histheap))
+		pbs_heap_delete(svr_history_heap, &pjob->ji_histheap);
+
+	if (pjob->ji_ownerjobs.ll_next == &pjob->ji_ownerjobs)
+		return;
+	delete_link(&pjob->ji_ownerjobs);
+	if ((owner = get_jattr_str(pjob, JOB_ATR_job_owner)) == NULL)
+		return;
+
+	get_owner_key(owner, key);
+	pkey = key;
+	if (pbs_idx_find(owners_idx, &pkey, (void **)&poj, NULL) != PBS_IDX_RET_OK)
+		return;
+	if (--poj->oj_njobs <= 0) {
+		pbs_idx_delete(owners_idx, poj->oj_name);
+		free(poj);
+	}
+}
+
+/**
+ * @brief
+ * 		update_job_state_index - move an indexed job to the state list
+ *		of its new state, and into or out of the history expiry heap.
+ *		Called before the state attribute is changed.
+ *
+ * @par
+ *		Job states without a state number (the suspend letters which
+ *		are only set while the job is being statused) leave the job
+ *		where it is.
+ *
+ * @param[in]	pjob	-	job changing state
+ * @param[in]	newstate	-	new job state letter
+ */
+void
+update_job_state_index(job *pjob, char newstate)
+{
+	int state_num;
+
+	if (pjob->ji_statejobs.ll_next == &pjob->ji_statejobs)
+		return;	/* not indexed */
+
+	state_num = state_char2int(newstate);
+	if (state_num == -1 || state_num == get_job_state_num(pjob))
+		return;
+
+	delete_link(&pjob->ji_statejobs);
+	append_link(&svr_jobs_by_state[state_num], &pjob->ji_statejobs, pjob);
+
+	if (is_history_state(newstate))
+		link_history_heap(pjob);
+	else if (IN_HEAP(pjob->ji_histheap))
+		pbs_heap_delete(svr_history_heap, &pjob->ji_histheap);
+}
+
+/**
+ * @brief
+ * 		cmp_job_qrank - qsort compare function, orders jobs by queue rank
+ *		which is the order of the server and queue job lists
+ */
+static int
+cmp_job_qrank(const void *a, const void *b)
+{
+	long ra = get_jattr_long(*(job **)a, JOB_ATR_qrank);
+	long rb = get_jattr_long(*(job **)b, JOB_ATR_qrank);
+
+	if (ra < rb)
+		return -1;
+	if (ra > rb)
+		return 1;
+	return 0;
+}
+
+/**
+ * @brief
+ * 		add_job_to_array - append a job to a growing array of job pointers
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	-1	: out of memory
+ */
+static int
+add_job_to_array(job *pjob, job ***pjobs, int *njobs, int *size)
+{
+	job **tmp;
+
+	if (*njobs == *size) {
+		*size = (*size == 0) ? 256 : *size * 2;
+		tmp = realloc(*pjobs, *size * sizeof(job *));
+		if (tmp == NULL) {
+			log_err(errno, __func__, "no memory");
+			return -1;
+		}
+		*pjobs = tmp;
+	}
+	(*pjobs)[(*njobs)++] = pjob;
+	return 0;
+}
+
+/**
+ * @brief
+ * 		count_jobs_by_state - number of jobs in any of the given states
+ *
+ * @param[in]	states	-	string of job state letters
+ * @param[in]	pque	-	count only jobs of this queue, NULL for the server
+ *
+ * @return	int - number of jobs
+ */
+int
+count_jobs_by_state(char *states, pbs_queue *pque)
+{
+	int seen[PBS_NUMJOBSTATE] = {0};
+	int state_num;
+	int count = 0;
+
+	for (; *states; states++) {
+		state_num = state_char2int(*states);
+		if (state_num == -1 || seen[state_num])
+			continue;
+		seen[state_num] = 1;
+		count += pque ? pque->qu_njstate[state_num] : server.sv_jobstates[state_num];
+	}
+	return count;
+}
+
+/**
+ * @brief
+ * 		find_jobs_by_state - collect the jobs in any of the given states
+ *		from the state index
+ *
+ * @param[in]	states	-	string of job state letters
+ * @param[in]	pque	-	collect only jobs of this queue, NULL for the server
+ * @param[out]	pjobs	-	malloc'ed array of jobs in queue rank order,
+ *				to be freed by the caller
+ *
+ * @return	int
+ * @retval	>=0	: number of jobs in *pjobs
+ * @retval	-1	: out of memory
+ */
+int
+find_jobs_by_state(char *states, pbs_queue *pque, job ***pjobs)
+{
+	int seen[PBS_NUMJOBSTATE] = {0};
+	int state_num;
+	int njobs = 0;
+	int size = 0;
+	job *pjob;
+
+	*pjobs = NULL;
+	for (; *states; states++) {
+		state_num = state_char2int(*states);
+		if (state_num == -1 || seen[state_num])
+			continue;
+		seen[state_num] = 1;
+		for (pjob = (job *)GET_NEXT(svr_jobs_by_state[state_num]); pjob;
+			pjob = (job *)GET_NEXT(pjob->ji_statejobs)) {
+			if (pque && pjob->ji_qhdr != pque)
+				continue;
+			if (add_job_to_array(pjob, pjobs, &njobs, &size) != 0) {
+				free(*pjobs);
+				*pjobs = NULL;
+				return -1;
+			}
+		}
+	}
+	if (njobs > 1)
+		qsort(*pjobs, njobs, sizeof(job *), cmp_job_qrank);
+	return njobs;
+}
+
+/**
+ * @brief
+ * 		count_jobs_by_owner - number of jobs owned by the users of a user list
+ *
+ * @par
+ *		The user name part of a user list entry always matches literally
+ *		(see user_match()), so the jobs of each named user are a superset
+ *		of the jobs the list selects.
+ *
+ * @param[in]	users	-	user list (user or user@host entries)
+ *
+ * @return	int
+ * @retval	>=0	: number of jobs
+ * @retval	-1	: the list can not be looked up in the owner index
+ */
+int
+count_jobs_by_owner(struct array_strings *users)
+{
+	int i;
+	int count = 0;
+	char key[PBS_MAXUSER + 1];
+	void *pkey;
+	struct owner_jobs *poj;
+
+	if (owners_idx == NULL || users == NULL || users->as_usedptr == 0)
+		return -1;
+
+	for (i = 0; i < users->as_usedptr; i++) {
+		if (*users->as_string[i] == '+' || *users->as_string[i] == '-')
+			return -1;	/* allow/deny lists are not simple names */
+		get_owner_key(users->as_string[i], key);
+		pkey = key;
+		poj = NULL;
+		if (pbs_idx_find(owners_idx, &pkey, (void **)&poj, NULL) == PBS_IDX_RET_OK)
+			count += poj->oj_njobs;
+	}
+	return count;
+}
+
+/**
+ * @brief
+ * 		find_jobs_by_owner - collect the jobs owned by the users of a
+ *		user list from the owner index
+ *
+ * @param[in]	users	-	user list, see count_jobs_by_owner()
+ * @param[in]	pque	-	collect only jobs of this queue, NULL for the server
+ * @param[out]	pjobs	-	malloc'ed array of jobs in queue rank order,
+ *				to be freed by the caller
+ *
+ * @return	int
+ * @retval	>=0	: number of jobs in *pjobs
+ * @retval	-1	: out of memory
+ */
+int
+find_jobs_by_owner(struct array_strings *users, pbs_queue *pque, job ***pjobs)
+{
+	int i;
+	int j;
+	int njobs = 0;
+	int size = 0;
+	char key[PBS_MAXUSER + 1];
+	void *pkey;
+	struct owner_jobs *poj;
+	job *pjob;
+
+	*pjobs = NULL;
+	for (i = 0; i < users->as_usedptr; i++) {
+		get_owner_key(users->as_string[i], key);
+
+		/* skip user names already collected */
+		for (j = 0; j < i; j++) {
+			char prev[PBS_MAXUSER + 1];
+
+			get_owner_key(users->as_string[j], prev);
+			if (strcmp(prev, key) == 0)
+				break;
+		}
+		if (j < i)
+			continue;
+
+		pkey = key;
+		poj = NULL;
+		if (pbs_idx_find(owners_idx, &pkey, (void **)&poj, NULL) != PBS_IDX_RET_OK)
+			continue;
+		for (pjob = (job *)GET_NEXT(poj->oj_jobs); pjob;
+			pjob = (job *)GET_NEXT(pjob->ji_ownerjobs)) {
+			if (pque && pjob->ji_qhdr != pque)
+				continue;
+			if (add_job_to_array(pjob, pjobs, &njobs, &size) != 0) {
+				free(*pjobs);
+				*pjobs = NULL;
+				return -1;
+			}
+		}
+	}
+	if (njobs > 1)
+		qsort(*pjobs, njobs, sizeof(job *), cmp_job_qrank);
+	return njobs;
+}
+
 /**
  * @brief
  * 		svr_enquejob	-	Enqueue the job into specified queue.
@@ -237,6 +681,7 @@ svr_enquejob(job *pjob, char *selectspec)
 					return PBSE_INTERNAL;
 				}
 				append_link(&svr_alljobs, &pjob->ji_alljobs, pjob);
+				link_job_indexes(pjob);
 			}
 			server.sv_qs.sv_numjobs++;
 			if (state_num != -1)
@@ -277,6 +722,7 @@ svr_enquejob(job *pjob, char *selectspec)
 		insert_link(&pjcur->ji_alljobs, &pjob->ji_alljobs, pjob,
 			LINK_INSET_AFTER);
 	}
+	link_job_indexes(pjob);
 
 	server.sv_qs.sv_numjobs++;
 	if (state_num != -1)
@@ -449,6 +895,7 @@ svr_dequejob(job *pjob)
 
 		delete_link(&pjob->ji_alljobs);
 		delete_link(&pjob->ji_unlicjobs);
+		unlink_job_indexes(pjob);
 		if (pbs_idx_delete(jobs_idx, pjob->ji_qs.ji_jobid) != PBS_IDX_RET_OK)
 			log_joberr(PBSE_INTERNAL, __func__, "Failed to delete job from index", pjob->ji_qs.ji_jobid);
 		if (--server.sv_qs.sv_numjobs < 0)
@@ -488,6 +935,10 @@ svr_dequejob(job *pjob)
 		correct_ct(pque);
 #endif	/* NDEBUG */
 
+	/* a frozen history job is only dequeued to be purged, leave it frozen */
+	if (pjob->ji_frozen != NULL)
+		return;
+
 	mark_jattr_not_set(pjob, JOB_ATR_qtime);
 
 	/* clear any default resource values */
@@ -4620,8 +5071,13 @@ svr_saveorpurge_finjobhist(job *pjob)
  * @par Purpose: Periodically checks for the history jobs in the server and
  *		 purge the history jobs whose history duration exceeds the
  *		 configured job_history_duration server attribute.
- * @par Functionality: It is a work_task and reschedule itself after 2 mins if
- *		 and only if job_history_enable is set.
+ * @par Functionality: It is a work_task and reschedule itself, at the
+ *		 latest after 2 mins, if and only if job_history_enable is set.
+ *		 History jobs are taken from svr_history_heap in the order they
+ *		 expire, so only the jobs which are due are looked at.  At most
+ *		 SVR_CLEAN_JOBHIST_BATCH jobs are purged, and at most
+ *		 SVR_CLEAN_JOBHIST_SECS seconds spent, in one run; the rest is
+ *		 left to a continuation task.
  *		Output: None
  *
  * @param[in]	pwt	-	work_task structure
@@ -4630,87 +5086,37 @@ void
 svr_clean_job_history(struct work_task *pwt)
 {
 	job 	*pjob;
-	job 	*nxpjob = NULL;
+	long	key;
+	long	hist_ts;
 	int 	walltime_used = 0;
-
-	/*
-	 * Keep track of time spent purging jobs, interrupts purge if necessary.
-	 * Timed task in nearby future set if purge took too long.
-	 * Timed task in far future only set if this task completes.
-	 * Autotunes time between job history purges:
-	 * - raised if last purge was short
-	 * - lowered if this purge needs to be interrupted
-	 */
-
+	int	npurged = 0;
 	time_t	begin_time;
 	time_t	end_time;
-	static time_t time_between_tasks = SVR_CLEAN_JOBHIST_TM;
+	time_t	next_time;
 
 	begin_time = time(NULL);
 	/* Initialize end_time, in case we do not get into the while loop */
 	end_time = begin_time;
 
 	/*
-	 * Traverse through the SERVER job list and find the history
-	 * jobs (job with state JOB_STATE_LTR_MOVED and JOB_STATE_LTR_FINISHED)
-	 * which exceed the configured job_history_duration value and
-	 * purge them immediately.
+	 * The top of the heap is the history job (job with state
+	 * JOB_STATE_LTR_MOVED, JOB_STATE_LTR_FINISHED or JOB_STATE_LTR_EXPIRED)
+	 * with the oldest history timestamp; stop at the first one which
+	 * has not yet exceeded the configured job_history_duration value.
 	 */
-	pjob = (job *)GET_NEXT(svr_alljobs);
-
-	while (pjob != NULL) {
-		/* save the next job */
-		nxpjob = (job *)GET_NEXT(pjob->ji_alljobs);
-
-		if ((check_job_state(pjob, JOB_STATE_LTR_MOVED) && check_job_substate(pjob, JOB_SUBSTATE_FINISHED)) ||
-			(check_job_state(pjob, JOB_STATE_LTR_FINISHED)) ||
-			(check_job_state(pjob, JOB_STATE_LTR_EXPIRED))) {
-
-			if (!(is_jattr_set(pjob,  JOB_ATR_history_timestamp))) {
-				if (check_job_state(pjob, JOB_STATE_LTR_MOVED))
-					set_jattr_l_slim(pjob, JOB_ATR_history_timestamp, time_now, SET);
-			else {
-					if (((walltime_used = get_used_wall(pjob)) == -1) ||
-						!(is_jattr_set(pjob,  JOB_ATR_stime))) {
-						log_err(-1, "svr_clean_job_history",
-							"Finished job missing start-time/walltime used, cannot clean history");
-						pjob = nxpjob;
-						continue;
-					}
-					set_jattr_l_slim(pjob, JOB_ATR_history_timestamp,
-							get_jattr_long(pjob, JOB_ATR_stime) + walltime_used, SET);
-				}
-				pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_flags |= ATR_SET_MOD_MCACHE;
-				job_save_db(pjob);
-			}
-
-			if (time_now >= (get_jattr_long(pjob,  JOB_ATR_history_timestamp) + svr_history_duration)) {
-				job_purge(pjob);
-				pjob = NULL;
-			}
-		}
-		/* restore the saved next in pjob */
-		pjob = nxpjob;
+	while ((pjob = (job *)pbs_heap_top(svr_history_heap, &key)) != NULL) {
+		if (time_now < (key + svr_history_duration))
+			break;
 
 		/* check if we spent too long hogging the pbs_server process here */
 		end_time = time(NULL);
-		if ((end_time - begin_time) > SVR_CLEAN_JOBHIST_SECS) {
-			/* Apparently the interval between history purges is too long.
-			 * reduce it using factor 0.7
-			 */
-			time_between_tasks = (floor((double)time_between_tasks * 0.7));
-
-			/* no use reducing to less than 4 * SVR_CLEAN_JOBHIST_SECS
-			 * since we'll already schedule a continuation task here
-			 */
-			if (time_between_tasks < (4 * SVR_CLEAN_JOBHIST_SECS))
-				time_between_tasks = 4 * SVR_CLEAN_JOBHIST_SECS;
-
+		if ((npurged >= SVR_CLEAN_JOBHIST_BATCH) ||
+			((end_time - begin_time) > SVR_CLEAN_JOBHIST_SECS)) {
 			/* set up another work task in near future,
 			 * but leave as much time as we spent in this routine for other work first
 			 */
 			if (!set_task(WORK_Timed,
-				(end_time + SVR_CLEAN_JOBHIST_SECS),
+				(end_time + (end_time - begin_time) + 1),
 				svr_clean_job_history, NULL)) {
 				log_err(errno,
 					"svr_clean_job_history",
@@ -4724,33 +5130,63 @@ svr_clean_job_history(struct work_task *pwt)
 				 */
 				return;
 		}
-	} /* end of while loop through jobs */
+
+		if (!is_history_state(get_job_state(pjob))) {
+			pbs_heap_delete(svr_history_heap, &pjob->ji_histheap);
+			continue;
+		}
+
+		if (check_job_state(pjob, JOB_STATE_LTR_MOVED) && !check_job_substate(pjob, JOB_SUBSTATE_FINISHED)) {
+			/* not finished at the remote server yet, look again next time */
+			(void)pbs_heap_insert(svr_history_heap, &pjob->ji_histheap,
+				time_now + SVR_CLEAN_JOBHIST_TM - svr_history_duration, pjob);
+			continue;
+		}
+
+		if (!(is_jattr_set(pjob,  JOB_ATR_history_timestamp))) {
+			if (check_job_state(pjob, JOB_STATE_LTR_MOVED))
+				set_jattr_l_slim(pjob, JOB_ATR_history_timestamp, time_now, SET);
+			else {
+				if (((walltime_used = get_used_wall(pjob)) == -1) ||
+					!(is_jattr_set(pjob,  JOB_ATR_stime))) {
+					log_err(-1, "svr_clean_job_history",
+						"Finished job missing start-time/walltime used, cannot clean history");
+					pbs_heap_delete(svr_history_heap, &pjob->ji_histheap);
+					continue;
+				}
+				set_jattr_l_slim(pjob, JOB_ATR_history_timestamp,
+						get_jattr_long(pjob, JOB_ATR_stime) + walltime_used, SET);
+			}
+			pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_flags |= ATR_SET_MOD_MCACHE;
+			job_save_db(pjob);
+		}
+
+		hist_ts = get_jattr_long(pjob,  JOB_ATR_history_timestamp);
+		if (time_now < (hist_ts + svr_history_duration)) {
+			/* keyed on a stale timestamp, move it to where it belongs */
+			(void)pbs_heap_insert(svr_history_heap, &pjob->ji_histheap, hist_ts, pjob);
+			continue;
+		}
+
+		job_purge(pjob);
+		npurged++;
+	} /* end of while loop through due history jobs */
 
 	/* We purged everything necessary in this task if we get here.
-	 * set up another work task for next time period.
+	 * set up another work task for when the next history job is due,
+	 * or for next time period if that is later.
 	 */
 	if (pwt && svr_history_enable) {
-		if (!set_task(WORK_Timed,
-			(time_now + time_between_tasks),
+		next_time = time_now + SVR_CLEAN_JOBHIST_TM;
+		if (pjob != NULL && (key + svr_history_duration) < next_time)
+			next_time = key + svr_history_duration;
+		if (!set_task(WORK_Timed, next_time,
 			svr_clean_job_history, NULL)) {
 			log_err(errno,
 				"svr_clean_job_history",
 				"Unable to set task for clean job history");
 		}
 	}
-
-	/* try to move the time between tasks up again
-	 * but only if we spent less than 2/3rds of what we were allowed to spend
-	 * Note the last purge of a chain of purges will often tend to undo part of the lowering
-	 * in the earlier incomplete purges -- that's OK: 0.7*1.1 is still smaller than 1
-	 */
-
-	if ((time_between_tasks < SVR_CLEAN_JOBHIST_TM) &&
-	    ((end_time - begin_time) < floor((double)SVR_CLEAN_JOBHIST_SECS * 2/3))) {
-		time_between_tasks = ceil((double) time_between_tasks * 1.1);
-		if (time_between_tasks > SVR_CLEAN_JOBHIST_TM)
-			time_between_tasks = SVR_CLEAN_JOBHIST_TM;
-	}
 }
 
 /**
@@ -5070,6 +5506,8 @@ pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_flags |= ATR_SET_MOD_MCACHE;
 	 */
 	free_job_work_tasks(pjob);
 
+	set_histjob_freeze_task(pjob);
+
 }
 
 /**
@@ -5118,6 +5556,433 @@ svr_chk_histjob(job *pjob)
 	return rc;
 }
 
+/*
+ * Attributes a frozen history job keeps decoded: the ones read when history
+ * jobs are listed, selected and queued behind.  They must not be lists, as
+ * the values are moved in and out of struct frozen_job by copy.
+ */
+static int frozen_kept_attrs[FROZEN_KEPT_ATTRS] = {
+	JOB_ATR_state,
+	JOB_ATR_substate,
+	JOB_ATR_qrank,
+	JOB_ATR_job_owner,
+	JOB_ATR_jobname,
+	JOB_ATR_euser,
+	JOB_ATR_egroup,
+	JOB_ATR_account,
+	JOB_ATR_project,
+	JOB_ATR_history_timestamp,
+	JOB_ATR_exit_status
+};
+
+/**
+ * @brief
+ * 		frozen_slot - where a frozen history job keeps a job attribute
+ *
+ * @param[in]	attr_idx	-	job attribute index
+ *
+ * @return	int
+ * @retval	index in fz_kept[]
+ * @retval	-1	: the attribute is not kept decoded
+ */
+static int
+frozen_slot(int attr_idx)
+{
+	static signed char slot[JOB_ATR_LAST];
+	static int slot_init = 0;
+	int i;
+
+	if (!slot_init) {
+		memset(slot, -1, sizeof(slot));
+		for (i = 0; i < FROZEN_KEPT_ATTRS; i++)
+			slot[frozen_kept_attrs[i]] = i;
+		slot_init = 1;
+	}
+	return slot[attr_idx];
+}
+
+/**
+ * @brief
+ * 		is_frozen_kept_jattr - check whether frozen history jobs keep a
+ *		job attribute decoded, so reading it does not thaw them
+ *
+ * @param[in]	attr_idx	-	job attribute index
+ *
+ * @return	int
+ * @retval	1	: kept
+ * @retval	0	: reading it thaws a frozen job
+ */
+int
+is_frozen_kept_jattr(int attr_idx)
+{
+	return (frozen_slot(attr_idx) >= 0);
+}
+
+/**
+ * @brief
+ * 		get_frozen_jattr - get a job attribute kept decoded by a frozen
+ *		history job
+ *
+ * @param[in]	pfz	-	frozen job
+ * @param[in]	attr_idx	-	job attribute index
+ *
+ * @return	attribute *
+ * @retval	the kept attribute
+ * @retval	NULL	: not kept, job_thaw() must be called to read it
+ */
+attribute *
+get_frozen_jattr(struct frozen_job *pfz, int attr_idx)
+{
+	int i = frozen_slot(attr_idx);
+
+	if (i < 0)
+		return NULL;
+	return &pfz->fz_kept[i];
+}
+
+/**
+ * @brief
+ * 		get_frozen_jattr_value - find the encoded value of a job attribute,
+ *		or of one resource of it, in what a frozen history job shows of
+ *		itself
+ *
+ * @par
+ *		Only the values job_freeze() encoded are there, so a resource no
+ *		client may read is not found.
+ *
+ * @param[in]	pfz	-	frozen job
+ * @param[in]	attr_idx	-	job attribute index
+ * @param[in]	resc	-	resource name, NULL for an attribute without
+ *
+ * @return	char *
+ * @retval	the value, as a client would be shown it
+ * @retval	NULL	: no such value
+ */
+char *
+get_frozen_jattr_value(struct frozen_job *pfz, int attr_idx, char *resc)
+{
+	struct frozen_value fv;
+	char *p = pfz->fz_status;
+	char *end = p + pfz->fz_statuslen;
+	char *name;
+	char *rname;
+	char *value;
+
+	while (p < end) {
+		memcpy(&fv, p, sizeof(fv));
+		name = p + sizeof(fv);
+		rname = name + strlen(name) + 1;
+		value = rname + strlen(rname) + 1;
+		p = value + strlen(value) + 1;
+
+		if (fv.fv_index < attr_idx)
+			continue;
+		if (fv.fv_index > attr_idx)
+			break;	/* values are in attribute index order */
+		if (resc == NULL || strcmp(rname, resc) == 0)
+			return value;
+	}
+	return NULL;
+}
+
+/**
+ * @brief
+ * 		frozen_wattr - the attribute array a frozen job points to in
+ *		place of its own: every attribute unset, and read only so that
+ *		writing to a frozen job without thawing it first faults rather
+ *		than changes every frozen job.  In a DEBUG build it cannot be
+ *		read either, so code reading ji_wattr of a frozen job directly,
+ *		instead of through get_jattr() and friends, faults where it does.
+ *
+ * @return	attribute *
+ * @retval	shared attribute array
+ * @retval	NULL	: out of memory
+ */
+static attribute *
+frozen_wattr(void)
+{
+	static attribute *pattr = NULL;
+	size_t size;
+	long pagesz;
+	int i;
+
+	if (pattr != NULL)
+		return pattr;
+
+	pagesz = sysconf(_SC_PAGESIZE);
+	size = ((JOB_ATR_LAST * sizeof(attribute) + pagesz - 1) / pagesz) * pagesz;
+	pattr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (pattr == MAP_FAILED) {
+		log_err(errno, __func__, "mmap failed");
+		pattr = NULL;
+		return NULL;
+	}
+	for (i = 0; i < JOB_ATR_LAST; i++)
+		clear_attr(&pattr[i], &job_attr_def[i]);
+#ifdef DEBUG
+	(void)mprotect(pattr, size, PROT_NONE);
+#else
+	(void)mprotect(pattr, size, PROT_READ);
+#endif
+	return pattr;
+}
+
+/**
+ * @brief
+ * 		job_has_unsaved - check whether a job has changes not yet in
+ *		the database
+ *
+ * @param[in]	pjob	-	job
+ *
+ * @return	int
+ * @retval	1	: some changes are not saved
+ * @retval	0	: the database is up to date
+ */
+static int
+job_has_unsaved(job *pjob)
+{
+	int i;
+
+	if (pjob->newobj || pjob->ji_dirtyjobs.ll_next != &pjob->ji_dirtyjobs)
+		return 1;
+	for (i = 0; i < JOB_ATR_LAST; i++) {
+		if (pjob->ji_wattr[i].at_flags & ATR_VFLAG_MODIFY)
+			return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ * 		job_freeze - reduce a saved history job to what a status reply
+ *		shows of it, see struct frozen_job.
+ *
+ * @par
+ *		Every readable attribute is encoded for clients, with all
+ *		resources a client may read, into ji_frozen; status_job()
+ *		serves status requests from that.  The decoded attributes,
+ *		their cached encodings, the status caches and the attribute
+ *		array itself are released; ji_wattr points to a shared array
+ *		of unset attributes until job_thaw().
+ *
+ * @param[in]	pjob	-	history job
+ *
+ * @return	int
+ * @retval	0	: job is frozen
+ * @retval	1	: not frozen, not a saved history job or its eligible
+ *			  time is made up on the fly
+ * @retval	-1	: not frozen, out of memory
+ */
+int
+job_freeze(job *pjob)
+{
+	struct frozen_job *pfz;
+	struct frozen_job *tmp;
+	struct frozen_value fv;
+	pbs_list_head phead;
+	svrattrl *pal;
+	attribute *pattr;
+	attribute_def *pdef;
+	resource_def *prdef;
+	attribute *shared;
+	size_t len = 0;
+	size_t need;
+	char *p;
+	int old_perm;
+	int i;
+
+	if (pjob->ji_frozen != NULL)
+		return 0;
+	if (!is_history_state(get_job_state(pjob)) || (pjob->ji_qs.ji_svrflags & JOB_SVFLG_SubJob))
+		return 1;
+	if (job_has_unsaved(pjob))
+		return 1;
+	if (server.sv_attr[(int)SVR_ATR_EligibleTimeEnable].at_val.at_long == TRUE &&
+		get_jattr_long(pjob, JOB_ATR_accrue_type) == JOB_ELIGIBLE)
+		return 1;
+	if ((shared = frozen_wattr()) == NULL)
+		return -1;
+	if ((pfz = malloc(sizeof(struct frozen_job))) == NULL)
+		return -1;
+
+	old_perm = resc_access_perm;
+	resc_access_perm = ATR_DFLAG_RDACC | ATR_DFLAG_SvWR;
+	for (i = 0; i < JOB_ATR_LAST; i++) {
+		pattr = &pjob->ji_wattr[i];
+		pdef = &job_attr_def[i];
+		if (!is_attr_set(pattr) || (pdef->at_flags & (ATR_DFLAG_RDACC | ATR_DFLAG_SvWR)) == 0)
+			continue;
+
+		CLEAR_HEAD(phead);
+		if (pdef->at_encode(pattr, &phead, pdef->at_name, NULL, ATR_ENCODE_CLIENT, NULL) < 0) {
+			free_attrlist(&phead);
+			free(pfz);
+			resc_access_perm = old_perm;
+			return -1;
+		}
+		for (pal = (svrattrl *)GET_NEXT(phead); pal; pal = (svrattrl *)GET_NEXT(pal->al_link)) {
+			need = sizeof(fv) + strlen(pal->al_name) + 1;
+			need += (pal->al_resc ? strlen(pal->al_resc) : 0) + 1;
+			need += (pal->al_value ? strlen(pal->al_value) : 0) + 1;
+			if ((tmp = realloc(pfz, sizeof(struct frozen_job) + len + need)) == NULL) {
+				free_attrlist(&phead);
+				free(pfz);
+				resc_access_perm = old_perm;
+				return -1;
+			}
+			pfz = tmp;
+
+			fv.fv_index = i;
+			fv.fv_rflags = 0;
+			if (pal->al_resc != NULL) {
+				/* a resource no longer defined is shown as "unknown" is */
+				if ((prdef = find_resc_def(svr_resc_def, pal->al_resc)) == NULL)
+					prdef = &svr_resc_def[svr_resc_unk];
+				fv.fv_rflags = prdef->rs_flags;
+			}
+			fv.fv_flags = pal->al_flags;
+			fv.fv_op = pal->al_op;
+			p = pfz->fz_status + len;
+			memcpy(p, &fv, sizeof(fv));
+			p += sizeof(fv);
+			p = stpcpy(p, pal->al_name) + 1;
+			p = stpcpy(p, pal->al_resc ? pal->al_resc : "") + 1;
+			p = stpcpy(p, pal->al_value ? pal->al_value : "") + 1;
+			len = p - pfz->fz_status;
+		}
+		free_attrlist(&phead);
+	}
+	resc_access_perm = old_perm;
+	pfz->fz_statuslen = len;
+
+	free_status_cache(pjob->ji_stcache);
+	free_exec_vnode(pjob->ji_execvn);
+	pjob->ji_execvn = NULL;
+	for (i = 0; i < FROZEN_KEPT_ATTRS; i++) {
+		pattr = &pjob->ji_wattr[frozen_kept_attrs[i]];
+		free_svrcache(pattr);
+		pfz->fz_kept[i] = *pattr;
+		clear_attr(pattr, &job_attr_def[frozen_kept_attrs[i]]);
+	}
+	for (i = 0; i < JOB_ATR_LAST; i++)
+		job_attr_def[i].at_free(&pjob->ji_wattr[i]);
+	free(pjob->ji_wattr);
+
+	pjob->ji_wattr = shared;
+	pjob->ji_frozen = pfz;
+	return 0;
+}
+
+/**
+ * @brief
+ * 		job_thaw - give a frozen history job its attributes back: the
+ *		kept ones from the frozen job, the others from the database.
+ *		The job is frozen again by a work task.
+ *
+ * @param[in]	pjob	-	job
+ *
+ * @return	int
+ * @retval	0	: job is not frozen (any more)
+ * @retval	-1	: out of memory, job stays frozen, or the database
+ *			  could not be read, job has the kept attributes only
+ */
+int
+job_thaw(job *pjob)
+{
+	struct frozen_job *pfz = pjob->ji_frozen;
+	attribute *pattr;
+	int idx;
+	int rc;
+	int i;
+
+	if (pfz == NULL)
+		return 0;
+
+	if ((pattr = malloc(JOB_ATR_LAST * sizeof(attribute))) == NULL) {
+		log_err(errno, __func__, "no memory");
+		return -1;
+	}
+	for (i = 0; i < JOB_ATR_LAST; i++)
+		clear_attr(&pattr[i], &job_attr_def[i]);
+	pjob->ji_wattr = pattr;
+	pjob->ji_frozen = NULL;
+
+	if ((rc = job_recov_attrs_db(pjob)) != 0)
+		log_joberr(PBSE_SYSTEM, __func__, "Failed to read back the attributes of frozen job", pjob->ji_qs.ji_jobid);
+
+	/* the kept values are the current ones */
+	for (i = 0; i < FROZEN_KEPT_ATTRS; i++) {
+		idx = frozen_kept_attrs[i];
+		job_attr_def[idx].at_free(&pattr[idx]);
+		pattr[idx] = pfz->fz_kept[i];
+		pattr[idx].at_flags |= ATR_VFLAG_MODCACHE;
+	}
+	free(pfz);
+
+	set_histjob_freeze_task(pjob);
+	return (rc);
+}
+
+/**
+ * @brief
+ * 		discard_frozen_job - free a frozen job's frozen form, the job
+ *		is being freed
+ *
+ * @param[in]	pjob	-	frozen job
+ */
+void
+discard_frozen_job(job *pjob)
+{
+	struct frozen_job *pfz = pjob->ji_frozen;
+	int i;
+
+	for (i = 0; i < FROZEN_KEPT_ATTRS; i++)
+		job_attr_def[frozen_kept_attrs[i]].at_free(&pfz->fz_kept[i]);
+	free(pfz);
+	pjob->ji_frozen = NULL;
+	pjob->ji_wattr = NULL;
+}
+
+/**
+ * @brief
+ * 		freeze_histjob - work task to freeze a job which went into
+ *		history, saving its last changes first
+ *
+ * @param[in]	ptask	-	work task, wt_parm1 is the job
+ */
+static void
+freeze_histjob(struct work_task *ptask)
+{
+	job *pjob = (job *)ptask->wt_parm1;
+
+	if (pjob->ji_frozen != NULL || !is_history_state(get_job_state(pjob)))
+		return;
+	if (job_has_unsaved(pjob) && job_save_db_now(pjob) != 0)
+		return;
+	(void)job_freeze(pjob);
+}
+
+/**
+ * @brief
+ * 		set_histjob_freeze_task - freeze a history job once the work
+ *		in progress on it is done
+ *
+ * @param[in]	pjob	-	history job
+ */
+void
+set_histjob_freeze_task(job *pjob)
+{
+	struct work_task *ptask;
+
+	for (ptask = (struct work_task *)GET_NEXT(pjob->ji_svrtask); ptask;
+		ptask = (struct work_task *)GET_NEXT(ptask->wt_linkobj)) {
+		if (ptask->wt_func == freeze_histjob)
+			return;
+	}
+	if ((ptask = set_task(WORK_Immed, 0, freeze_histjob, pjob)) != NULL)
+		append_link(&pjob->ji_svrtask, &ptask->wt_linkobj, ptask);
+}
+
 /**
  * @brief
  * 	Finish the request to mom to update a job's exec_* values.
@@ -560,6 +560,9 @@ send_job_exec(job *jobp, pbs_net_t hostaddr, int port, int move_type, struct bat
 	save_resc_access_perm = resc_access_perm;
 	pbs_errno = PBSE_NONE;
 
+	/* the job must be stored as being run before the MoM can start it */
+	flush_db_saves();
+
 	stream = svr_connect(hostaddr, port, NULL, ToServerDIS, PROT_TPP);
 	if (stream < 0) {
 		sprintf(log_buffer, "Could not connect to Mom, svr_connect returned %d", stream);
@@ -2716,6 +2716,7 @@ resc_limit_insert_other_res(resc_limit_t *have, char *kv_keyw, char *kv_val, int
 {
 	resource *pres, *pnewres;
 	resource_def *resc_def = NULL;
+	svrattrl *encoded;
 	int cmp_res = -1;
 	int rc;
 
@@ -2757,7 +2758,9 @@ resc_limit_insert_other_res(resc_limit_t *have, char *kv_keyw, char *kv_val, int
 		pres->rs_defin->rs_set(&pres->rs_value, &tmp, INCR);
 		free_svrcache(&pres->rs_value);
 		pres->rs_defin->rs_encode(&pres->rs_value, NULL, pres->rs_defin->rs_name,
-				NULL, ATR_ENCODE_CLIENT, &pres->rs_value.at_priv_encoded);
+				NULL, ATR_ENCODE_CLIENT, &encoded);
+		if (set_attr_priv_encoded(&pres->rs_value, encoded) != 0)
+			free_svrattrl(encoded);
 		pres->rs_defin->rs_free(&tmp);
 	} else {
 		pnewres = (resource *)calloc(1, sizeof(resource));
@@ -2774,7 +2777,9 @@ resc_limit_insert_other_res(resc_limit_t *have, char *kv_keyw, char *kv_val, int
 			return rc;
 		}
 		resc_def->rs_encode(&pnewres->rs_value, NULL, resc_def->rs_name,
-				NULL, ATR_ENCODE_CLIENT, &pnewres->rs_value.at_priv_encoded);
+				NULL, ATR_ENCODE_CLIENT, &encoded);
+		if (set_attr_priv_encoded(&pnewres->rs_value, encoded) != 0)
+			free_svrattrl(encoded);
 		if (execv_f)
 			pnewres->rs_value.at_flags |= ATR_VFLAG_IN_EXECVNODE_FLAG;
 		if (cmp_res < 0)  /* pres will be NULL */
@@ -2900,6 +2905,35 @@ resc_limit_list_free(pbs_list_head *res_list)
 	}
 }
 
+/**
+ * @brief
+ *	Return the value of a resource as encoded for clients, encoding it
+ *	first if it has not been.
+ *
+ * @param[in]	pres - resource
+ *
+ * @return char *
+ * @retval	the encoded value
+ * @retval	"" if the value encodes to nothing or there is no memory
+ */
+static char *
+priv_encoded_value(resource *pres)
+{
+	svrattrl *encoded = get_attr_priv_encoded(&pres->rs_value);
+
+	if (encoded == NULL) {
+		pres->rs_defin->rs_encode(&pres->rs_value, NULL, pres->rs_defin->rs_name,
+				NULL, ATR_ENCODE_CLIENT, &encoded);
+		if ((encoded != NULL) && (set_attr_priv_encoded(&pres->rs_value, encoded) != 0)) {
+			free_svrattrl(encoded);
+			encoded = NULL;
+		}
+	}
+	if ((encoded == NULL) || (encoded->al_value == NULL))
+		return "";
+	return encoded->al_value;
+}
+
 /**
  * @brief
  *	Print out the entries in the 'res_list' the server log under 'logtype'
@@ -2945,7 +2979,7 @@ resc_limit_list_print(char *header_str, pbs_list_head *res_list, int logtype)
 			phave;
 			phave = (resource *)GET_NEXT(phave->rs_link)) {
 			snprintf(log_buffer, sizeof(log_buffer), "%s[%d]: other res %s=%s",
-					header_str, i, phave->rs_defin->rs_name, phave->rs_value.at_priv_encoded->al_value);
+					header_str, i, phave->rs_defin->rs_name, priv_encoded_value(phave));
 			log_event(logtype, PBS_EVENTCLASS_RESC,
 				LOG_INFO, __func__, log_buffer);
 		}
@@ -3101,6 +3135,7 @@ map_need_to_have_resources(char *buf, size_t buf_sz, char *have_resc,
 #if !(defined(PBS_MOM) || defined(PBS_PYTHON))
 	} else {
 		resource *pneed;
+		svrattrl *encoded;
 		for (pneed = (resource *)GET_NEXT(need->rl_other_res);
 			pneed;
 			pneed = (resource *)GET_NEXT(pneed->rs_link)) {
@@ -3120,7 +3155,7 @@ map_need_to_have_resources(char *buf, size_t buf_sz, char *have_resc,
 					free(tmp);
 				} else {
 					if (cmp_res > 0) {
-						snprintf(buf, buf_sz, ":%s=%s", have_resc, pneed->rs_value.at_priv_encoded->al_value);
+						snprintf(buf, buf_sz, ":%s=%s", have_resc, priv_encoded_value(pneed));
 						pneed->rs_defin->rs_decode(&pneed->rs_value, NULL, NULL, "0");
 					} else {
 						pneed->rs_defin->rs_set(&pneed->rs_value, &hattr, DECR);
@@ -3128,7 +3163,9 @@ map_need_to_have_resources(char *buf, size_t buf_sz, char *have_resc,
 					}
 					free_svrcache(&pneed->rs_value);
 					pneed->rs_defin->rs_encode(&pneed->rs_value, NULL, pneed->rs_defin->rs_name,
-							NULL, ATR_ENCODE_CLIENT, &pneed->rs_value.at_priv_encoded);
+							NULL, ATR_ENCODE_CLIENT, &encoded);
+					if (set_attr_priv_encoded(&pneed->rs_value, encoded) != 0)
+						free_svrattrl(encoded);
 				}
 			}
 		}
@@ -3336,6 +3373,7 @@ satisfy_chunk_need(resc_limit_t *need, resc_limit_t *have, vnl_t **vnlp)
 	int		entry = 0;
 #if !(defined(PBS_MOM) || defined(PBS_PYTHON))
 	resource	*presnew, *pres, *pneed;
+	svrattrl	*encoded;
 #endif
 
 	if ((need == NULL) || (have == NULL))
@@ -3388,7 +3426,9 @@ satisfy_chunk_need(resc_limit_t *need, resc_limit_t *have, vnl_t **vnlp)
 		append_link(&map_need.rl_other_res, &presnew->rs_link, presnew);
 		presnew->rs_defin->rs_set(&presnew->rs_value, &pres->rs_value, SET);
 		presnew->rs_defin->rs_encode(&presnew->rs_value, NULL, presnew->rs_defin->rs_name,
-				NULL, ATR_ENCODE_CLIENT, &presnew->rs_value.at_priv_encoded);
+				NULL, ATR_ENCODE_CLIENT, &encoded);
+		if (set_attr_priv_encoded(&presnew->rs_value, encoded) != 0)
+			free_svrattrl(encoded);
 		if (pres->rs_value.at_flags & ATR_VFLAG_IN_EXECVNODE_FLAG)
 			presnew->rs_value.at_flags |= ATR_VFLAG_IN_EXECVNODE_FLAG;
 	}
@@ -3422,7 +3462,9 @@ satisfy_chunk_need(resc_limit_t *need, resc_limit_t *have, vnl_t **vnlp)
 			pres->rs_defin->rs_free(&pres->rs_value); /* ATR_VFLAG_IN_EXECVNODE_FLAG gets preserved */
 			pres->rs_defin->rs_set(&pres->rs_value, &pneed->rs_value, SET);
 			pres->rs_defin->rs_encode(&pres->rs_value, NULL, pres->rs_defin->rs_name,
-					NULL, ATR_ENCODE_CLIENT, &pres->rs_value.at_priv_encoded);
+					NULL, ATR_ENCODE_CLIENT, &encoded);
+			if (set_attr_priv_encoded(&pres->rs_value, encoded) != 0)
+				free_svrattrl(encoded);
 		}
 		pneed = (resource *)GET_NEXT(pneed->rs_link);
 	}
@@ -4345,7 +4387,7 @@ pbs_release_nodes_given_select(relnodes_input_t *r_input, relnodes_input_select_
 					pres != NULL;
 					pres = (resource *)GET_NEXT(pres->rs_link)) {
     				snprintf(log_buffer, sizeof(log_buffer),
-    					"(%s=%s)", pres->rs_defin->rs_name, pres->rs_value.at_priv_encoded->al_value);
+    					"(%s=%s)", pres->rs_defin->rs_name, priv_encoded_value(pres));
            			log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_ERR, r_input->jobid, log_buffer);
         		}
 #endif
@@ -4376,7 +4418,7 @@ pbs_release_nodes_given_select(relnodes_input_t *r_input, relnodes_input_select_
 					pres != NULL;
 					pres = (resource *)GET_NEXT(pres->rs_link)) {
 					snprintf(log_buffer, sizeof(log_buffer),
-						"(%s=%s)", pres->rs_defin->rs_name, pres->rs_value.at_priv_encoded->al_value);
+						"(%s=%s)", pres->rs_defin->rs_name, priv_encoded_value(pres));
 					log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_ERR, r_input->jobid, log_buffer);
 				}
 #endif
@@ -394,6 +394,9 @@ print_db_job(char *id, int no_attributes)
 	if (display_script) {
 		obj.pbs_db_obj_type = PBS_DB_JOBSCR;
 		obj.pbs_db_un.pbs_db_jobscr = &jobscr;
+		jobscr.sc_hash[0] = '\0';
+		jobscr.sc_hashonly = 0;
+		jobscr.script = NULL;
 		strcpy(jobscr.ji_jobid, id);
 		if (strchr(id, '.') == 0) {
 			strcat(jobscr.ji_jobid, ".");
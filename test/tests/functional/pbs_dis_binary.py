@@ -0,0 +1,99 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+import os
+
+from tests.functional import *
+
+
+class TestDisBinary(TestFunctional):
+
+    """
+    Test that clients in the binary encoding of DIS and clients staying
+    in Data-is-Strings (PBS_DIS_ASCII=1) get the same status replies,
+    also when the server answers them from its cached status encodings
+    """
+
+    def run_client(self, cmd, args, ascii):
+        """
+        Run a status command in one of the encodings
+        Arguments :
+             cmd - command, relative to PBS_EXEC/bin
+             args - list of command arguments
+             ascii - run with PBS_DIS_ASCII=1 if True
+        return :
+              the output lines of the command
+        """
+        path = os.path.join(self.server.client_conf['PBS_EXEC'], 'bin', cmd)
+        ret = self.du.run_cmd(self.server.hostname, [path] + args,
+                              env={'PBS_DIS_ASCII': '1' if ascii else '0'})
+        self.assertEqual(ret['rc'], 0)
+        return ret['out']
+
+    def test_mixed_encodings_status(self):
+        """
+        Status the same jobs and reservation from binary and string
+        clients in turn, so each reply may come from a status encoding
+        cached for the other kind of client, and check that every reply
+        is complete and the same
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jids = []
+        for _ in range(5):
+            j = Job(TEST_USER)
+            j.set_sleep_time(1000)
+            jids.append(self.server.submit(j))
+        now = int(time.time())
+        r = Reservation(TEST_USER, attrs={'reserve_start': now + 3600,
+                                          'reserve_end': now + 7200})
+        rid = self.server.submit(r)
+
+        first = None
+        for ascii in (False, True, False, True):
+            jobs = self.run_client('qstat', ['-f'] + jids, ascii)
+            resvs = self.run_client('pbs_rstat', ['-f', rid], ascii)
+            for jid in jids:
+                self.assertIn('Job Id: ' + jid, jobs)
+            owners = [l for l in jobs if 'Job_Owner' in l]
+            self.assertEqual(len(owners), len(jids))
+            self.assertTrue([l for l in resvs if 'Reserve_Owner' in l])
+            if first is None:
+                first = (jobs, resvs)
+            else:
+                self.assertEqual((jobs, resvs), first)
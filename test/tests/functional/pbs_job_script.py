@@ -45,6 +45,52 @@ class TestPbsJobScript(TestFunctional):
     Test suite for testing PBS's job script functionality
     """
 
+    count_scripts_script = """#!/bin/bash
+. %s
+. ${PBS_EXEC}/libexec/pbs_db_env
+
+DATA_PORT=${PBS_DATA_SERVICE_PORT}
+if [ -z ${DATA_PORT} ]; then
+    DATA_PORT=15007
+fi
+
+DATA_USER=`sudo cat ${PBS_HOME}/server_priv/db_user 2>/dev/null`
+if [ -z "${DATA_USER}" ]; then
+    DATA_USER=postgres
+fi
+
+sudo ${PBS_EXEC}/sbin/pbs_ds_password test
+sudo ${PBS_EXEC}/sbin/pbs_dataservice status >/dev/null
+if [ $? -ne 0 ]; then
+    sudo ${PBS_EXEC}/sbin/pbs_dataservice start >/dev/null || exit 1
+fi
+
+args="-U ${DATA_USER} -p ${DATA_PORT} -d pbs_datastore -At"
+PGPASSWORD=test ${PGSQL_BIN}/psql ${args} \\
+    -c "SELECT count(*) FROM pbs.job_scr_data"
+ret=$?
+
+sudo ${PBS_EXEC}/sbin/pbs_dataservice stop >/dev/null
+exit $ret
+"""
+
+    def count_stored_scripts(self):
+        """
+        Return the number of distinct job scripts stored in the datastore.
+        The server is stopped while the datastore is queried.
+        """
+        self.server.stop()
+        self.assertFalse(self.server.isUp(), 'Failed to stop PBS')
+        conf_path = self.du.get_pbs_conf_file()
+        fn = self.du.create_temp_file(
+            body=self.count_scripts_script % conf_path)
+        self.du.chmod(path=fn, mode=0o755)
+        ret = self.du.run_cmd(cmd=fn)
+        self.assertEqual(ret['rc'], 0, 'Failed to query the datastore')
+        self.server.start()
+        self.assertTrue(self.server.isUp(), 'Failed to restart PBS')
+        return int(ret['out'][-1].strip())
+
     def submit_job(self, addnewline=False):
         a = {'resources_available.ncpus': 2}
         self.mom.create_vnodes(a, 500, vname='Verylongvnodename')
@@ -90,3 +136,30 @@ class TestPbsJobScript(TestFunctional):
         execvnode = execvnode[0:-1]
         self.server.expect(JOB, {'job_state': 'R', 'exec_vnode': execvnode},
                            id=jid)
+
+    def test_shared_script(self):
+        """
+        Test that jobs submitted from the same script share one stored
+        copy of it, that printjob shows it for each of them, and that
+        each job runs it, also after the server restarts and after the
+        other jobs are deleted
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        scr = ['echo shared_script_output\n']
+        jids = []
+        for _ in range(3):
+            j = Job(TEST_USER)
+            j.create_script(scr)
+            jids.append(self.server.submit(j))
+        self.assertEqual(self.count_stored_scripts(), 1)
+        printjob = os.path.join(self.server.pbs_conf['PBS_EXEC'], 'bin',
+                                'printjob')
+        for jid in jids:
+            ret = self.du.run_cmd(self.server.hostname,
+                                  cmd=[printjob, '-s', jid], sudo=True)
+            self.assertEqual(ret['rc'], 0)
+            self.assertIn('shared_script_output', '\n'.join(ret['out']))
+        self.server.delete(jids[:2], wait=True)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, 'queue', id=jids[2], op=UNSET, offset=1)
+        self.server.log_match("%s;Exit_status=0" % jids[2])
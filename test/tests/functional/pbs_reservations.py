@@ -2462,3 +2462,29 @@ class TestReservations(TestFunctional):
                            id=srid, max_attempts=1)
         self.server.log_match(arid + ";Reservation denied", id=arid,
                               max_attempts=1)
+
+    def test_delete_resv_with_large_array_job(self):
+        """
+        Test that deleting a reservation whose queue holds an array job
+        with more subjobs than the server deletes in one pass (1000)
+        removes the array job and the reservation, and the server stays up
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'max_array_size': 2000})
+        now = int(time.time())
+        rid = self.submit_reservation(user=TEST_USER,
+                                      select='1:ncpus=1',
+                                      start=now + 3600,
+                                      end=now + 7200)
+        rid_q = rid.split('.')[0]
+        a = {'reserve_state': (MATCH_RE, "RESV_CONFIRMED|2")}
+        self.server.expect(RESV, a, id=rid)
+
+        a = {ATTR_q: rid_q, ATTR_J: '1-1500'}
+        j = Job(TEST_USER, attrs=a)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jid)
+
+        self.server.delete(rid)
+        self.server.expect(RESV, 'queue', op=UNSET, id=rid)
+        self.server.expect(JOB, 'queue', op=UNSET, id=jid)
+        self.assertTrue(self.server.isUp())
@@ -0,0 +1,136 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+
+
+import os
+
+from tests.performance import *
+
+
+class TestDisBinaryPerf(TestPerformance):
+
+    """
+    Compare the time taken by status requests with large replies when the
+    connection to the server uses the binary encoding of DIS and when it
+    stays in Data-is-Strings (PBS_DIS_ASCII=1)
+    """
+    time_command = 'time'
+
+    def setUp(self):
+        """
+        Base class method overriding
+        builds absolute path of commands to execute
+        """
+        TestPerformance.setUp(self)
+        self.time_command = self.du.which(exe="time")
+        if self.time_command == "time":
+            self.skipTest("Time command not found")
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+    def compute_time(self, cmd, ascii):
+        """
+        Computes the elapsed time of a command in secs
+        Arguments :
+             cmd - command, relative to PBS_EXEC/bin, with arguments
+             ascii - run with PBS_DIS_ASCII=1 if True
+        return :
+              -1 on command fail
+        """
+        command = self.time_command
+        command += " -f \"%e\" env PBS_DIS_ASCII="
+        command += "1 " if ascii else "0 "
+        command += os.path.join(self.server.client_conf['PBS_EXEC'],
+                                'bin', cmd)
+        command += " >/dev/null"
+        ret = self.du.run_cmd(self.server.hostname, command,
+                              as_script=True, logerr=False)
+        if ret['rc'] != 0:
+            return -1
+        return float(ret['err'][-1])
+
+    def compare_encodings(self, cmd, measure, runs=3):
+        """
+        Times a command in both encodings, keeping the best of runs
+        Arguments :
+             cmd - command, relative to PBS_EXEC/bin, with arguments
+             measure - name of the measurement
+             runs - number of times to run the command in each encoding
+        """
+        best = {}
+        for ascii in (True, False):
+            times = []
+            for _ in range(runs):
+                t = self.compute_time(cmd, ascii)
+                self.assertNotEqual(t, -1, cmd + " failed")
+                times.append(t)
+            best[ascii] = min(times)
+        self.logger.info("%s: ascii %s sec, binary %s sec" %
+                         (measure, best[True], best[False]))
+        self.perf_test_result(best[True], measure + "_ascii", "sec")
+        self.perf_test_result(best[False], measure + "_binary", "sec")
+
+    @timeout(3600)
+    def test_status_large_array(self):
+        """
+        Submit a held array job with 20000 subjobs, time the status of
+        all its subjobs, which encodes and decodes one status entry per
+        subjob, and check that both encodings show the same subjobs
+        """
+        a = {ATTR_J: '1-20000', ATTR_h: None}
+        j = Job(TEST_USER, attrs=a)
+        j.set_sleep_time(1000)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'H'}, id=jid)
+
+        self.compare_encodings('qstat -f -t ' + jid, 'qstat_f_t')
+        self.compare_encodings('qstat -t ' + jid, 'qstat_t')
+
+        out = self.du.run_cmd(
+            self.server.hostname,
+            [os.path.join(self.server.client_conf['PBS_EXEC'], 'bin',
+                          'qstat'), '-t', jid],
+            env={'PBS_DIS_ASCII': '0'}, logerr=False)
+        out_ascii = self.du.run_cmd(
+            self.server.hostname,
+            [os.path.join(self.server.client_conf['PBS_EXEC'], 'bin',
+                          'qstat'), '-t', jid],
+            env={'PBS_DIS_ASCII': '1'}, logerr=False)
+        self.assertEqual(out['out'], out_ascii['out'])
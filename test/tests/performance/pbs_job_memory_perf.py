@@ -0,0 +1,146 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+
+
+from tests.performance import *
+
+
+class TestJobMemoryPerf(TestPerformance):
+
+    """
+    Measure the memory the server keeps per job, for queued jobs and for
+    finished jobs kept in the history
+    """
+
+    def setUp(self):
+        TestPerformance.setUp(self)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+    def server_rss(self):
+        """
+        Returns the resident set size of pbs_server in KB
+        """
+        pid = self.server.get_pid()
+        self.assertIsNotNone(pid, "Could not get pid of pbs_server")
+        ret = self.du.run_cmd(self.server.hostname,
+                              ['cat', '/proc/%s/status' % pid],
+                              sudo=True, logerr=False)
+        for line in ret['out']:
+            if line.startswith('VmRSS:'):
+                return int(line.split()[1])
+        self.skipTest("VmRSS of pbs_server not available")
+
+    def submit_held(self, njobs):
+        """
+        Submit njobs held jobs and return their ids
+        """
+        jids = []
+        for _ in range(njobs):
+            j = Job(TEST_USER, attrs={ATTR_h: None})
+            j.set_sleep_time(1000)
+            jids.append(self.server.submit(j))
+        self.server.expect(SERVER, {'total_jobs': njobs})
+        return jids
+
+    @timeout(3600)
+    def test_job_memory(self):
+        """
+        Submit held jobs and report the growth of the server's resident
+        set per job, then delete them into the history and report it again
+        """
+        njobs = 5000
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'job_history_enable': 'True'})
+        base = self.server_rss()
+        jids = self.submit_held(njobs)
+        queued = self.server_rss()
+        per_queued = float(queued - base) / njobs
+        self.logger.info("queued: %.2f KB per job" % per_queued)
+        self.perf_test_result(per_queued, "rss_per_queued_job", "KB")
+
+        self.server.delete(jids, extend='nomail')
+        self.server.expect(JOB, {'job_state': 'F'}, id=jids[-1],
+                           extend='x')
+        hist = self.server_rss()
+        per_hist = float(hist - base) / njobs
+        self.logger.info("history: %.2f KB per job" % per_hist)
+        self.perf_test_result(per_hist, "rss_per_history_job", "KB")
+
+    @timeout(3600)
+    def test_history_job_freeze(self):
+        """
+        Finished jobs are frozen into their encoded status once they are
+        saved, so that a second batch of history jobs fits in the memory
+        released by the first, and costs well below a queued job
+        """
+        njobs = 5000
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'job_history_enable': 'True'})
+        base = self.server_rss()
+        jids = self.submit_held(njobs)
+        queued = self.server_rss()
+        per_queued = float(queued - base) / njobs
+        self.server.delete(jids, extend='nomail')
+        self.server.expect(JOB, {'job_state': 'F'}, id=jids[-1],
+                           extend='x')
+        before = self.server.status(JOB, id=jids[0], extend='x')
+        first = self.server_rss()
+
+        jids2 = []
+        for _ in range(njobs):
+            j = Job(TEST_USER, attrs={ATTR_h: None})
+            j.set_sleep_time(1000)
+            jids2.append(self.server.submit(j))
+        self.server.delete(jids2, extend='nomail')
+        self.server.expect(JOB, {'job_state': 'F'}, id=jids2[-1],
+                           extend='x')
+        second = self.server_rss()
+        per_frozen = float(second - first) / njobs
+        self.logger.info("queued: %.2f KB per job, frozen history: "
+                         "%.2f KB per job" % (per_queued, per_frozen))
+        self.perf_test_result(per_frozen, "rss_per_frozen_history_job", "KB")
+        self.assertLess(per_frozen, per_queued / 2)
+
+        # a frozen job reports what it did before the other batch went by
+        after = self.server.status(JOB, id=jids[0], extend='x')
+        self.assertEqual(before, after)
+        self.assertEqual(after[0]['job_state'], 'F')
+        self.assertIn('Resource_List.ncpus', after[0])
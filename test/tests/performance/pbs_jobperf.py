@@ -578,6 +578,80 @@ class TestJobPerf(TestPerformance):
             avg_qdel_time.extend(qdel_time)
         self.perf_test_result(avg_qdel_time, "job_deletion", "secs")
 
+    @timeout(3600)
+    def test_qstat_during_qdel_perf(self):
+        """
+        Test that the server keeps answering other clients while a single
+        qdel deletes 10k queued jobs
+        Test Params: 'No_of_jobs_per_user': 1000,
+                      'No_of_users': 10
+        """
+        testconfig = {'No_of_jobs_per_user': 1000,
+                      'No_of_users': 10}
+        config = self.set_test_config(testconfig)
+        users = [TEST_USER1, TEST_USER2, TEST_USER3, TEST_USER4,
+                 TEST_USER5, TEST_USER6, TEST_USER7, TEST_USER,
+                 TST_USR, TST_USR1]
+        a = {'scheduling': 'False'}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+        thrds = []
+        for u in range(0, config['No_of_users']):
+            t = Thread(target=self.submit_jobs,
+                       args=(users[u], config['No_of_jobs_per_user']))
+            t.start()
+            thrds.append(t)
+        for t in thrds:
+            t.join()
+
+        bin_path = str(os.path.join(
+            self.server.pbs_conf['PBS_EXEC'], 'bin'))
+        qdel = str(os.path.join(bin_path, 'qdel'))
+        qstat = str(os.path.join(bin_path, 'qstat')) + ' -B'
+        cmd = qdel + " `" + str(os.path.join(bin_path, 'qselect')) + "`"
+        start = time.time()
+        proc = subprocess.Popen(cmd, shell=True)
+        qstat_time = []
+        while proc.poll() is None:
+            t1 = time.time()
+            subprocess.call(qstat, shell=True, stdout=subprocess.DEVNULL)
+            qstat_time.append(time.time() - t1)
+        stop = time.time()
+        self.server.expect(SERVER, {'total_jobs': 0})
+        self.logger.info('qdel took %f secs, slowest qstat %f secs' %
+                         (stop - start, max(qstat_time or [0])))
+        self.perf_test_result(stop - start, "job_deletion", "secs")
+        self.perf_test_result(qstat_time, "qstat_during_job_deletion",
+                              "secs")
+
+    @timeout(3600)
+    def test_qstat_during_array_qdel_perf(self):
+        """
+        Test that the server keeps answering other clients while a single
+        qdel deletes an array job with 50k queued subjobs
+        """
+        a = {'scheduling': 'False', 'max_array_size': 50000}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+        j = Job(TEST_USER, attrs={ATTR_J: '1-50000'})
+        jid = self.server.submit(j)
+
+        qdel = os.path.join(self.server.pbs_conf['PBS_EXEC'], 'bin', 'qdel')
+        qstat = os.path.join(self.server.pbs_conf['PBS_EXEC'], 'bin',
+                             'qstat')
+        start = time.time()
+        proc = subprocess.Popen([qdel, jid])
+        qstat_time = []
+        while proc.poll() is None:
+            t1 = time.time()
+            subprocess.call([qstat, '-B'], stdout=subprocess.DEVNULL)
+            qstat_time.append(time.time() - t1)
+        stop = time.time()
+        self.server.expect(SERVER, {'total_jobs': 0})
+        self.logger.info('qdel took %f secs, slowest qstat %f secs' %
+                         (stop - start, max(qstat_time or [0])))
+        self.perf_test_result(stop - start, "array_job_deletion", "secs")
+        self.perf_test_result(qstat_time,
+                              "qstat_during_array_job_deletion", "secs")
+
     @timeout(3600)
     def test_qdel_hist_perf(self):
         """
@@ -642,3 +716,43 @@ class TestJobPerf(TestPerformance):
             j = j + 1
             avg_qdel_time.extend(qdel_time)
         self.perf_test_result(avg_qdel_time, "job_deletion_history", 'secs')
+
+    @timeout(3600)
+    def test_qstat_during_full_qstat_perf(self):
+        """
+        Test that a full qstat -f of 25k jobs, served from a snapshot of
+        the server, does not hold up other clients: qstat -B keeps
+        answering while the qstat -f runs
+        """
+        a = {'scheduling': 'False'}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+        users = [TEST_USER1, TEST_USER2, TEST_USER3, TEST_USER4,
+                 TEST_USER5]
+        thrds = []
+        for u in users:
+            t = Thread(target=self.submit_jobs, args=(u, 5000))
+            t.start()
+            thrds.append(t)
+        for t in thrds:
+            t.join()
+        self.server.expect(SERVER, {'total_jobs': 25000})
+
+        qstat = os.path.join(self.server.pbs_conf['PBS_EXEC'], 'bin',
+                             'qstat')
+        start = time.time()
+        procs = [subprocess.Popen([qstat, '-f'], stdout=subprocess.DEVNULL)
+                 for _ in range(4)]
+        qstat_time = []
+        while any(p.poll() is None for p in procs):
+            t1 = time.time()
+            subprocess.call([qstat, '-B'], stdout=subprocess.DEVNULL)
+            qstat_time.append(time.time() - t1)
+        stop = time.time()
+        slowest = max(qstat_time or [0])
+        self.logger.info('4 qstat -f took %f secs, slowest qstat -B %f secs'
+                         % (stop - start, slowest))
+        self.perf_test_result(stop - start, "full_qstat_25k_jobs", "secs")
+        self.perf_test_result(qstat_time, "qstat_during_full_qstat", "secs")
+        self.perf_test_result(slowest, "slowest_qstat_during_full_qstat",
+                              "secs")
+        self.assertLess(slowest, 60)
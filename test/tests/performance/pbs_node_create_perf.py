@@ -0,0 +1,79 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.performance import *
+
+
+class TestNodeCreatePerf(TestPerformance):
+    """
+    Performance tests for creating and modifying many vnodes with qmgr
+    """
+
+    @timeout(3600)
+    def test_create_set_many_vnodes(self):
+        """
+        Create many vnodes on one Mom one request at a time, then set an
+        attribute on each of them, and measure the time both take
+        """
+        num_nodes = 2000
+        names = ['vn%d' % i for i in range(num_nodes)]
+        a = {ATTR_NODE_Mom: self.mom.shortname}
+
+        t1 = time.time()
+        for name in names:
+            self.server.manager(MGR_CMD_CREATE, VNODE, a, id=name)
+        t2 = time.time()
+        self.server.expect(VNODE, {ATTR_NODE_Mom: self.mom.shortname},
+                           id=names[-1])
+
+        a = {'resources_available.ncpus': 2}
+        t3 = time.time()
+        for name in names:
+            self.server.manager(MGR_CMD_SET, VNODE, a, id=name)
+        t4 = time.time()
+        self.server.expect(VNODE, a, id=names[-1])
+
+        self.logger.info('#' * 80)
+        self.logger.info('Time taken to create %d vnodes %f' %
+                         (num_nodes, t2 - t1))
+        self.logger.info('Time taken to set %d vnodes %f' %
+                         (num_nodes, t4 - t3))
+        self.logger.info('#' * 80)
+        self.perf_test_result((t2 - t1), "time_taken_create_vnodes", "sec")
+        self.perf_test_result((t4 - t3), "time_taken_set_vnodes", "sec")
@@ -38,6 +38,9 @@
 # subject to Altair's trademark licensing policies.
 
 
+import signal
+import subprocess
+
 from ptl.utils.pbs_logutils import PBSLogUtils
 from tests.performance import *
 
@@ -47,7 +50,7 @@ class TestSchedPerf(TestPerformance):
     Test the performance of scheduler features
     """
 
-    def common_setup1(self):
+    def common_setup1(self, num_nodes=10010):
         TestPerformance.setUp(self)
         self.server.manager(MGR_CMD_CREATE, RSC,
                             {'type': 'string', 'flag': 'h'}, id='color')
@@ -56,10 +59,10 @@ class TestSchedPerf(TestPerformance):
         a = {'resources_available.ncpus': 1, 'resources_available.mem': '8gb'}
         # 10010 nodes since it divides into 7 evenly.
         # Each node bucket will have 1430 nodes in it
-        self.mom.create_vnodes(a, 10010,
+        self.mom.create_vnodes(a, num_nodes,
                                sharednode=False,
                                attrfunc=self.cust_attr_func, expect=False)
-        self.server.expect(NODE, {'state=free': (GE, 10010)})
+        self.server.expect(NODE, {'state=free': (GE, num_nodes)})
         self.scheduler.add_resource('color')
 
     def cust_attr_func(self, name, totalnodes, numnode, attribs):
@@ -258,6 +261,58 @@ class TestSchedPerf(TestPerformance):
         self.perf_test_result(((cycle1_time / cycle2_time) * 100),
                               "optimized_percentage", "percentage")
 
+    def run_cycle_counted(self):
+        """
+        Run a cycle with perf stat counting the scheduler's cache misses.
+        Return the length of the cycle and the cache misses and references
+        counted in it, or None for those if perf is not available
+        """
+        perf = self.du.which(exe='perf')
+        if perf == 'perf':
+            return (self.run_cycle(), None, None)
+        pid = self.scheduler.get_pid()
+        cmd = ['sudo', perf, 'stat', '-x', ',', '-p', str(pid),
+               '-e', 'cache-misses,cache-references']
+        proc = subprocess.Popen(cmd, stdout=subprocess.DEVNULL,
+                                stderr=subprocess.PIPE,
+                                universal_newlines=True)
+        t = self.run_cycle()
+        proc.send_signal(signal.SIGINT)
+        _, err = proc.communicate()
+        counts = {}
+        for line in err.splitlines():
+            fields = line.split(',')
+            if len(fields) > 2 and fields[0].isdigit():
+                counts[fields[2]] = int(fields[0])
+        return (t, counts.get('cache-misses'), counts.get('cache-references'))
+
+    @timeout(3600)
+    def test_node_search_cache_misses(self):
+        """
+        Time cycles which search 20k vnodes for jobs that can not run, and
+        count the scheduler's cache misses in them when perf is available.
+        This measures the layout of node_info, whose fields read while
+        searching nodes share the first cache lines.
+        """
+        self.common_setup1(num_nodes=20020)
+        num_jobs = 200
+        num_cycles = 3
+        a = {'Resource_List.select': '20020:ncpus=1:color=red'}
+        self.submit_jobs(a, num_jobs, wt_start=1000)
+        m = 'node search over 20020 vnodes for %d jobs' % num_jobs
+        times = []
+        misses = []
+        for i in range(num_cycles):
+            t, miss, ref = self.run_cycle_counted()
+            times.append(t)
+            self.logger.info('[%d] %s: %.2f secs, cache misses %s of %s' %
+                             (i, m, t, miss, ref))
+            if miss is not None:
+                misses.append(miss)
+        self.perf_test_result(times, m, "sec")
+        if misses:
+            self.perf_test_result(misses, m + " cache misses", "count")
+
     @timeout(1200)
     def test_many_chunks(self):
         self.common_setup1()
@@ -86,3 +86,40 @@ class TestDependencyPerformance(TestPerformance):
         self.check_depend_delete_msg(j_arr[4999], j_arr[5000])
         self.perf_test_result((t2 - t1),
                               "time_taken_delete_all_dependent_jobs", "sec")
+
+    @timeout(3600)
+    def test_release_many_dependents(self):
+        """
+        Submit many jobs that all run after one parent job, then measure
+        the time PBS takes to register them and to release all of them
+        once the parent ends.
+        """
+
+        num_jobs = 5000
+        job = Job()
+        job.set_sleep_time(3600)
+        pjid = self.server.submit(job)
+        self.server.expect(JOB, {ATTR_state: 'R'}, id=pjid)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+        a = {ATTR_depend: 'afterany:' + pjid}
+        t1 = time.time()
+        for _ in range(num_jobs):
+            self.server.submit(Job(attrs=a))
+        t2 = time.time()
+        self.server.expect(JOB, {'job_state=H': num_jobs}, count=True)
+
+        t3 = time.time()
+        self.server.delete(pjid)
+        self.server.expect(JOB, {'job_state=Q': num_jobs}, count=True,
+                           interval=2)
+        t4 = time.time()
+        self.logger.info('#' * 80)
+        self.logger.info('Time taken to submit dependent jobs %f' % (t2-t1))
+        self.logger.info('Time taken to release dependent jobs %f' %
+                         (t4-t3))
+        self.logger.info('#' * 80)
+        self.perf_test_result((t2 - t1),
+                              "time_taken_submit_dependent_jobs", "sec")
+        self.perf_test_result((t4 - t3),
+                              "time_taken_release_dependent_jobs", "sec")